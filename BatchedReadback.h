@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// The submission pattern of the batched D3D12 readback, independent of the API so its cost in submits and waits can be
+// tested without a device: the copies of every subresource go into the ring's one open list, which is submitted and
+// waited for once, and only then are the subresources verified. `Ring` is a D3D12CommandContextRing or a stand-in with
+// Begin(), Submit() and Sync().WaitFor(value). Returns the fence value that retires the copies, which the readback
+// memory is released with.
+template <typename Ring, typename RecordCopies, typename VerifySubresource>
+uint64_t SubmitAndVerifyOnce(Ring& ring, uint32_t numSubres, RecordCopies&& recordCopies, VerifySubresource&& verify) {
+    recordCopies(ring.Begin());
+
+    const uint64_t fenceValue = ring.Submit();
+    ring.Sync().WaitFor(fenceValue);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        verify(subres);
+    }
+    return fenceValue;
+}
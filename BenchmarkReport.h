@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TextureArrayDesc.h"
+
+// Latency samples of every interop path per texture array configuration, for picking a path by numbers
+class BenchmarkReport {
+public:
+    void Record(const char* path, const TextureArrayDesc& desc, double latencyMs) {
+        for (auto& series : m_series) {
+            if ((series.path == path) && (series.desc == desc)) {
+                series.latenciesMs.push_back(latencyMs);
+                return;
+            }
+        }
+        m_series.push_back({path, desc, {latencyMs}});
+    }
+
+    void Print() const {
+        for (const auto& series : m_series) {
+            const Summary summary = Summarize(series);
+            std::cout << series.path << " " << series.desc.width << "x" << series.desc.height << "x" << series.desc.arraySize
+                      << " mips " << series.desc.mipLevels << " " << FormatName(series.desc.format) << ": p50 " << summary.p50Ms
+                      << " ms, p95 " << summary.p95Ms << " ms, p99 " << summary.p99Ms << " ms, " << summary.slicesPerSecond
+                      << " slices/s, " << summary.gigaBytesPerSecond << " GB/s\n";
+        }
+        std::cout << "\n";
+    }
+
+    void WriteJson(const char* fileName) const {
+        std::ofstream file(fileName);
+        file << "[\n";
+        for (size_t i = 0; i < m_series.size(); ++i) {
+            const Series& series = m_series[i];
+            const Summary summary = Summarize(series);
+            file << "  {\"path\": \"" << series.path << "\", \"width\": " << series.desc.width << ", \"height\": " << series.desc.height
+                 << ", \"arraySize\": " << series.desc.arraySize << ", \"mipLevels\": " << series.desc.mipLevels << ", \"format\": \""
+                 << FormatName(series.desc.format) << "\", \"samples\": " << series.latenciesMs.size() << ", \"p50Ms\": " << summary.p50Ms
+                 << ", \"p95Ms\": " << summary.p95Ms << ", \"p99Ms\": " << summary.p99Ms << ", \"slicesPerSecond\": "
+                 << summary.slicesPerSecond << ", \"gigaBytesPerSecond\": " << summary.gigaBytesPerSecond << "}"
+                 << (i + 1 < m_series.size() ? ",\n" : "\n");
+        }
+        file << "]\n";
+    }
+
+private:
+    struct Series {
+        std::string path;
+        TextureArrayDesc desc;
+        std::vector<double> latenciesMs;
+    };
+
+    struct Summary {
+        double p50Ms = 0;
+        double p95Ms = 0;
+        double p99Ms = 0;
+        double slicesPerSecond = 0;
+        double gigaBytesPerSecond = 0;
+    };
+
+    // Nearest-rank percentiles over the sorted samples; throughput is derived from the median
+    static Summary Summarize(const Series& series) {
+        std::vector<double> sorted = series.latenciesMs;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&](double p) {
+            const size_t rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+            return sorted[std::max<size_t>(rank, 1) - 1];
+        };
+
+        Summary summary;
+        summary.p50Ms = percentile(50);
+        summary.p95Ms = percentile(95);
+        summary.p99Ms = percentile(99);
+        summary.slicesPerSecond = series.desc.arraySize * 1000.0 / summary.p50Ms;
+        summary.gigaBytesPerSecond = TextureArrayBytes(series.desc) / (summary.p50Ms * 1e6);
+        return summary;
+    }
+
+    std::vector<Series> m_series;
+};
+
+// The array configurations every benchmark run covers, from a small test array to a production sized one
+inline std::vector<TextureArrayDesc> BenchmarkMatrix() {
+    return {
+        {256, 256, 2},
+        {1024, 1024, 16},
+        {1024, 1024, 16, TextureArrayDesc::FullMipChain(1024, 1024)},
+        {2048, 2048, 64, 1, DXGI_FORMAT_B8G8R8A8_UNORM},
+    };
+}
+
+// A whole decimal number without a sign, false for anything else
+inline bool ParseUnsigned(const std::string& text, unsigned long long& value) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    size_t end = 0;
+    try {
+        value = std::stoull(text, &end);
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return end == text.size();
+}
+
+// One array of a benchmark matrix, written WIDTHxHEIGHTxARRAYSIZE with an optional xMIPS ("full" for the whole chain)
+// and :FORMAT, e.g. 2048x2048x64, 1024x1024x16xfull or 256x256x2x1:B8G8R8A8_UNORM
+inline TextureArrayDesc ParseMatrixEntry(const std::string& entry) {
+    const size_t colon = entry.find(':');
+    std::vector<std::string> dims;
+    std::istringstream dimStream(entry.substr(0, colon));
+    for (std::string dim; std::getline(dimStream, dim, 'x');) {
+        dims.push_back(dim);
+    }
+    if ((dims.size() < 3) || (dims.size() > 4)) {
+        throw std::invalid_argument("Matrix entry isn't WIDTHxHEIGHTxARRAYSIZE[xMIPS][:FORMAT]: " + entry);
+    }
+
+    const auto number = [&](const std::string& text) {
+        unsigned long long value = 0;
+        if (!ParseUnsigned(text, value) || (value == 0) || (value > 0xFFFFFFFF)) {
+            throw std::invalid_argument("Matrix entry has an invalid size: " + entry);
+        }
+        return static_cast<uint32_t>(value);
+    };
+
+    TextureArrayDesc desc;
+    desc.width = number(dims[0]);
+    desc.height = number(dims[1]);
+    desc.arraySize = number(dims[2]);
+    if (dims.size() == 4) {
+        const uint32_t fullMipChain = TextureArrayDesc::FullMipChain(desc.width, desc.height);
+        desc.mipLevels = dims[3] == "full" ? fullMipChain : number(dims[3]);
+        if (desc.mipLevels > fullMipChain) {
+            throw std::invalid_argument("Matrix entry has more mips than the full chain: " + entry);
+        }
+    }
+    if (colon != std::string::npos) {
+        desc.format = FormatFromName(entry.substr(colon + 1));
+        if (desc.format == DXGI_FORMAT_UNKNOWN) {
+            throw std::invalid_argument("Matrix entry has an unsupported format: " + entry);
+        }
+    }
+    return desc;
+}
+
+// A matrix file holds one entry per line, blank lines and lines starting with # are skipped
+inline std::vector<TextureArrayDesc> ParseBenchmarkMatrix(std::istream& in) {
+    std::vector<TextureArrayDesc> matrix;
+    for (std::string line; std::getline(in, line);) {
+        std::istringstream fields(line);
+        std::string entry;
+        if ((fields >> entry) && (entry[0] != '#')) {
+            matrix.push_back(ParseMatrixEntry(entry));
+        }
+    }
+    return matrix;
+}
+
+// What a benchmark run measures. Usage:
+//     [iterations [warmupIterations [maxArrayMiB]]] [--array ENTRY]... [--matrix FILE]...
+// Arrays given with --array or in a matrix file replace BenchmarkMatrix(), in the order they are given.
+struct BenchmarkOptions {
+    uint32_t iterations = 50;
+    uint32_t warmupIterations = 5;
+    // Arrays above this size are skipped, every array is held twice plus an intermediate
+    uint64_t maxArrayMiB = 2048;
+    std::vector<TextureArrayDesc> matrix = BenchmarkMatrix();
+};
+
+inline BenchmarkOptions ParseBenchmarkArgs(int argc, const char* const* argv) {
+    BenchmarkOptions options;
+    std::vector<TextureArrayDesc> matrix;
+    uint32_t numPositional = 0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--array") || (arg == "--matrix")) {
+            if (i + 1 == argc) {
+                throw std::invalid_argument(arg + " needs a value");
+            }
+            const std::string value = argv[++i];
+            if (arg == "--array") {
+                matrix.push_back(ParseMatrixEntry(value));
+            } else {
+                std::ifstream file(value);
+                if (!file) {
+                    throw std::invalid_argument("Can't open matrix file " + value);
+                }
+                const std::vector<TextureArrayDesc> entries = ParseBenchmarkMatrix(file);
+                matrix.insert(matrix.end(), entries.begin(), entries.end());
+            }
+            continue;
+        }
+
+        unsigned long long value = 0;
+        if (!ParseUnsigned(arg, value) || (numPositional == 3)) {
+            throw std::invalid_argument("Unexpected argument " + arg);
+        }
+        switch (numPositional++) {
+        case 0:
+            options.iterations = static_cast<uint32_t>(value);
+            break;
+        case 1:
+            options.warmupIterations = static_cast<uint32_t>(value);
+            break;
+        default:
+            options.maxArrayMiB = value;
+            break;
+        }
+    }
+
+    if (!matrix.empty()) {
+        options.matrix = std::move(matrix);
+    }
+    return options;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// A device's capability snapshot as plain integers, so it can be parsed, stored and looked up without the D3D12
+// headers. The adapter LUID is kept as its two halves, with the high half signed as in LUID.
+struct CapabilityRecord {
+    struct FormatSupport {
+        uint32_t format = 0;
+        uint32_t support1 = 0;
+        uint32_t support2 = 0;
+    };
+
+    int32_t adapterLuidHighPart = 0;
+    uint32_t adapterLuidLowPart = 0;
+    uint64_t driverVersion = 0;
+    uint32_t sharedResourceCompatibilityTier = 0;
+    uint32_t tileBasedRenderer = 0;
+    uint32_t uma = 0;
+    uint32_t cacheCoherentUma = 0;
+    uint32_t isolatedMmu = 0;
+    uint32_t resourceHeapTier = 0;
+    std::vector<FormatSupport> formats;
+};
+
+// Capability records persisted across launches, one line per adapter, keyed by adapter LUID and driver version.
+// A file that fails to parse is treated as empty, so every adapter is probed again and the file rewritten on the next
+// store.
+class CapabilityCache {
+public:
+    // More formats than any snapshot probes; a larger count means the line is corrupt
+    static constexpr uint32_t MaxFormats = 64;
+
+    explicit CapabilityCache(std::string fileName) : m_fileName(std::move(fileName)) {
+        std::ifstream file(m_fileName);
+        std::string line;
+        while (std::getline(file, line)) {
+            CapabilityRecord record;
+            if (!Parse(line, record)) {
+                m_records.clear();
+                return;
+            }
+            m_records.push_back(record);
+        }
+    }
+
+    // Null if the adapter was never probed or its driver changed since
+    const CapabilityRecord* Find(int32_t adapterLuidHighPart, uint32_t adapterLuidLowPart, uint64_t driverVersion) const {
+        for (const auto& record : m_records) {
+            if ((record.adapterLuidHighPart == adapterLuidHighPart) && (record.adapterLuidLowPart == adapterLuidLowPart) &&
+                (record.driverVersion == driverVersion)) {
+                return &record;
+            }
+        }
+        return nullptr;
+    }
+
+    // Replaces the adapter's record, whatever driver it was taken with, and writes the file
+    void Store(const CapabilityRecord& record) {
+        m_records.erase(std::remove_if(m_records.begin(),
+                                       m_records.end(),
+                                       [&](const CapabilityRecord& cached) {
+                                           return (cached.adapterLuidHighPart == record.adapterLuidHighPart) &&
+                                                  (cached.adapterLuidLowPart == record.adapterLuidLowPart);
+                                       }),
+                        m_records.end());
+        m_records.push_back(record);
+
+        std::ofstream file(m_fileName);
+        for (const auto& cached : m_records) {
+            file << Serialize(cached) << "\n";
+        }
+    }
+
+    size_t NumRecords() const {
+        return m_records.size();
+    }
+
+    static std::string Serialize(const CapabilityRecord& record) {
+        std::ostringstream line;
+        line << record.adapterLuidHighPart << " " << record.adapterLuidLowPart << " " << record.driverVersion << " "
+             << record.sharedResourceCompatibilityTier << " " << record.tileBasedRenderer << " " << record.uma << " "
+             << record.cacheCoherentUma << " " << record.isolatedMmu << " " << record.resourceHeapTier << " "
+             << record.formats.size();
+        for (const auto& support : record.formats) {
+            line << " " << support.format << " " << support.support1 << " " << support.support2;
+        }
+        return line.str();
+    }
+
+    // The LUID halves are read wide and range checked, as a negative low half would otherwise wrap into a valid DWORD
+    static bool Parse(const std::string& line, CapabilityRecord& record) {
+        std::istringstream fields(line);
+        int64_t luidHighPart = 0;
+        int64_t luidLowPart = 0;
+        uint32_t numFormats = 0;
+        fields >> luidHighPart >> luidLowPart >> record.driverVersion >> record.sharedResourceCompatibilityTier >>
+            record.tileBasedRenderer >> record.uma >> record.cacheCoherentUma >> record.isolatedMmu >> record.resourceHeapTier >>
+            numFormats;
+        if (!fields || (luidHighPart < INT32_MIN) || (luidHighPart > INT32_MAX) || (luidLowPart < 0) || (luidLowPart > UINT32_MAX) ||
+            (numFormats > MaxFormats)) {
+            return false;
+        }
+        record.adapterLuidHighPart = static_cast<int32_t>(luidHighPart);
+        record.adapterLuidLowPart = static_cast<uint32_t>(luidLowPart);
+
+        record.formats.resize(numFormats);
+        for (auto& support : record.formats) {
+            fields >> support.format >> support.support1 >> support.support2;
+        }
+
+        // A line from an older layout has fields missing or left over. Skipping the trailing whitespace fails once the
+        // last field already hit the end of the line, so only the position is checked after it.
+        if (fields.fail()) {
+            return false;
+        }
+        fields >> std::ws;
+        return fields.eof();
+    }
+
+private:
+    std::string m_fileName;
+    std::vector<CapabilityRecord> m_records;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// The index and fence bookkeeping behind D3D12CommandContextRing, independent of the API so stalls can be tested
+// without a device. Each context is tagged with the fence value of its last submission and is only reopened once that
+// value retired. A context stays open from Open() until Close(), so several steps can append to one batch.
+class ContextRing {
+public:
+    struct Stats {
+        uint64_t numSubmits = 0;
+        // Opens that had to wait for the GPU because every context was still in flight
+        uint64_t numStalls = 0;
+    };
+
+    explicit ContextRing(uint32_t numContexts) : m_fenceValues(numContexts) {
+        if (numContexts == 0) {
+            throw std::invalid_argument("A context ring needs at least one context");
+        }
+    }
+
+    bool IsOpen() const {
+        return m_open;
+    }
+
+    // The open context, or the one submitted last
+    uint32_t Current() const {
+        return m_current;
+    }
+
+    uint32_t NumContexts() const {
+        return static_cast<uint32_t>(m_fenceValues.size());
+    }
+
+    // The fence value of the context's last submission
+    uint64_t FenceValue(uint32_t context) const {
+        return m_fenceValues.at(context);
+    }
+
+    // Moves on to the next context and returns it, after waiting on `timeline` (a FenceTimeline) if its last
+    // submission is still in flight. The caller resets the context's allocator and list before recording into it.
+    template <typename Timeline>
+    uint32_t Open(Timeline& timeline) {
+        if (m_open) {
+            throw std::invalid_argument("The context ring already has an open context");
+        }
+
+        m_current = (m_current + 1) % NumContexts();
+        if (!timeline.IsComplete(m_fenceValues[m_current])) {
+            ++m_stats.numStalls;
+            timeline.WaitFor(m_fenceValues[m_current]);
+        }
+        m_open = true;
+        return m_current;
+    }
+
+    // Tags the open context with the fence value its submission signals
+    void Close(uint64_t fenceValue) {
+        if (!m_open) {
+            throw std::invalid_argument("The context ring has no open context");
+        }
+
+        m_fenceValues[m_current] = fenceValue;
+        m_open = false;
+        ++m_stats.numSubmits;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    std::vector<uint64_t> m_fenceValues;
+    uint32_t m_current = 0;
+    bool m_open = false;
+    Stats m_stats;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// The handoff sequencing behind D3D12CopyQueue, independent of the API so the order of its transitions, submits and GPU
+// waits can be tested against stand-in queues. Resources are handed over through the common state: the producer
+// transitions to it before the handoff, copies promote the resource out of it implicitly and everything accessed on a
+// copy queue decays back to it once the copies completed, so the tracker keeps the resource in the common state while
+// the copy queue owns it. `Queue` provides
+//     template <typename Tracker>
+//     void FlushBarriers(Tracker& tracker)     records the tracker's pending changes into the open list
+//     uint64_t Submit()                        submits the open list, returns the fence value that retires it
+//     void Wait(Queue& other, uint64_t value)  waits on the GPU until the other queue reaches the value
+template <typename Queue>
+class CopyQueueHandoff {
+public:
+    explicit CopyQueueHandoff(Queue& copyQueue) : m_copyQueue(copyQueue) {
+    }
+
+    // Submits the producer's open list with a transition of `resource` to `commonState` and makes the copy queue wait
+    // for it on the GPU
+    template <typename Tracker, typename Resource, typename State>
+    void AcquireFrom(Queue& producer, Tracker& tracker, Resource resource, State commonState) {
+        tracker.Transition(resource, Tracker::AllSubresources, commonState);
+        producer.FlushBarriers(tracker);
+
+        const uint64_t producerValue = producer.Submit();
+        m_copyQueue.Wait(producer, producerValue);
+    }
+
+    // Returns the fence value on the copy queue's timeline that retires with the copies
+    uint64_t Submit() {
+        return m_copyQueue.Submit();
+    }
+
+    // Makes the consumer queue wait for the copies on the GPU and records the transition of `resource` out of the
+    // common state into the consumer's open list
+    template <typename Tracker, typename Resource, typename State>
+    void ReturnTo(Queue& consumer, Tracker& tracker, Resource resource, State stateAfter, uint64_t copyValue) {
+        consumer.Wait(m_copyQueue, copyValue);
+
+        tracker.Transition(resource, Tracker::AllSubresources, stateAfter);
+        consumer.FlushBarriers(tracker);
+    }
+
+private:
+    Queue& m_copyQueue;
+};
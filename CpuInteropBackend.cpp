@@ -0,0 +1,83 @@
+#include "CpuInteropBackend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+InteropBackend::TextureId CpuInteropBackend::CreateTextureArray(const TextureArrayDesc& desc) {
+    auto storage = std::make_shared<Storage>();
+    storage->desc = desc;
+    storage->rowPitches.resize(desc.NumSubresources());
+    storage->subresources.resize(desc.NumSubresources());
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        const uint32_t mip = desc.MipOf(subres);
+        const uint32_t rowPitch = (desc.MipWidth(mip) * BytesPerPixel(desc.format) + RowPitchAlignment - 1) & ~(RowPitchAlignment - 1);
+        storage->rowPitches[subres] = rowPitch;
+        storage->subresources[subres].resize(static_cast<size_t>(rowPitch) * desc.MipHeight(mip));
+    }
+
+    m_textures.push_back(std::move(storage));
+    return static_cast<TextureId>(m_textures.size() - 1);
+}
+
+InteropBackend::TextureId CpuInteropBackend::OpenShared(TextureId texture) {
+    m_textures.push_back(m_textures[texture]);
+    return static_cast<TextureId>(m_textures.size() - 1);
+}
+
+void CpuInteropBackend::Clear(TextureId texture, uint32_t subres, const DirectX::XMFLOAT4& color) {
+    // Same float to UNORM conversion as the GPU: scale and round to nearest
+    const uint8_t components[] = {
+        static_cast<uint8_t>(std::lround(std::clamp(color.x, 0.0f, 1.0f) * 255)),
+        static_cast<uint8_t>(std::lround(std::clamp(color.y, 0.0f, 1.0f) * 255)),
+        static_cast<uint8_t>(std::lround(std::clamp(color.z, 0.0f, 1.0f) * 255)),
+        static_cast<uint8_t>(std::lround(std::clamp(color.w, 0.0f, 1.0f) * 255)),
+    };
+    std::shared_ptr<Storage> storage = m_textures[texture];
+    const uint32_t value = PackColor(storage->desc.format, components);
+
+    m_pending.push_back([storage, subres, value] {
+        const uint32_t mip = storage->desc.MipOf(subres);
+        const uint32_t rowPitch = storage->rowPitches[subres];
+        uint8_t* rows = storage->subresources[subres].data();
+        for (uint32_t y = 0; y < storage->desc.MipHeight(mip); ++y) {
+            std::fill_n(reinterpret_cast<uint32_t*>(rows + static_cast<size_t>(y) * rowPitch), storage->desc.MipWidth(mip), value);
+        }
+    });
+}
+
+void CpuInteropBackend::CopySubresource(TextureId dst, uint32_t dstSubres, TextureId src, uint32_t srcSubres) {
+    m_pending.push_back([dstStorage = m_textures[dst], dstSubres, srcStorage = m_textures[src], srcSubres] {
+        const std::vector<uint8_t>& srcRows = srcStorage->subresources[srcSubres];
+        std::vector<uint8_t>& dstRows = dstStorage->subresources[dstSubres];
+        if (srcRows.size() != dstRows.size()) {
+            throw std::invalid_argument("Copy between subresources of different sizes");
+        }
+        memcpy(dstRows.data(), srcRows.data(), srcRows.size());
+    });
+}
+
+uint64_t CpuInteropBackend::Submit() {
+    for (const auto& command : m_pending) {
+        command();
+    }
+    m_pending.clear();
+
+    return ++m_fenceValue;
+}
+
+void CpuInteropBackend::WaitForFence(uint64_t value) {
+    if (value > m_fenceValue) {
+        throw std::invalid_argument("Waiting for a fence value that was never signaled");
+    }
+}
+
+void CpuInteropBackend::ReadBack(TextureId texture, uint32_t firstSubres, uint32_t numSubres, const ReadbackFunc& consume) {
+    WaitForFence(Submit());
+
+    const Storage& storage = *m_textures[texture];
+    for (uint32_t subres = firstSubres; subres < firstSubres + numSubres; ++subres) {
+        consume(subres, storage.subresources[subres].data(), storage.rowPitches[subres]);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "InteropBackend.h"
+
+// Texture arrays in system memory. Rows are padded to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT like a readback footprint,
+// recorded commands run in order on Submit() and the fence completes right away. Shared opens alias the same storage.
+class CpuInteropBackend : public InteropBackend {
+public:
+    // Same value as D3D12_TEXTURE_DATA_PITCH_ALIGNMENT, which isn't available off Windows
+    static constexpr uint32_t RowPitchAlignment = 256;
+
+    const char* Name() const override {
+        return "cpu";
+    }
+
+    TextureId CreateTextureArray(const TextureArrayDesc& desc) override;
+    TextureId OpenShared(TextureId texture) override;
+
+    void Clear(TextureId texture, uint32_t subres, const DirectX::XMFLOAT4& color) override;
+    void CopySubresource(TextureId dst, uint32_t dstSubres, TextureId src, uint32_t srcSubres) override;
+
+    uint64_t Submit() override;
+    void WaitForFence(uint64_t value) override;
+
+    void ReadBack(TextureId texture, uint32_t firstSubres, uint32_t numSubres, const ReadbackFunc& consume) override;
+
+private:
+    struct Storage {
+        TextureArrayDesc desc;
+        std::vector<uint32_t> rowPitches;
+        std::vector<std::vector<uint8_t>> subresources;
+    };
+
+    std::vector<std::shared_ptr<Storage>> m_textures;
+    std::vector<std::function<void()>> m_pending;
+    uint64_t m_fenceValue = 0;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+// The ordering behind CrossApiFence, independent of the API so the handoffs can be tested without devices. One fence
+// is shared by the D3D11 device and a D3D12 queue, and both directions signal the next value of the same monotonically
+// increasing count, so every handoff orders after all earlier ones. Nothing blocks the CPU. `Fence` provides
+//     void SignalOnD3D12(Queue queue, uint64_t value)   queues a signal on the D3D12 queue
+//     void WaitOnD3D12(Queue queue, uint64_t value)     makes the D3D12 queue wait for the value on the GPU
+//     void SignalOnD3D11(uint64_t value)                records a signal on the D3D11 immediate context
+//     void WaitOnD3D11(uint64_t value)                  makes the D3D11 context wait for the value on the GPU
+//     void FlushD3D11()                                 submits what the D3D11 context recorded so far
+//     uint64_t CompletedValue()
+template <typename Fence>
+class CrossApiTimeline {
+public:
+    template <typename... Args>
+    explicit CrossApiTimeline(Args&&... args) : m_fence(std::forward<Args>(args)...) {
+    }
+
+    CrossApiTimeline(const CrossApiTimeline&) = delete;
+    CrossApiTimeline& operator=(const CrossApiTimeline&) = delete;
+
+    // D3D11 work issued after this call starts only once everything already submitted to the D3D12 queue is done
+    template <typename Queue>
+    uint64_t D3D12ToD3D11(Queue queue) {
+        const uint64_t value = ++m_value;
+        m_fence.SignalOnD3D12(queue, value);
+        m_fence.WaitOnD3D11(value);
+        return value;
+    }
+
+    // Work submitted to the D3D12 queue after this call starts only once everything already issued on D3D11 is done
+    template <typename Queue>
+    uint64_t D3D11ToD3D12(Queue queue) {
+        const uint64_t value = ++m_value;
+        m_fence.SignalOnD3D11(value);
+        // D3D11 batches commands, the signal has to reach the GPU or the D3D12 queue would stall until the next flush
+        m_fence.FlushD3D11();
+        m_fence.WaitOnD3D12(queue, value);
+        return value;
+    }
+
+    uint64_t LastValue() const {
+        return m_value;
+    }
+
+    uint64_t CompletedValue() {
+        return m_fence.CompletedValue();
+    }
+
+private:
+    Fence m_fence;
+    uint64_t m_value = 0;
+};
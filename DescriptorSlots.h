@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// The bookkeeping behind D3D12DescriptorAllocator, independent of the API so slot reuse can be tested without a device.
+// Slots live in heaps of a fixed size. Freed slots go on a free-list and are reused before the bump pointer of the
+// newest heap moves on. A new heap is only added once every existing one is full; the caller backs it when Allocate()
+// returns a slot whose heap is the count of heaps it has created so far.
+class DescriptorSlotAllocator {
+public:
+    struct Slot {
+        uint32_t heap = 0;
+        uint32_t index = 0;
+    };
+
+    struct Stats {
+        uint32_t numLive = 0;
+        uint32_t peakLive = 0;
+        uint32_t numHeaps = 0;
+        uint32_t capacity = 0;
+    };
+
+    explicit DescriptorSlotAllocator(uint32_t descriptorsPerHeap) : m_descriptorsPerHeap(descriptorsPerHeap) {
+        if (descriptorsPerHeap == 0) {
+            throw std::invalid_argument("Descriptor heaps need at least one descriptor");
+        }
+    }
+
+    Slot Allocate() {
+        Slot slot;
+        if (!m_freeList.empty()) {
+            slot = m_freeList.back();
+            m_freeList.pop_back();
+        } else {
+            if (m_live.empty() || (m_nextInHeap == m_descriptorsPerHeap)) {
+                m_live.emplace_back(m_descriptorsPerHeap, false);
+                m_nextInHeap = 0;
+            }
+            slot = {static_cast<uint32_t>(m_live.size() - 1), m_nextInHeap++};
+        }
+        m_live[slot.heap][slot.index] = true;
+
+        ++m_stats.numLive;
+        m_stats.peakLive = std::max(m_stats.peakLive, m_stats.numLive);
+
+        return slot;
+    }
+
+    void Free(Slot slot) {
+        if ((slot.heap >= m_live.size()) || (slot.index >= m_descriptorsPerHeap) || !m_live[slot.heap][slot.index]) {
+            throw std::invalid_argument("Descriptor isn't allocated");
+        }
+        m_live[slot.heap][slot.index] = false;
+        m_freeList.push_back(slot);
+        --m_stats.numLive;
+    }
+
+    uint32_t DescriptorsPerHeap() const {
+        return m_descriptorsPerHeap;
+    }
+
+    uint32_t NumHeaps() const {
+        return static_cast<uint32_t>(m_live.size());
+    }
+
+    Stats GetStats() const {
+        Stats stats = m_stats;
+        stats.numHeaps = NumHeaps();
+        stats.capacity = stats.numHeaps * m_descriptorsPerHeap;
+        return stats;
+    }
+
+private:
+    uint32_t m_descriptorsPerHeap;
+    // Per heap, which slots are handed out
+    std::vector<std::vector<bool>> m_live;
+    uint32_t m_nextInHeap = 0;
+    std::vector<Slot> m_freeList;
+    Stats m_stats;
+};
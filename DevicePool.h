@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The pooling behind D3D12DevicePool, independent of the API so reuse and eviction can be tested without creating
+// devices. Devices are kept per key with the contexts recording for them, and stay until evicted. `Backend` provides
+//     using Key, Device, Context                    an ordered key, a shared device handle and a context using it
+//     Device CreateDevice(const Key& key)           the only place devices are created
+//     std::unique_ptr<Context> CreateContext(const Key& key, const Device& device)
+//     const Key& KeyOf(const Context& context) const
+//     void Retire(Context& context)                 waits for the work the context still has in flight
+//     double NowMs()                                a monotonic clock timing device creation
+template <typename Backend>
+class DevicePool {
+public:
+    using Key = typename Backend::Key;
+    using Device = typename Backend::Device;
+    using Context = typename Backend::Context;
+
+    struct Stats {
+        uint64_t numAcquires = 0;
+        uint32_t numDevicesCreated = 0;
+        uint32_t numContextsCreated = 0;
+        uint32_t numEvictions = 0;
+        double totalDeviceCreateMs = 0;
+        double maxDeviceCreateMs = 0;
+
+        double AverageDeviceCreateMs() const {
+            return numDevicesCreated ? totalDeviceCreateMs / numDevicesCreated : 0.0;
+        }
+    };
+
+    template <typename... Args>
+    explicit DevicePool(Args&&... args) : m_backend(std::forward<Args>(args)...) {
+    }
+
+    ~DevicePool() {
+        EvictAll();
+    }
+
+    DevicePool(const DevicePool&) = delete;
+    DevicePool& operator=(const DevicePool&) = delete;
+
+    // Hands out an idle context of the key's device, creating the device or the context on a miss
+    std::unique_ptr<Context> Acquire(const Key& key) {
+        ++m_stats.numAcquires;
+
+        Entry& entry = m_entries[key];
+        if (!entry.device) {
+            const double start = m_backend.NowMs();
+            entry.device = m_backend.CreateDevice(key);
+            const double elapsed = m_backend.NowMs() - start;
+
+            ++m_stats.numDevicesCreated;
+            m_stats.totalDeviceCreateMs += elapsed;
+            m_stats.maxDeviceCreateMs = std::max(m_stats.maxDeviceCreateMs, elapsed);
+        }
+
+        if (!entry.idle.empty()) {
+            // Work still in flight from the last user is waited for by the context, when it cycles back to it
+            std::unique_ptr<Context> context = std::move(entry.idle.back());
+            entry.idle.pop_back();
+            return context;
+        }
+
+        ++m_stats.numContextsCreated;
+        return m_backend.CreateContext(key, entry.device);
+    }
+
+    // The context may still have work in flight, it's waited for by the context itself or on eviction
+    void Release(std::unique_ptr<Context> context) {
+        auto iter = m_entries.find(m_backend.KeyOf(*context));
+        if (iter == m_entries.end()) {
+            // Evicted while it was handed out
+            m_backend.Retire(*context);
+            return;
+        }
+        iter->second.idle.push_back(std::move(context));
+    }
+
+    // Drops the key's device and idle contexts. Contexts still handed out keep the device alive until released.
+    void Evict(const Key& key) {
+        auto iter = m_entries.find(key);
+        if (iter == m_entries.end()) {
+            return;
+        }
+
+        for (auto& context : iter->second.idle) {
+            m_backend.Retire(*context);
+        }
+        m_entries.erase(iter);
+        ++m_stats.numEvictions;
+    }
+
+    void EvictAll() {
+        while (!m_entries.empty()) {
+            Evict(m_entries.begin()->first);
+        }
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Entry {
+        Device device;
+        std::vector<std::unique_ptr<Context>> idle;
+    };
+
+    Backend m_backend;
+    std::map<Key, Entry> m_entries;
+    Stats m_stats;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "TextureArrayDesc.h"
+
+// Texel rectangle of one subresource, right and bottom exclusive
+struct DirtyRect {
+    uint32_t left = 0;
+    uint32_t top = 0;
+    uint32_t right = 0;
+    uint32_t bottom = 0;
+
+    bool Empty() const {
+        return (left >= right) || (top >= bottom);
+    }
+
+    uint64_t Area() const {
+        return Empty() ? 0 : static_cast<uint64_t>(right - left) * (bottom - top);
+    }
+
+    DirtyRect Union(const DirtyRect& other) const {
+        return {std::min(left, other.left), std::min(top, other.top), std::max(right, other.right), std::max(bottom, other.bottom)};
+    }
+
+    // Empty when the rectangles don't overlap
+    DirtyRect Intersection(const DirtyRect& other) const {
+        return {std::max(left, other.left), std::max(top, other.top), std::min(right, other.right), std::min(bottom, other.bottom)};
+    }
+};
+
+// Rectangles written per subresource since the last readback. A new rectangle absorbs every existing one whose union
+// with it covers no texel that neither of them covers, and the list is capped by merging the pair that grows the least.
+class DirtyRegionTracker {
+public:
+    explicit DirtyRegionTracker(const TextureArrayDesc& desc, uint32_t maxRectsPerSubresource = 8)
+        : m_desc(desc), m_maxRectsPerSubresource(maxRectsPerSubresource), m_rects(desc.NumSubresources()) {
+    }
+
+    void MarkDirty(uint32_t subres, DirtyRect rect) {
+        const uint32_t mip = m_desc.MipOf(subres);
+        rect.right = std::min(rect.right, m_desc.MipWidth(mip));
+        rect.bottom = std::min(rect.bottom, m_desc.MipHeight(mip));
+        if (rect.Empty()) {
+            return;
+        }
+
+        std::vector<DirtyRect>& rects = m_rects.at(subres);
+        for (bool mergedAny = true; mergedAny;) {
+            mergedAny = false;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                const DirtyRect merged = rects[i].Union(rect);
+                if (merged.Area() <= rects[i].Area() + rect.Area() - rects[i].Intersection(rect).Area()) {
+                    rect = merged;
+                    rects.erase(rects.begin() + i);
+                    mergedAny = true;
+                    break;
+                }
+            }
+        }
+        rects.push_back(rect);
+
+        while (rects.size() > m_maxRectsPerSubresource) {
+            size_t bestI = 0;
+            size_t bestJ = 1;
+            uint64_t bestGrowth = ~0ULL;
+            for (size_t i = 0; i < rects.size(); ++i) {
+                for (size_t j = i + 1; j < rects.size(); ++j) {
+                    const uint64_t growth = rects[i].Union(rects[j]).Area() - std::max(rects[i].Area(), rects[j].Area());
+                    if (growth < bestGrowth) {
+                        bestGrowth = growth;
+                        bestI = i;
+                        bestJ = j;
+                    }
+                }
+            }
+            rects[bestI] = rects[bestI].Union(rects[bestJ]);
+            rects.erase(rects.begin() + bestJ);
+        }
+    }
+
+    void MarkSubresourceDirty(uint32_t subres) {
+        const uint32_t mip = m_desc.MipOf(subres);
+        MarkDirty(subres, {0, 0, m_desc.MipWidth(mip), m_desc.MipHeight(mip)});
+    }
+
+    const std::vector<DirtyRect>& Rects(uint32_t subres) const {
+        return m_rects.at(subres);
+    }
+
+    // Returns the merged rectangles of the subresource and forgets them
+    std::vector<DirtyRect> Take(uint32_t subres) {
+        return std::exchange(m_rects.at(subres), {});
+    }
+
+private:
+    TextureArrayDesc m_desc;
+    uint32_t m_maxRectsPerSubresource;
+    std::vector<std::vector<DirtyRect>> m_rects;
+};
+
+// Tightly packed CPU copy of every subresource, kept current by patching in the dirty rectangles of each readback
+class CpuTextureMirror {
+public:
+    struct Stats {
+        uint64_t numSyncs = 0;
+        uint64_t texelsPatched = 0;
+    };
+
+    explicit CpuTextureMirror(const TextureArrayDesc& desc)
+        : m_desc(desc), m_bytesPerPixel(BytesPerPixel(desc.format)), m_subresources(desc.NumSubresources()) {
+        for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+            m_subresources[subres].resize(static_cast<size_t>(RowPitch(subres)) * desc.MipHeight(desc.MipOf(subres)));
+        }
+    }
+
+    // `data` holds the rectangle's rows `rowPitch` bytes apart
+    void Patch(uint32_t subres, const DirtyRect& rect, const uint8_t* data, uint32_t rowPitch) {
+        const size_t mirrorPitch = RowPitch(subres);
+        for (uint32_t y = rect.top; y < rect.bottom; ++y) {
+            memcpy(&m_subresources[subres][y * mirrorPitch + static_cast<size_t>(rect.left) * m_bytesPerPixel],
+                   data + static_cast<size_t>(y - rect.top) * rowPitch,
+                   static_cast<size_t>(rect.right - rect.left) * m_bytesPerPixel);
+        }
+        m_stats.texelsPatched += rect.Area();
+    }
+
+    void MarkSynced() {
+        ++m_stats.numSyncs;
+    }
+
+    const uint8_t* Data(uint32_t subres) const {
+        return m_subresources[subres].data();
+    }
+
+    uint32_t RowPitch(uint32_t subres) const {
+        return m_desc.MipWidth(m_desc.MipOf(subres)) * m_bytesPerPixel;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    TextureArrayDesc m_desc;
+    uint32_t m_bytesPerPixel;
+    std::vector<std::vector<uint8_t>> m_subresources;
+    Stats m_stats;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+// Same value as INFINITE, so D3D12 callers can pass either
+constexpr uint32_t InfiniteTimeoutMs = 0xFFFFFFFF;
+
+// The timeline behind D3D12QueueSync, independent of the API so waits and timeouts can be tested without a device: one
+// monotonically increasing fence per queue, with the last value seen complete cached so polling doesn't query the
+// fence each time. `Fence` provides
+//     void Signal(uint64_t value)                    queues a signal of the value
+//     uint64_t CompletedValue()                      the last value the fence reached
+//     bool Wait(uint64_t value, uint32_t timeoutMs)  blocks until the fence may have reached it, false on timeout
+//     uint64_t NowMs()                               a monotonic clock for the timeout deadline
+// Wait() may return early, so the timeline re-checks the fence after every wakeup.
+template <typename Fence>
+class FenceTimeline {
+public:
+    template <typename... Args>
+    explicit FenceTimeline(Args&&... args) : m_fence(std::forward<Args>(args)...) {
+    }
+
+    FenceTimeline(const FenceTimeline&) = delete;
+    FenceTimeline& operator=(const FenceTimeline&) = delete;
+
+    Fence& GetFence() {
+        return m_fence;
+    }
+
+    const Fence& GetFence() const {
+        return m_fence;
+    }
+
+    uint64_t LastSignaled() const {
+        return m_lastSignaled;
+    }
+
+    uint64_t Signal() {
+        m_fence.Signal(m_lastSignaled + 1);
+        return ++m_lastSignaled;
+    }
+
+    bool IsComplete(uint64_t value) {
+        if (value > m_lastCompleted) {
+            m_lastCompleted = std::max(m_lastCompleted, m_fence.CompletedValue());
+        }
+        return value <= m_lastCompleted;
+    }
+
+    // Returns false if the timeout elapses before the fence reaches the value
+    bool WaitFor(uint64_t value, uint32_t timeoutMs = InfiniteTimeoutMs) {
+        const uint64_t deadline = m_fence.NowMs() + timeoutMs;
+        while (!IsComplete(value)) {
+            uint32_t remainingMs = InfiniteTimeoutMs;
+            if (timeoutMs != InfiniteTimeoutMs) {
+                const uint64_t now = m_fence.NowMs();
+                remainingMs = now < deadline ? static_cast<uint32_t>(deadline - now) : 0;
+            }
+
+            if (!m_fence.Wait(value, remainingMs)) {
+                return IsComplete(value);
+            }
+        }
+        return true;
+    }
+
+    // All values share one timeline, so waiting for all of them is waiting for the largest and waiting for any is
+    // waiting for the smallest
+    bool WaitForMultiple(const uint64_t* values, uint32_t numValues, bool waitAll, uint32_t timeoutMs = InfiniteTimeoutMs) {
+        if (numValues == 0) {
+            return true;
+        }
+
+        uint64_t target = values[0];
+        for (uint32_t i = 1; i < numValues; ++i) {
+            target = waitAll ? std::max(target, values[i]) : std::min(target, values[i]);
+        }
+        return WaitFor(target, timeoutMs);
+    }
+
+    void Flush() {
+        WaitFor(Signal());
+    }
+
+private:
+    Fence m_fence;
+    uint64_t m_lastSignaled = 0;
+    uint64_t m_lastCompleted = 0;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Aggregated GPU time of one named scope. The submit latency is the time from recording the scope on the CPU to the
+// GPU starting it, which needs calibrated clocks and is only known on D3D12.
+struct GpuScopeStats {
+    uint64_t count = 0;
+    double totalGpuMs = 0;
+    double maxGpuMs = 0;
+    double totalSubmitLatencyMs = 0;
+
+    void Add(double gpuMs, double submitLatencyMs) {
+        ++count;
+        totalGpuMs += gpuMs;
+        maxGpuMs = std::max(maxGpuMs, gpuMs);
+        totalSubmitLatencyMs += submitLatencyMs;
+    }
+};
+
+// The scope bookkeeping behind D3D12GpuTimer, independent of the API so the aggregation can be tested with a stand-in
+// clock. Scopes are numbered in the order they are opened, from 0 after every Collect(). `Clock` provides
+//     uint64_t CpuTicks()                     the CPU clock, read when a scope is recorded
+//     uint64_t CpuFrequency(), GpuFrequency() ticks per second of both clocks
+//     void Calibrate(uint64_t& gpuTicks, uint64_t& cpuTicks)  both clocks sampled at the same moment
+template <typename Clock>
+class GpuScopeLog {
+public:
+    template <typename... Args>
+    explicit GpuScopeLog(Args&&... args) : m_clock(std::forward<Args>(args)...) {
+    }
+
+    Clock& GetClock() {
+        return m_clock;
+    }
+
+    uint32_t NumOpen() const {
+        return static_cast<uint32_t>(m_scopes.size());
+    }
+
+    uint32_t Open(const char* name) {
+        m_scopes.push_back({name, m_clock.CpuTicks()});
+        return NumOpen() - 1;
+    }
+
+    // Adds every open scope to the stats, `timestampsOf(scope)` pointing at its GPU begin and end timestamps, and
+    // starts over
+    template <typename TimestampsOf>
+    void Collect(TimestampsOf&& timestampsOf) {
+        // Maps GPU timestamps onto the CPU clock
+        uint64_t gpuCalibration;
+        uint64_t cpuCalibration;
+        m_clock.Calibrate(gpuCalibration, cpuCalibration);
+        const double gpuFrequency = static_cast<double>(m_clock.GpuFrequency());
+        const double cpuFrequency = static_cast<double>(m_clock.CpuFrequency());
+
+        for (uint32_t scope = 0; scope < m_scopes.size(); ++scope) {
+            const uint64_t* timestamps = timestampsOf(scope);
+            const uint64_t gpuBegin = timestamps[0];
+            const uint64_t gpuEnd = timestamps[1];
+            const double gpuMs = (gpuEnd - gpuBegin) * 1000.0 / gpuFrequency;
+
+            const double gpuBeginOnCpuTicks = static_cast<double>(cpuCalibration) +
+                                              (static_cast<double>(gpuBegin) - static_cast<double>(gpuCalibration)) *
+                                                  cpuFrequency / gpuFrequency;
+            const double submitLatencyMs = (gpuBeginOnCpuTicks - m_scopes[scope].cpuTicks) * 1000.0 / cpuFrequency;
+
+            m_stats[m_scopes[scope].name].Add(gpuMs, submitLatencyMs);
+        }
+        m_scopes.clear();
+    }
+
+    const std::map<std::string, GpuScopeStats>& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Scope {
+        const char* name;
+        uint64_t cpuTicks;
+    };
+
+    Clock m_clock;
+    std::vector<Scope> m_scopes;
+    std::map<std::string, GpuScopeStats> m_stats;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+// The range bookkeeping behind SharedHeapAllocator, independent of the API so placement can be tested without a device.
+// Free ranges are kept sorted by offset, allocated first-fit and coalesced with their neighbours on free.
+class HeapRangeAllocator {
+public:
+    struct Range {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    struct Stats {
+        uint64_t heapSize = 0;
+        uint64_t bytesInUse = 0;
+        uint64_t peakBytesInUse = 0;
+        uint64_t numPlacements = 0;
+        uint64_t largestFreeRange = 0;
+        uint32_t numFreeRanges = 0;
+
+        double Utilization() const {
+            return heapSize ? static_cast<double>(bytesInUse) / heapSize : 0.0;
+        }
+
+        // 0 when all free space is one range, approaching 1 as it splinters
+        double Fragmentation() const {
+            const uint64_t freeBytes = heapSize - bytesInUse;
+            return freeBytes ? 1.0 - static_cast<double>(largestFreeRange) / freeBytes : 0.0;
+        }
+    };
+
+    explicit HeapRangeAllocator(uint64_t heapSize) {
+        if (heapSize != 0) {
+            m_freeRanges[0] = heapSize;
+        }
+        m_stats.heapSize = heapSize;
+    }
+
+    // False if no free range holds `size` bytes at `alignment`, a power of two
+    bool Allocate(uint64_t size, uint64_t alignment, Range& range) {
+        for (auto iter = m_freeRanges.begin(); iter != m_freeRanges.end(); ++iter) {
+            const uint64_t offset = (iter->first + alignment - 1) & ~(alignment - 1);
+            const uint64_t rangeEnd = iter->first + iter->second;
+            if (offset + size > rangeEnd) {
+                continue;
+            }
+
+            // Split the range around the placement; the alignment padding in front stays free
+            const uint64_t rangeBegin = iter->first;
+            m_freeRanges.erase(iter);
+            if (offset > rangeBegin) {
+                m_freeRanges[rangeBegin] = offset - rangeBegin;
+            }
+            if (rangeEnd > offset + size) {
+                m_freeRanges[offset + size] = rangeEnd - (offset + size);
+            }
+
+            ++m_stats.numPlacements;
+            m_stats.bytesInUse += size;
+            m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+
+            range.offset = offset;
+            range.size = size;
+            return true;
+        }
+        return false;
+    }
+
+    void Free(const Range& range) {
+        uint64_t begin = range.offset;
+        uint64_t end = range.offset + range.size;
+        auto next = m_freeRanges.lower_bound(begin);
+        if (((next != m_freeRanges.end()) && (next->first < end)) ||
+            ((next != m_freeRanges.begin()) && (std::prev(next)->first + std::prev(next)->second > begin))) {
+            throw std::invalid_argument("Heap range isn't allocated");
+        }
+
+        if ((next != m_freeRanges.end()) && (next->first == end)) {
+            end += next->second;
+            next = m_freeRanges.erase(next);
+        }
+        if (next != m_freeRanges.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == begin) {
+                begin = prev->first;
+                m_freeRanges.erase(prev);
+            }
+        }
+        m_freeRanges[begin] = end - begin;
+
+        m_stats.bytesInUse -= range.size;
+    }
+
+    Stats GetStats() const {
+        Stats stats = m_stats;
+        stats.numFreeRanges = static_cast<uint32_t>(m_freeRanges.size());
+        for (const auto& [offset, size] : m_freeRanges) {
+            stats.largestFreeRange = std::max(stats.largestFreeRange, size);
+        }
+        return stats;
+    }
+
+private:
+    std::map<uint64_t, uint64_t> m_freeRanges;
+    Stats m_stats;
+};
@@ -0,0 +1,122 @@
+#include "InteropBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+std::vector<VerifyResult> TryBackendReadback(InteropBackend& backend,
+                                             InteropBackend::TextureId texture,
+                                             const TextureArrayDesc& desc,
+                                             const uint32_t expectedRgbas[]) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+    backend.ReadBack(texture, 0, desc.NumSubresources(), [&](uint32_t subres, const void* data, uint32_t rowPitch) {
+        const uint32_t mip = desc.MipOf(subres);
+        ret[subres] = VerifySurface(data, rowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[desc.SliceOf(subres)]);
+    });
+    return ret;
+}
+
+std::vector<VerifyResult> TryBackendSliceReadback(InteropBackend& backend,
+                                                  InteropBackend::TextureId texture,
+                                                  const TextureArrayDesc& desc,
+                                                  const uint32_t expectedRgbas[]) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+    for (uint32_t slice = 0; slice < desc.arraySize; ++slice) {
+        backend.ReadBack(texture, desc.Subresource(0, slice), desc.mipLevels, [&](uint32_t subres, const void* data, uint32_t rowPitch) {
+            const uint32_t mip = desc.MipOf(subres);
+            ret[subres] = VerifySurface(data, rowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[slice]);
+        });
+    }
+    return ret;
+}
+
+std::vector<VerifyResult> TryBackendSharedCopy(InteropBackend& backend,
+                                               InteropBackend::TextureId sharedTexture,
+                                               InteropBackend::TextureId consumerTexture,
+                                               const TextureArrayDesc& desc,
+                                               const uint32_t expectedRgbas[]) {
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        backend.CopySubresource(consumerTexture, subres, sharedTexture, subres);
+    }
+    backend.WaitForFence(backend.Submit());
+
+    return TryBackendReadback(backend, consumerTexture, desc, expectedRgbas);
+}
+
+std::vector<VerifyResult> TryBackendIntermediateCopy(InteropBackend& backend,
+                                                     InteropBackend::TextureId sharedTexture,
+                                                     InteropBackend::TextureId intermediateTexture,
+                                                     const TextureArrayDesc& desc,
+                                                     const uint32_t expectedRgbas[]) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+    for (uint32_t slice = 0; slice < desc.arraySize; ++slice) {
+        for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+            backend.CopySubresource(intermediateTexture, mip, sharedTexture, desc.Subresource(mip, slice));
+        }
+
+        // The readback submits the copies ahead of itself
+        backend.ReadBack(intermediateTexture, 0, desc.mipLevels, [&](uint32_t mip, const void* data, uint32_t rowPitch) {
+            ret[desc.Subresource(mip, slice)] =
+                VerifySurface(data, rowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[slice]);
+        });
+    }
+    return ret;
+}
+
+bool BackendTextureArrayTest(InteropBackend& backend,
+                             const TextureArrayDesc& desc,
+                             uint32_t iterations,
+                             uint32_t warmupIterations,
+                             BenchmarkReport* report) {
+    if (desc.Multisampled()) {
+        std::cout << "Multisampled arrays cannot be copied to readback memory without a resolve, skipping backend tests\n\n";
+        return true;
+    }
+
+    const InteropBackend::TextureId producerTexture = backend.CreateTextureArray(desc);
+    const InteropBackend::TextureId sharedTexture = backend.OpenShared(producerTexture);
+    const InteropBackend::TextureId consumerTexture = backend.CreateTextureArray(desc);
+    const InteropBackend::TextureId intermediateTexture =
+        backend.CreateTextureArray({desc.width, desc.height, 1, desc.mipLevels, desc.format, desc.sampleCount});
+
+    bool allPassed = true;
+    for (uint32_t test = 0; test < iterations; ++test) {
+        std::vector<DirectX::XMFLOAT4> sliceColors;
+        std::vector<uint32_t> sliceRgbas;
+        RandomSliceColors(desc, sliceColors, sliceRgbas);
+
+        for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+            backend.Clear(producerTexture, subres, sliceColors[desc.SliceOf(subres)]);
+        }
+        backend.Submit();
+
+        const auto runPath = [&](const char* path, const std::function<std::vector<VerifyResult>()>& func) {
+            const std::string id = std::string(backend.Name()) + "_" + path;
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            const std::vector<VerifyResult> result = func();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+            if ((report != nullptr) && (test >= warmupIterations)) {
+                report->Record(id.c_str(), desc, elapsed.count());
+            }
+
+            const bool passed = std::all_of(result.begin(), result.end(), [](const VerifyResult& subres) { return subres.Passed(); });
+            allPassed = allPassed && passed;
+            if ((report == nullptr) || !passed) {
+                std::cout << id << "\n";
+                PrintResult(desc, result);
+                std::cout << "\n";
+            }
+        };
+
+        runPath("readback", [&] { return TryBackendReadback(backend, producerTexture, desc, sliceRgbas.data()); });
+        runPath("slice_readback", [&] { return TryBackendSliceReadback(backend, producerTexture, desc, sliceRgbas.data()); });
+        runPath("shared_copy",
+                [&] { return TryBackendSharedCopy(backend, sharedTexture, consumerTexture, desc, sliceRgbas.data()); });
+        runPath("intermediate_copy",
+                [&] { return TryBackendIntermediateCopy(backend, sharedTexture, intermediateTexture, desc, sliceRgbas.data()); });
+    }
+
+    return allPassed;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "BenchmarkReport.h"
+#include "TextureArrayDesc.h"
+#include "VerifySurface.h"
+
+// The operations the backend-neutral tests need from a graphics API: textures, shared opens, recorded clears and
+// copies, fences and readback. Clears and copies are recorded until Submit(), which returns a fence value.
+class InteropBackend {
+public:
+    using TextureId = uint32_t;
+    using ReadbackFunc = std::function<void(uint32_t subres, const void* data, uint32_t rowPitch)>;
+
+    virtual ~InteropBackend() = default;
+
+    virtual const char* Name() const = 0;
+
+    virtual TextureId CreateTextureArray(const TextureArrayDesc& desc) = 0;
+    // Another id for the same storage, opened through the backend's sharing mechanism
+    virtual TextureId OpenShared(TextureId texture) = 0;
+
+    virtual void Clear(TextureId texture, uint32_t subres, const DirectX::XMFLOAT4& color) = 0;
+    virtual void CopySubresource(TextureId dst, uint32_t dstSubres, TextureId src, uint32_t srcSubres) = 0;
+
+    virtual uint64_t Submit() = 0;
+    virtual void WaitForFence(uint64_t value) = 0;
+
+    // Submits, waits and hands subresources [firstSubres, firstSubres + numSubres) to `consume` in one readback
+    virtual void ReadBack(TextureId texture, uint32_t firstSubres, uint32_t numSubres, const ReadbackFunc& consume) = 0;
+};
+
+// Every subresource in one readback
+std::vector<VerifyResult> TryBackendReadback(InteropBackend& backend,
+                                             InteropBackend::TextureId texture,
+                                             const TextureArrayDesc& desc,
+                                             const uint32_t expectedRgbas[]);
+
+// One readback per array slice, the way the pooled intermediate path streams slices
+std::vector<VerifyResult> TryBackendSliceReadback(InteropBackend& backend,
+                                                  InteropBackend::TextureId texture,
+                                                  const TextureArrayDesc& desc,
+                                                  const uint32_t expectedRgbas[]);
+
+// Copies every subresource out of the shared open into a texture of the consumer, then reads that back
+std::vector<VerifyResult> TryBackendSharedCopy(InteropBackend& backend,
+                                               InteropBackend::TextureId sharedTexture,
+                                               InteropBackend::TextureId consumerTexture,
+                                               const TextureArrayDesc& desc,
+                                               const uint32_t expectedRgbas[]);
+
+// Copies each slice of the shared open into a single-slice intermediate and reads that back, like the D3D12 to D3D11
+// intermediate path
+std::vector<VerifyResult> TryBackendIntermediateCopy(InteropBackend& backend,
+                                                     InteropBackend::TextureId sharedTexture,
+                                                     InteropBackend::TextureId intermediateTexture,
+                                                     const TextureArrayDesc& desc,
+                                                     const uint32_t expectedRgbas[]);
+
+// The fill/readback part of TextureArrayTest against any backend, so it also runs without a GPU. Returns false if any
+// path read back unexpected texels.
+bool BackendTextureArrayTest(InteropBackend& backend,
+                             const TextureArrayDesc& desc,
+                             uint32_t iterations = 10,
+                             uint32_t warmupIterations = 0,
+                             BenchmarkReport* report = nullptr);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// The worker threads behind D3D12ParallelRecorder, independent of the API so the range split and its scaling can be
+// tested with a stand-in recorder. Run() splits [0, numItems) into one contiguous range per worker, range i going to
+// worker i, and blocks until every range is recorded.
+class ParallelRangeRunner {
+public:
+    using RangeFunc = std::function<void(uint32_t worker, uint32_t begin, uint32_t end)>;
+
+    explicit ParallelRangeRunner(uint32_t numThreads) : m_threads(std::max(1U, numThreads)) {
+        for (uint32_t i = 0; i < m_threads.size(); ++i) {
+            m_threads[i] = std::thread([this, i] { WorkerLoop(i); });
+        }
+    }
+
+    ~ParallelRangeRunner() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wakeWorkers.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    ParallelRangeRunner(const ParallelRangeRunner&) = delete;
+    ParallelRangeRunner& operator=(const ParallelRangeRunner&) = delete;
+
+    uint32_t NumThreads() const {
+        return static_cast<uint32_t>(m_threads.size());
+    }
+
+    // Returns the number of ranges, which ran on workers [0, numRanges). Rethrows the first exception a range threw,
+    // after every range finished.
+    uint32_t Run(uint32_t numItems, const RangeFunc& func) {
+        const uint32_t numRanges = std::min(numItems, NumThreads());
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_func = &func;
+            m_numItems = numItems;
+            m_numRanges = numRanges;
+            m_error = nullptr;
+            m_numPending = NumThreads();
+            ++m_generation;
+        }
+        m_wakeWorkers.notify_all();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_workDone.wait(lock, [this] { return m_numPending == 0; });
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+        return numRanges;
+    }
+
+    // First item of range `index` out of `numRanges`
+    static uint32_t RangeBegin(uint32_t numItems, uint32_t numRanges, uint32_t index) {
+        return static_cast<uint32_t>(static_cast<uint64_t>(numItems) * index / numRanges);
+    }
+
+private:
+    void WorkerLoop(uint32_t index) {
+        uint64_t seenGeneration = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeWorkers.wait(lock, [&] { return m_stopping || (m_generation != seenGeneration); });
+                if (m_stopping) {
+                    return;
+                }
+                seenGeneration = m_generation;
+            }
+
+            if (index < m_numRanges) {
+                try {
+                    (*m_func)(index, RangeBegin(m_numItems, m_numRanges, index), RangeBegin(m_numItems, m_numRanges, index + 1));
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error) {
+                        m_error = std::current_exception();
+                    }
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_numPending == 0) {
+                    m_workDone.notify_one();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wakeWorkers;
+    std::condition_variable m_workDone;
+    uint64_t m_generation = 0;
+    uint32_t m_numPending = 0;
+    bool m_stopping = false;
+
+    // Job of the current generation, written under the mutex before the workers are woken
+    const RangeFunc* m_func = nullptr;
+    uint32_t m_numItems = 0;
+    uint32_t m_numRanges = 0;
+    std::exception_ptr m_error;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TextureArrayDesc.h"
+#include "VerifySurface.h"
+
+// One candidate path's probe: whether it read back the expected texels, and its median latency if it did
+struct PathMeasurement {
+    std::string id;
+    bool correct = false;
+    double medianMs = 0;
+};
+
+// The fastest correct path, or an empty id if no path works
+inline std::string PickFastestPath(const std::vector<PathMeasurement>& measurements) {
+    const PathMeasurement* fastest = nullptr;
+    for (const auto& measurement : measurements) {
+        if (measurement.correct && ((fastest == nullptr) || (measurement.medianMs < fastest->medianMs))) {
+            fastest = &measurement;
+        }
+    }
+    return fastest ? fastest->id : std::string();
+}
+
+// Zero-copy readback pays off only where the GPU writes memory the CPU can read through its caches. On UMA without
+// cache coherency the CPU mapping would have to be write-combined, and reading that is slower than the staging copy.
+// CacheCoherentUMA only means something when UMA is set, so a discrete GPU reporting it doesn't qualify.
+inline bool ZeroCopyReadbackSupported(bool uma, bool cacheCoherentUma) {
+    return uma && cacheCoherentUma;
+}
+
+// Picks the interop path to use for an array: every candidate is run once to check it reads back correct texels, the
+// correct ones are timed over a few trials at the real array size, and the fastest wins. Decisions are persisted per
+// array description, shared resource tier and driver version, since the winner changes with each of them. The clock is
+// only replaced by tests, to feed synthetic timings.
+class InteropPathSelector {
+public:
+    using ClockFunc = std::function<double()>;
+
+    struct Candidate {
+        std::string id;
+        std::function<std::vector<VerifyResult>()> run;
+    };
+
+    struct Selection {
+        std::string id;
+        bool fromCache = false;
+        std::vector<PathMeasurement> measurements;
+    };
+
+    InteropPathSelector(std::string fileName,
+                        uint32_t sharedResourceTier,
+                        uint64_t driverVersion,
+                        uint32_t numTrials = 5,
+                        ClockFunc clockMs = SteadyClockMs)
+        : m_fileName(std::move(fileName)),
+          m_tier(sharedResourceTier),
+          m_driverVersion(driverVersion),
+          m_numTrials(numTrials),
+          m_clockMs(std::move(clockMs)) {
+        std::ifstream file(m_fileName);
+        std::string key;
+        std::string id;
+        while (file >> key >> id) {
+            m_decisions[key] = id;
+        }
+    }
+
+    // A cached decision is only reused while its path is still among the candidates
+    Selection Select(const TextureArrayDesc& desc, const std::vector<Candidate>& candidates) {
+        Selection selection;
+
+        const std::string key = Key(desc);
+        auto iter = m_decisions.find(key);
+        if (iter != m_decisions.end()) {
+            for (const auto& candidate : candidates) {
+                if (candidate.id == iter->second) {
+                    selection.id = iter->second;
+                    selection.fromCache = true;
+                    return selection;
+                }
+            }
+        }
+
+        for (const auto& candidate : candidates) {
+            PathMeasurement measurement;
+            measurement.id = candidate.id;
+            measurement.correct = Correct(candidate.run());
+
+            std::vector<double> latenciesMs;
+            for (uint32_t trial = 0; measurement.correct && (trial < m_numTrials); ++trial) {
+                const double startMs = m_clockMs();
+                measurement.correct = Correct(candidate.run());
+                latenciesMs.push_back(m_clockMs() - startMs);
+            }
+            if (measurement.correct && !latenciesMs.empty()) {
+                std::nth_element(latenciesMs.begin(), latenciesMs.begin() + latenciesMs.size() / 2, latenciesMs.end());
+                measurement.medianMs = latenciesMs[latenciesMs.size() / 2];
+            }
+
+            selection.measurements.push_back(measurement);
+        }
+
+        selection.id = PickFastestPath(selection.measurements);
+        if (!selection.id.empty()) {
+            m_decisions[key] = selection.id;
+            Save();
+        }
+        return selection;
+    }
+
+    // Every field of the description, with the format by name so the file stays readable
+    std::string Key(const TextureArrayDesc& desc) const {
+        return std::string(FormatName(desc.format)) + "_" + std::to_string(desc.width) + "x" + std::to_string(desc.height) + "x" +
+               std::to_string(desc.arraySize) + "_mips" + std::to_string(desc.mipLevels) + "_samples" + std::to_string(desc.sampleCount) +
+               "_tier" + std::to_string(m_tier) + "_driver" + std::to_string(m_driverVersion);
+    }
+
+private:
+    static double SteadyClockMs() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool Correct(const std::vector<VerifyResult>& result) {
+        if (result.empty()) {
+            return false;
+        }
+        for (const auto& subres : result) {
+            if (!subres.Passed()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Save() const {
+        std::ofstream file(m_fileName);
+        for (const auto& [key, id] : m_decisions) {
+            file << key << " " << id << "\n";
+        }
+    }
+
+    std::string m_fileName;
+    uint32_t m_tier;
+    uint64_t m_driverVersion;
+    uint32_t m_numTrials;
+    ClockFunc m_clockMs;
+    std::map<std::string, std::string> m_decisions;
+};
@@ -0,0 +1,40 @@
+#include <exception>
+#include <iostream>
+
+#include "BenchmarkReport.h"
+#include "CpuInteropBackend.h"
+#include "VerifySurface.h"
+
+// Runs the benchmark matrix through the CPU backend, so throughput runs work headless and off Windows.
+// Usage: SharedTextureArrayPortable [iterations [warmupIterations [maxArrayMiB]]] [--array ENTRY]... [--matrix FILE]...
+// with entries like 2048x2048x64xfull:B8G8R8A8_UNORM, see ParseMatrixEntry()
+int main(int argc, char** argv) {
+    BenchmarkOptions options;
+    try {
+        options = ParseBenchmarkArgs(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+    const uint64_t maxArrayBytes = options.maxArrayMiB * 1024 * 1024;
+
+    VerifySurfaceBenchmark();
+
+    BenchmarkReport report;
+    bool allPassed = true;
+    for (const TextureArrayDesc& desc : options.matrix) {
+        if (TextureArrayBytes(desc) > maxArrayBytes) {
+            std::cout << "Skipping " << desc.width << "x" << desc.height << "x" << desc.arraySize << ", "
+                      << TextureArrayBytes(desc) / (1024 * 1024) << " MiB is above the limit\n\n";
+            continue;
+        }
+
+        CpuInteropBackend cpuBackend;
+        const uint32_t numRuns = options.warmupIterations + options.iterations;
+        allPassed = BackendTextureArrayTest(cpuBackend, desc, numRuns, options.warmupIterations, &report) && allPassed;
+    }
+    report.Print();
+    report.WriteJson("SharedTextureArray_PortableBenchmark.json");
+
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// The frame ring behind D3D12ReadbackPipeline, independent of the API so its blocking and ordering can be tested
+// without a device. Each of `depth` slots holds one frame in flight, tagged with the fence value of its submission.
+// Frames are consumed oldest first, and Acquire() only waits when every slot is in flight. Waits go through `timeline`,
+// a FenceTimeline; `consume(slot, frameId)` reads a finished frame out of the slot's memory.
+class ReadbackFrameRing {
+public:
+    explicit ReadbackFrameRing(uint32_t depth) : m_slots(depth) {
+        if (depth == 0) {
+            throw std::invalid_argument("A readback pipeline needs at least one frame");
+        }
+    }
+
+    uint32_t Depth() const {
+        return static_cast<uint32_t>(m_slots.size());
+    }
+
+    uint32_t NumInFlight() const {
+        return m_numInFlight;
+    }
+
+    bool InFlight(uint32_t slot) const {
+        return m_slots.at(slot).inFlight;
+    }
+
+    uint64_t FenceValue(uint32_t slot) const {
+        return m_slots.at(slot).fenceValue;
+    }
+
+    // The slot to record the next frame into. Consumes the oldest frame first if every slot is in flight.
+    template <typename Timeline, typename Consume>
+    uint32_t Acquire(Timeline& timeline, Consume&& consume) {
+        if (m_numInFlight == m_slots.size()) {
+            ConsumeOldest(timeline, consume);
+        }
+        return Next();
+    }
+
+    // Marks the acquired slot in flight until the fence value retires and returns the frame's ID
+    uint64_t Commit(uint64_t fenceValue) {
+        if (m_numInFlight == m_slots.size()) {
+            throw std::invalid_argument("Every readback frame is already in flight");
+        }
+
+        Slot& slot = m_slots[Next()];
+        slot.fenceValue = fenceValue;
+        slot.frameId = m_nextFrameId++;
+        slot.inFlight = true;
+        ++m_numInFlight;
+        return slot.frameId;
+    }
+
+    // Consumes, in submission order, every frame the GPU has already finished without blocking
+    template <typename Timeline, typename Consume>
+    void Poll(Timeline& timeline, Consume&& consume) {
+        while ((m_numInFlight > 0) && timeline.IsComplete(m_slots[m_oldest].fenceValue)) {
+            ConsumeOldest(timeline, consume);
+        }
+    }
+
+    // Consumes every frame in flight, in submission order, waiting for each
+    template <typename Timeline, typename Consume>
+    void Drain(Timeline& timeline, Consume&& consume) {
+        while (m_numInFlight > 0) {
+            ConsumeOldest(timeline, consume);
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t fenceValue = 0;
+        uint64_t frameId = 0;
+        bool inFlight = false;
+    };
+
+    uint32_t Next() const {
+        return (m_oldest + m_numInFlight) % Depth();
+    }
+
+    template <typename Timeline, typename Consume>
+    void ConsumeOldest(Timeline& timeline, Consume& consume) {
+        Slot& slot = m_slots[m_oldest];
+        timeline.WaitFor(slot.fenceValue);
+        consume(m_oldest, slot.frameId);
+
+        slot.inFlight = false;
+        m_oldest = (m_oldest + 1) % Depth();
+        --m_numInFlight;
+    }
+
+    std::vector<Slot> m_slots;
+    uint32_t m_oldest = 0;
+    uint32_t m_numInFlight = 0;
+    uint64_t m_nextFrameId = 0;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// The bookkeeping behind D3D12ReadbackAllocator, independent of the API so page reuse can be tested without a device.
+// Allocations are bumped out of pages; a page is rewound once all of its allocations have been released and the fence
+// value of the last release has retired. An allocation that fits no page gets a new page of at least the page size,
+// which the caller backs with memory when `page` is the page count before the call.
+class ReadbackPageAllocator {
+public:
+    struct Allocation {
+        uint32_t page = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    struct Stats {
+        uint64_t numAllocations = 0;
+        uint64_t numHits = 0;
+        uint64_t numPagesCreated = 0;
+        uint64_t bytesInUse = 0;
+        uint64_t peakBytesInUse = 0;
+        uint64_t reservedBytes = 0;
+
+        double HitRate() const {
+            return numAllocations == 0 ? 0.0 : static_cast<double>(numHits) / numAllocations;
+        }
+    };
+
+    explicit ReadbackPageAllocator(uint64_t pageSize) : m_pageSize(pageSize) {
+    }
+
+    // `isComplete(fenceValue)` tells whether the queue has passed a fence value. It is only asked about pages that
+    // could be rewound.
+    template <typename IsComplete>
+    Allocation Allocate(uint64_t size, uint64_t alignment, IsComplete&& isComplete) {
+        ++m_stats.numAllocations;
+
+        uint32_t pageIndex = 0;
+        for (; pageIndex < m_pages.size(); ++pageIndex) {
+            Page& page = m_pages[pageIndex];
+            if ((page.numLive == 0) && (page.offset != 0) && isComplete(page.retireFenceValue)) {
+                page.offset = 0;
+            }
+            if (AlignUp(page.offset, alignment) + size <= page.size) {
+                ++m_stats.numHits;
+                break;
+            }
+        }
+        if (pageIndex == m_pages.size()) {
+            Page page;
+            page.size = std::max(m_pageSize, size);
+            m_pages.push_back(page);
+
+            ++m_stats.numPagesCreated;
+            m_stats.reservedBytes += page.size;
+        }
+
+        Page& page = m_pages[pageIndex];
+        Allocation allocation;
+        allocation.page = pageIndex;
+        allocation.offset = AlignUp(page.offset, alignment);
+        allocation.size = size;
+
+        page.offset = allocation.offset + size;
+        ++page.numLive;
+
+        m_stats.bytesInUse += size;
+        m_stats.peakBytesInUse = std::max(m_stats.peakBytesInUse, m_stats.bytesInUse);
+
+        return allocation;
+    }
+
+    // The region may be reused once the queue passes fenceValue
+    void Release(const Allocation& allocation, uint64_t fenceValue) {
+        Page& page = m_pages.at(allocation.page);
+        --page.numLive;
+        page.retireFenceValue = std::max(page.retireFenceValue, fenceValue);
+
+        m_stats.bytesInUse -= allocation.size;
+    }
+
+    uint32_t NumPages() const {
+        return static_cast<uint32_t>(m_pages.size());
+    }
+
+    uint64_t PageSize(uint32_t page) const {
+        return m_pages.at(page).size;
+    }
+
+    // The fence value the page's memory is in use until
+    uint64_t RetireFenceValue(uint32_t page) const {
+        return m_pages.at(page).retireFenceValue;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Page {
+        uint64_t size = 0;
+        uint64_t offset = 0;
+        uint32_t numLive = 0;
+        uint64_t retireFenceValue = 0;
+    };
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    uint64_t m_pageSize;
+    std::vector<Page> m_pages;
+    Stats m_stats;
+};
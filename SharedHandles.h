@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+// The caching behind SharedResourceRegistry, independent of the API so handle lifetimes can be tested without a
+// device. A resource is shared and opened on the other device once; later opens hit the cached entry until the
+// resource is released. `Sharing` provides
+//     using Resource, Opened, Entry  the key, the resource opened on the other device and an entry owning the shared
+//                                    handle, a reference to the resource and the opened one in its `opened` member
+//     Entry Share(Resource resource)  creates the shared handle and opens it; destroying the entry closes the handle
+template <typename Sharing>
+class SharedHandleRegistry {
+public:
+    using Resource = typename Sharing::Resource;
+    using Opened = typename Sharing::Opened;
+    using Entry = typename Sharing::Entry;
+
+    struct Stats {
+        uint64_t numOpens = 0;
+        uint64_t numHits = 0;
+        uint64_t numLiveHandles = 0;
+    };
+
+    template <typename... Args>
+    explicit SharedHandleRegistry(Args&&... args) : m_sharing(std::forward<Args>(args)...) {
+    }
+
+    SharedHandleRegistry(const SharedHandleRegistry&) = delete;
+    SharedHandleRegistry& operator=(const SharedHandleRegistry&) = delete;
+
+    Opened Open(Resource resource) {
+        auto iter = m_entries.find(resource);
+        if (iter != m_entries.end()) {
+            ++m_stats.numHits;
+            return iter->second.opened;
+        }
+
+        // The entry holds a reference, so the key can't be recycled by a new resource while it is registered
+        Entry entry = m_sharing.Share(resource);
+
+        ++m_stats.numOpens;
+        ++m_stats.numLiveHandles;
+
+        return m_entries.emplace(resource, std::move(entry)).first->second.opened;
+    }
+
+    void Release(Resource resource) {
+        if (m_entries.erase(resource) != 0) {
+            --m_stats.numLiveHandles;
+        }
+    }
+
+    void Clear() {
+        m_entries.clear();
+        m_stats.numLiveHandles = 0;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    Sharing m_sharing;
+    std::unordered_map<Resource, Entry> m_entries;
+    Stats m_stats;
+};
@@ -1,735 +1,4005 @@
-#include <iostream>
-
-#include <sdkddkver.h>
-
-#define NOMINMAX
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <Unknwnbase.h>
-
-#include <winrt/base.h>
-
-#include <array>
-#include <tuple>
-#include <functional>
-
-#include <d3d11_4.h>
-#include <d3d12.h>
-#include <d3d12sdklayers.h>
-#include <dxgi1_6.h>
-#include <DirectXMath.h>
-
-#include "renderdoc_app.h"
-
-//#define FORCE_WARP
-
-#define RDOC_CAPTURE_DX11
-// #define RDOC_CAPTURE_DX12
-
-using namespace DirectX;
-
-winrt::com_ptr<ID3D11Device5> CreateD3D11Device() {
-    UINT creationFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-#if defined(_DEBUG)
-    creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-    D3D_FEATURE_LEVEL featureLevels[] = {D3D_FEATURE_LEVEL_12_1,
-                                         D3D_FEATURE_LEVEL_12_0,
-                                         D3D_FEATURE_LEVEL_11_1,
-                                         D3D_FEATURE_LEVEL_11_0,
-                                         D3D_FEATURE_LEVEL_10_1,
-                                         D3D_FEATURE_LEVEL_10_0};
-
-    winrt::com_ptr<ID3D11Device> device;
-    winrt::com_ptr<ID3D11DeviceContext> context;
-
-#ifdef FORCE_WARP
-    const D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_WARP;
-#else
-    const D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_HARDWARE;
-#endif
-
-    D3D_FEATURE_LEVEL d3dFeatureLevel;
-    winrt::check_hresult(D3D11CreateDevice(nullptr,
-                                           driverType,
-                                           0,
-                                           creationFlags,
-                                           featureLevels,
-                                           static_cast<UINT>(std::size(featureLevels)),
-                                           D3D11_SDK_VERSION,
-                                           device.put(),
-                                           &d3dFeatureLevel,
-                                           context.put()));
-
-    return device.as<ID3D11Device5>();
-}
-
-winrt::com_ptr<ID3D12Device> CreateD3D12Device() {
-    UINT dxgiFactoryFlags = 0;
-
-#if defined(_DEBUG)
-    winrt::com_ptr<ID3D12Debug> debugCtrl;
-    if (SUCCEEDED(D3D12GetDebugInterface(IID_ID3D12Debug, debugCtrl.put_void()))) {
-        debugCtrl->EnableDebugLayer();
-
-        dxgiFactoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
-    }
-#endif
-
-    winrt::com_ptr<IDXGIFactory4> dxgiFactory;
-    winrt::check_hresult(CreateDXGIFactory2(dxgiFactoryFlags, IID_IDXGIFactory4, dxgiFactory.put_void()));
-
-    winrt::com_ptr<IDXGIAdapter> dxgiAdapter;
-#ifdef FORCE_WARP
-    dxgiFactory->EnumWarpAdapter(winrt::guid_of<IDXGIAdapter>(), dxgiAdapter.put_void());
-#endif
-
-    winrt::com_ptr<ID3D12Device> d3d12Device;
-    winrt::check_hresult(
-        D3D12CreateDevice(dxgiAdapter.get(), D3D_FEATURE_LEVEL_11_0, winrt::guid_of<ID3D12Device>(), d3d12Device.put_void()));
-
-    return d3d12Device;
-}
-
-void D3D12ForceFinish(ID3D12Device* device, ID3D12CommandQueue* cmdQueue) {
-    winrt::com_ptr<ID3D12Fence> finishFence;
-    uint64_t finishFenceValue{0};
-    winrt::check_hresult(
-        device->CreateFence(finishFenceValue, D3D12_FENCE_FLAG_NONE, winrt::guid_of<ID3D12Fence>(), finishFence.put_void()));
-    winrt::check_hresult(cmdQueue->Signal(finishFence.get(), ++finishFenceValue));
-    HANDLE fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    winrt::check_hresult(finishFence->SetEventOnCompletion(finishFenceValue, fenceEvent));
-    const uint32_t retVal = WaitForSingleObjectEx(fenceEvent, INFINITE, FALSE);
-    switch (retVal) {
-    case WAIT_OBJECT_0:
-        break;
-
-    default:
-        winrt::check_hresult(E_FAIL);
-    }
-    CloseHandle(fenceEvent);
-}
-
-std::tuple<winrt::com_ptr<ID3D11Texture2D>, winrt::com_ptr<ID3D12Resource>, winrt::com_ptr<ID3D11Texture2D>>
-CreateTextureArray(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) {
-    D3D12_RESOURCE_DESC d3d12TextureDesc{};
-    d3d12TextureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    d3d12TextureDesc.Alignment = 0;
-    d3d12TextureDesc.Width = 256;
-    d3d12TextureDesc.Height = 256;
-    d3d12TextureDesc.DepthOrArraySize = 2;
-    d3d12TextureDesc.MipLevels = 1;
-    d3d12TextureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    d3d12TextureDesc.SampleDesc.Count = 1;
-    d3d12TextureDesc.SampleDesc.Quality = 0;
-    d3d12TextureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-    d3d12TextureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
-
-    D3D12_HEAP_PROPERTIES heapProperties;
-    heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
-    heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-    heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-    heapProperties.CreationNodeMask = 0;
-    heapProperties.VisibleNodeMask = 0;
-
-    D3D12_CLEAR_VALUE clearValue{};
-    clearValue.Format = d3d12TextureDesc.Format;
-
-    winrt::com_ptr<ID3D12Resource> d3d12Texture;
-    winrt::check_hresult(d3d12Device->CreateCommittedResource(&heapProperties,
-                                                              D3D12_HEAP_FLAG_SHARED,
-                                                              &d3d12TextureDesc,
-                                                              D3D12_RESOURCE_STATE_RENDER_TARGET,
-                                                              &clearValue,
-                                                              winrt::guid_of<ID3D12Resource>(),
-                                                              d3d12Texture.put_void()));
-
-    HANDLE sharedHandle;
-    winrt::check_hresult(d3d12Device->CreateSharedHandle(d3d12Texture.get(), nullptr, GENERIC_ALL, nullptr, &sharedHandle));
-
-    winrt::com_ptr<ID3D11Texture2D> sharedD3d11Texture;
-    winrt::check_hresult(d3d11Device->OpenSharedResource1(sharedHandle, winrt::guid_of<ID3D11Texture2D>(), sharedD3d11Texture.put_void()));
-
-    // Create another from dx11
-    winrt::com_ptr<ID3D11Texture2D> d3d11Texture;
-    D3D11_TEXTURE2D_DESC dx11TexDesc;
-    sharedD3d11Texture->GetDesc(&dx11TexDesc);
-    winrt::check_hresult(d3d11Device->CreateTexture2D(&dx11TexDesc, nullptr, d3d11Texture.put()));
-
-    return {sharedD3d11Texture, d3d12Texture, d3d11Texture};
-}
-
-void FillTextureArray(ID3D12Device* d3d12Device,
-                      ID3D12GraphicsCommandList* d3d12CmdList,
-                      ID3D12Resource* d3d12Texture,
-                      ID3D11Texture2D* d3d11Texture,
-                      const XMFLOAT4 subresColors[2]) {
-    // Fill subresColors to d3d12 natively created texture
-    D3D12_RESOURCE_DESC d3d12TextureDesc = d3d12Texture->GetDesc();
-
-    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
-    rtvHeapDesc.NumDescriptors = 3;
-    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-    rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-    winrt::com_ptr<ID3D12DescriptorHeap> rtvHeap;
-    winrt::check_hresult(d3d12Device->CreateDescriptorHeap(&rtvHeapDesc, winrt::guid_of<ID3D12DescriptorHeap>(), rtvHeap.put_void()));
-
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandleStart = rtvHeap->GetCPUDescriptorHandleForHeapStart();
-    const uint32_t rtvDescriptorSize = d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-
-    D3D12_RENDER_TARGET_VIEW_DESC rtvDesc;
-    rtvDesc.Format = d3d12TextureDesc.Format;
-    rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
-    rtvDesc.Texture2DArray.MipSlice = 0;
-    rtvDesc.Texture2DArray.ArraySize = 1;
-    rtvDesc.Texture2DArray.PlaneSlice = 0;
-
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandles[2];
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        rtvDesc.Texture2DArray.FirstArraySlice = subres;
-        rtvHandles[subres].ptr = rtvHandleStart.ptr + subres * rtvDescriptorSize;
-
-        d3d12Device->CreateRenderTargetView(d3d12Texture, &rtvDesc, rtvHandles[subres]);
-    }
-
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        d3d12CmdList->ClearRenderTargetView(rtvHandles[subres], &subresColors[subres].x, 0, nullptr);
-    }
-
-    // Fill the same data to d3d11 natively created texture
-    D3D11_RENDER_TARGET_VIEW_DESC rtvDescDx11;
-    D3D11_TEXTURE2D_DESC d3d11TextureDesc;
-    winrt::com_ptr<ID3D11RenderTargetView> rtvD3d11;
-    d3d11Texture->GetDesc(&d3d11TextureDesc);
-    rtvDescDx11.Format = d3d11TextureDesc.Format;
-    rtvDescDx11.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
-    rtvDescDx11.Texture2DArray.MipSlice = 0;
-    rtvDescDx11.Texture2DArray.ArraySize = 1;
-
-    winrt::com_ptr<ID3D11Device> d3d11Device;
-    d3d11Texture->GetDevice(d3d11Device.put());
-    winrt::com_ptr<ID3D11DeviceContext> d3d11Context;
-    d3d11Device->GetImmediateContext(d3d11Context.put());
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        rtvDescDx11.Texture2DArray.FirstArraySlice = subres;
-        d3d11Device->CreateRenderTargetView(d3d11Texture, &rtvDescDx11, rtvD3d11.put());
-        d3d11Context->ClearRenderTargetView(rtvD3d11.get(), &subresColors[subres].x);
-
-        rtvD3d11 = nullptr;
-    }
-}
-
-void PrintResult(const std::array<bool, 2>& slice) {
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        std::cout << "\tSlice " << subres << " ";
-        if (slice[subres]) {
-            std::cout << "succeeded!";
-        } else {
-            std::cout << "FAILED!!!";
-        }
-        std::cout << "\n";
-    }
-}
-
-std::array<bool, 2> TryDirectlyCopyFromD3D12ToD3D12(ID3D12Device* d3d12Device,
-                                                    ID3D12CommandQueue* d3d12CmdQueue,
-                                                    ID3D12GraphicsCommandList* d3d12CmdList,
-                                                    ID3D12CommandAllocator* d3d12CmdAllocator,
-                                                    ID3D12Resource* d3d12Texture,
-                                                    const uint32_t expectedRgbas[]) {
-    std::array<bool, 2> ret;
-
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        D3D12_RESOURCE_BARRIER barrier;
-        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        barrier.Transition.pResource = d3d12Texture;
-        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
-        D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout;
-        uint32_t numRows = 0;
-        uint64_t rowSizeInBytes = 0;
-        uint64_t requiredSize = 0;
-        d3d12Device->GetCopyableFootprints(&colorDesc, subres, 1, 0, &layout, &numRows, &rowSizeInBytes, &requiredSize);
-
-        D3D12_HEAP_PROPERTIES heap;
-        heap.Type = D3D12_HEAP_TYPE_READBACK;
-        heap.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        heap.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        heap.CreationNodeMask = 1;
-        heap.VisibleNodeMask = 1;
-
-        D3D12_RESOURCE_DESC bufferDesc{};
-        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        bufferDesc.Alignment = 0;
-        bufferDesc.Width = requiredSize;
-        bufferDesc.Height = 1;
-        bufferDesc.DepthOrArraySize = 1;
-        bufferDesc.MipLevels = 1;
-        bufferDesc.SampleDesc.Count = 1;
-        bufferDesc.SampleDesc.Quality = 0;
-        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-        winrt::com_ptr<ID3D12Resource> buffer;
-        winrt::check_hresult(d3d12Device->CreateCommittedResource(
-            &heap, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_ID3D12Resource, buffer.put_void()));
-
-        D3D12_BOX srcBox;
-        srcBox.left = 0;
-        srcBox.top = 0;
-        srcBox.front = 0;
-        srcBox.right = static_cast<UINT>(colorDesc.Width);
-        srcBox.bottom = static_cast<UINT>(colorDesc.Height);
-        srcBox.back = 1;
-
-        D3D12_TEXTURE_COPY_LOCATION src;
-        src.pResource = d3d12Texture;
-        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        src.SubresourceIndex = subres;
-
-        D3D12_TEXTURE_COPY_LOCATION dst;
-        dst.pResource = buffer.get();
-        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-        dst.PlacedFootprint = layout;
-
-        d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, &srcBox);
-
-        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        {
-            d3d12CmdList->Close();
-            ID3D12CommandList* cmdLists[] = {d3d12CmdList};
-            d3d12CmdQueue->ExecuteCommandLists(static_cast<uint32_t>(std::size(cmdLists)), cmdLists);
-
-            D3D12ForceFinish(d3d12Device, d3d12CmdQueue);
-
-            d3d12CmdAllocator->Reset();
-            d3d12CmdList->Reset(d3d12CmdAllocator, nullptr);
-        }
-
-        D3D12_RANGE read_range;
-        read_range.Begin = 0;
-        read_range.End = static_cast<SIZE_T>(requiredSize);
-
-        uint32_t* ptr;
-        buffer->Map(0, &read_range, reinterpret_cast<void**>(&ptr));
-
-        ret[subres] = (ptr[0] == expectedRgbas[subres]);
-
-        read_range.End = 0;
-        buffer->Unmap(0, &read_range);
-    }
-
-    return ret;
-}
-
-std::array<bool, 2> TryIntermediateTextureCopyFromD3D12ToD3D11(ID3D11Device5* d3d11Device,
-                                                               ID3D12Device* d3d12Device,
-                                                               ID3D12CommandQueue* d3d12CmdQueue,
-                                                               ID3D12GraphicsCommandList* d3d12CmdList,
-                                                               ID3D12CommandAllocator* d3d12CmdAllocator,
-                                                               ID3D11Texture2D* d3d11Texture,
-                                                               ID3D12Resource* d3d12Texture,
-                                                               const uint32_t expectedRgbas[]) {
-    std::array<bool, 2> ret;
-
-    D3D12_RESOURCE_DESC sliceTextureDesc = d3d12Texture->GetDesc();
-    sliceTextureDesc.DepthOrArraySize = 1;
-
-    D3D12_HEAP_PROPERTIES heapProperties;
-    D3D12_HEAP_FLAGS heapFlags;
-    winrt::check_hresult(d3d12Texture->GetHeapProperties(&heapProperties, &heapFlags));
-
-    D3D12_CLEAR_VALUE clearValue{};
-    clearValue.Format = d3d12Texture->GetDesc().Format;
-
-    winrt::com_ptr<ID3D12Resource> d3d12SliceTexture;
-    winrt::check_hresult(d3d12Device->CreateCommittedResource(&heapProperties,
-                                                              D3D12_HEAP_FLAG_SHARED,
-                                                              &sliceTextureDesc,
-                                                              D3D12_RESOURCE_STATE_COPY_DEST,
-                                                              &clearValue,
-                                                              winrt::guid_of<ID3D12Resource>(),
-                                                              d3d12SliceTexture.put_void()));
-
-    HANDLE sharedHandle;
-    winrt::check_hresult(d3d12Device->CreateSharedHandle(d3d12SliceTexture.get(), nullptr, GENERIC_ALL, nullptr, &sharedHandle));
-
-    winrt::com_ptr<ID3D11Texture2D> sharedD3d11SliceTexture;
-    winrt::check_hresult(
-        d3d11Device->OpenSharedResource1(sharedHandle, winrt::guid_of<ID3D11Texture2D>(), sharedD3d11SliceTexture.put_void()));
-
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        D3D12_RESOURCE_BARRIER barrier;
-        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        barrier.Transition.pResource = d3d12Texture;
-        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        D3D12_TEXTURE_COPY_LOCATION src;
-        src.pResource = d3d12Texture;
-        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        src.SubresourceIndex = subres;
-
-        D3D12_TEXTURE_COPY_LOCATION dst;
-        dst.pResource = d3d12SliceTexture.get();
-        dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        dst.SubresourceIndex = 0;
-
-        d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
-
-        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        d3d12CmdList->Close();
-        ID3D12CommandList* cmdLists[] = {d3d12CmdList};
-        d3d12CmdQueue->ExecuteCommandLists(static_cast<uint32_t>(std::size(cmdLists)), cmdLists);
-
-        D3D12ForceFinish(d3d12Device, d3d12CmdQueue);
-
-        d3d12CmdAllocator->Reset();
-        d3d12CmdList->Reset(d3d12CmdAllocator, nullptr);
-
-        D3D11_TEXTURE2D_DESC colorDesc;
-        d3d11Texture->GetDesc(&colorDesc);
-        colorDesc.Usage = D3D11_USAGE_STAGING;
-        colorDesc.BindFlags = 0;
-        colorDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-        colorDesc.MiscFlags = 0;
-        winrt::com_ptr<ID3D11Texture2D> capturedCpuColorBuffer;
-        winrt::check_hresult(d3d11Device->CreateTexture2D(&colorDesc, nullptr, capturedCpuColorBuffer.put()));
-
-        winrt::com_ptr<ID3D11DeviceContext> deviceContext;
-        d3d11Device->GetImmediateContext(deviceContext.put());
-
-        deviceContext->CopySubresourceRegion(capturedCpuColorBuffer.get(), subres, 0, 0, 0, sharedD3d11SliceTexture.get(), 0, nullptr);
-
-        D3D11_MAPPED_SUBRESOURCE mappedRes;
-        deviceContext->Map(capturedCpuColorBuffer.get(), subres, D3D11_MAP_READ, 0, &mappedRes);
-
-        const uint32_t* ptr = reinterpret_cast<const uint32_t*>(mappedRes.pData);
-        ret[subres] = (ptr[0] == expectedRgbas[subres]);
-
-        deviceContext->Unmap(capturedCpuColorBuffer.get(), subres);
-    }
-
-    return ret;
-}
-
-std::array<bool, 2> TryDirectlyShareFromD3D12ToD3D11(ID3D11Device5* d3d11Device,
-                                                     ID3D11Texture2D* d3d11Texture,
-                                                     const uint32_t expectedRgbas[]) {
-    std::array<bool, 2> ret;
-
-    D3D11_TEXTURE2D_DESC colorDesc;
-    d3d11Texture->GetDesc(&colorDesc);
-    colorDesc.Usage = D3D11_USAGE_STAGING;
-    colorDesc.BindFlags = 0;
-    colorDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-    colorDesc.MiscFlags = 0;
-    winrt::com_ptr<ID3D11Texture2D> capturedCpuColorBuffer;
-    winrt::check_hresult(d3d11Device->CreateTexture2D(&colorDesc, nullptr, capturedCpuColorBuffer.put()));
-
-    winrt::com_ptr<ID3D11DeviceContext> deviceContext;
-    d3d11Device->GetImmediateContext(deviceContext.put());
-    deviceContext->CopyResource(capturedCpuColorBuffer.get(), d3d11Texture);
-
-    for (uint32_t subres = 0; subres < 2; ++subres) {
-        D3D11_MAPPED_SUBRESOURCE mappedRes;
-        deviceContext->Map(capturedCpuColorBuffer.get(), subres, D3D11_MAP_READ, 0, &mappedRes);
-
-        const uint32_t* ptr = reinterpret_cast<const uint32_t*>(mappedRes.pData);
-        ret[subres] = (ptr[0] == expectedRgbas[subres]);
-
-        deviceContext->Unmap(capturedCpuColorBuffer.get(), subres);
-    }
-
-    return ret;
-}
-
-void TryShareD3D11FenceToD3D12(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) {
-    // Note: This currently does nothing; just to test if renderdoc can OpenSharedHandle on fence
-    winrt::com_ptr<ID3D11Fence> fence;
-    winrt::check_hresult(d3d11Device->CreateFence(0, D3D11_FENCE_FLAG_SHARED, winrt::guid_of<ID3D11Fence>(), fence.put_void()));
-
-    HANDLE d3d12FenceSharedFromD3d11;
-    {
-        winrt::check_hresult(fence->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, &d3d12FenceSharedFromD3d11));
-
-        // Try open the handle from d3d12 device
-        winrt::com_ptr<ID3D12Fence> d3d12Fence;
-        winrt::check_hresult(d3d12Device->OpenSharedHandle(d3d12FenceSharedFromD3d11, __uuidof(ID3D12Fence), d3d12Fence.put_void()));
-    }
-    CloseHandle(d3d12FenceSharedFromD3d11);
-    std::cout << "succeeded!" << std::endl;
-}
-
-void TryIUnknownCasting(ID3D11Device* d3d11device, ID3D12Device* d3d12device) {
-    std::cout << "Try back casting d3d12 device from IUnknown" << std::endl;
-    {
-        IUnknown* deviceIUnknown = d3d12device;
-        winrt::com_ptr<ID3D12Device> deviceBackCast;
-        deviceIUnknown->QueryInterface(__uuidof(ID3D12Device), deviceBackCast.put_void());
-
-        if (deviceBackCast.get() != d3d12device) {
-            std::cout << "FAILED..." << std::endl;
-        } else {
-            std::cout << "succeeded!" << std::endl;
-        }
-    }
-
-    std::cout << "Try back casting d3d11 device from IUnknown" << std::endl;
-    {
-        IUnknown* deviceIUnknown = d3d11device;
-        winrt::com_ptr<ID3D11Device> deviceBackCast;
-        deviceIUnknown->QueryInterface(__uuidof(ID3D11Device), deviceBackCast.put_void());
-
-        if (deviceBackCast.get() != d3d11device) {
-            std::cout << "FAILED..." << std::endl;
-        } else {
-            std::cout << "succeeded!" << std::endl;
-        }
-    }
-}
-
-void TryD3D12ImplicitResourceSharing(ID3D12Resource* d3d12Texture) {
-    winrt::com_ptr<ID3D12Device> secondD3d12device = CreateD3D12Device();
-    winrt::com_ptr<ID3D12CommandQueue> d3d12CmdQueue;
-    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    winrt::check_hresult(secondD3d12device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), d3d12CmdQueue.put_void()));
-
-    winrt::com_ptr<ID3D12CommandAllocator> d3d12CmdAllocator;
-    winrt::check_hresult(secondD3d12device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT, winrt::guid_of<ID3D12CommandAllocator>(), d3d12CmdAllocator.put_void()));
-
-    winrt::com_ptr<ID3D12GraphicsCommandList> d3d12CmdList;
-    winrt::check_hresult(secondD3d12device->CreateCommandList(0,
-                                                              D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                              d3d12CmdAllocator.get(),
-                                                              nullptr,
-                                                              winrt::guid_of<ID3D12GraphicsCommandList>(),
-                                                              d3d12CmdList.put_void()));
-    d3d12CmdList->Close();
-
-    winrt::check_hresult(d3d12CmdAllocator->Reset());
-    winrt::check_hresult(d3d12CmdList->Reset(d3d12CmdAllocator.get(), nullptr));
-
-    // Try modify the barrier of texture created from the first device
-    D3D12_RESOURCE_BARRIER barrier;
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-    barrier.Transition.pResource = d3d12Texture;
-    {
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-
-        barrier.Transition.Subresource = 0;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        barrier.Transition.Subresource = 1;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        {
-            d3d12CmdList->Close();
-            ID3D12CommandList* cmdLists[] = {d3d12CmdList.get()};
-            d3d12CmdQueue->ExecuteCommandLists(static_cast<uint32_t>(std::size(cmdLists)), cmdLists);
-
-            D3D12ForceFinish(secondD3d12device.get(), d3d12CmdQueue.get());
-
-            d3d12CmdAllocator->Reset();
-            d3d12CmdList->Reset(d3d12CmdAllocator.get(), nullptr);
-        }
-    }
-    {
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-
-        barrier.Transition.Subresource = 0;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        barrier.Transition.Subresource = 1;
-        d3d12CmdList->ResourceBarrier(1, &barrier);
-
-        {
-            d3d12CmdList->Close();
-            ID3D12CommandList* cmdLists[] = {d3d12CmdList.get()};
-            d3d12CmdQueue->ExecuteCommandLists(static_cast<uint32_t>(std::size(cmdLists)), cmdLists);
-
-            D3D12ForceFinish(secondD3d12device.get(), d3d12CmdQueue.get());
-
-            d3d12CmdAllocator->Reset();
-            d3d12CmdList->Reset(d3d12CmdAllocator.get(), nullptr);
-        }
-    }
-
-    std::cout << "succeeded!\n";
-}
-
-void TextureArrayTest(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) {
-    winrt::com_ptr<ID3D12CommandQueue> d3d12CmdQueue;
-    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    winrt::check_hresult(d3d12Device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), d3d12CmdQueue.put_void()));
-
-    winrt::com_ptr<ID3D12CommandAllocator> d3d12CmdAllocator;
-    winrt::check_hresult(d3d12Device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT, winrt::guid_of<ID3D12CommandAllocator>(), d3d12CmdAllocator.put_void()));
-
-    winrt::com_ptr<ID3D12GraphicsCommandList> d3d12CmdList;
-    winrt::check_hresult(d3d12Device->CreateCommandList(0,
-                                                        D3D12_COMMAND_LIST_TYPE_DIRECT,
-                                                        d3d12CmdAllocator.get(),
-                                                        nullptr,
-                                                        winrt::guid_of<ID3D12GraphicsCommandList>(),
-                                                        d3d12CmdList.put_void()));
-    d3d12CmdList->Close();
-
-    winrt::check_hresult(d3d12CmdAllocator->Reset());
-    winrt::check_hresult(d3d12CmdList->Reset(d3d12CmdAllocator.get(), nullptr));
-
-    auto [d3d11TextureSharedFromD3d12, d3d12Texture, d3d11Texture] = CreateTextureArray(d3d11Device, d3d12Device);
-
-    for (uint32_t test = 0; test < 10; ++test) {
-        std::cout << "================================== Test " << test << " ==================================\n\n";
-
-        const uint8_t components[] = {
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-            static_cast<uint8_t>(rand() & 0xFF),
-        };
-
-        XMFLOAT4 subresColors[2];
-        uint32_t subresRgbas[2];
-        for (size_t i = 0; i < std::size(subresRgbas); ++i) {
-            subresColors[i] = {
-                std::min(1.0f, components[i * 4 + 0] / 255.0f),
-                std::min(1.0f, components[i * 4 + 1] / 255.0f),
-                std::min(1.0f, components[i * 4 + 2] / 255.0f),
-                std::min(1.0f, components[i * 4 + 3] / 255.0f),
-            };
-            subresRgbas[i] =
-                (components[i * 4 + 0] << 0) | (components[i * 4 + 1] << 8) | (components[i * 4 + 2] << 16) | (components[i * 4 + 3] << 24);
-        }
-
-        FillTextureArray(d3d12Device, d3d12CmdList.get(), d3d12Texture.get(), d3d11Texture.get(), subresColors);
-
-        {
-            std::cout << "Directly copy from D3D12 texture to D3D12 texture\n";
-            PrintResult(TryDirectlyCopyFromD3D12ToD3D12(
-                d3d12Device, d3d12CmdQueue.get(), d3d12CmdList.get(), d3d12CmdAllocator.get(), d3d12Texture.get(), subresRgbas));
-            std::cout << "\n";
-        }
-
-        {
-            std::cout << "Take a intermediate texture to copy to D3D11 texture\n";
-            PrintResult(TryIntermediateTextureCopyFromD3D12ToD3D11(d3d11Device,
-                                                                   d3d12Device,
-                                                                   d3d12CmdQueue.get(),
-                                                                   d3d12CmdList.get(),
-                                                                   d3d12CmdAllocator.get(),
-                                                                   d3d11TextureSharedFromD3d12.get(),
-                                                                   d3d12Texture.get(),
-                                                                   subresRgbas));
-            std::cout << "\n";
-        }
-
-        {
-            std::cout << "Directly share to D3D11 texture\n";
-            PrintResult(TryDirectlyShareFromD3D12ToD3D11(d3d11Device, d3d11TextureSharedFromD3d12.get(), subresRgbas));
-            std::cout << "\n";
-        }
-
-        {
-            std::cout << "Try share D3D11 fence to D3D12 and open from D3D12 device\n";
-            TryShareD3D11FenceToD3D12(d3d11Device, d3d12Device);
-            std::cout << "\n";
-        }
-
-        {
-            TryIUnknownCasting(d3d11Device, d3d12Device);
-            std::cout << "\n";
-        }
-
-        {
-            std::cout << "Try modify states of resource created by an irrelevant D3D12 device\n";
-            TryD3D12ImplicitResourceSharing(d3d12Texture.get());
-            std::cout << "\n";
-        }
-    }
-}
-
-RENDERDOC_API_1_4_0* GetRenderdocAPI() {
-    RENDERDOC_API_1_4_0* rdoc_api = nullptr;
-
-    if (HMODULE mod = GetModuleHandleA("renderdoc.dll")) {
-        pRENDERDOC_GetAPI RENDERDOC_GetAPI = (pRENDERDOC_GetAPI)GetProcAddress(mod, "RENDERDOC_GetAPI");
-        int ret = RENDERDOC_GetAPI(eRENDERDOC_API_Version_1_4_0, (void**)&rdoc_api);
-        assert(ret == 1);
-    }
-
-    return rdoc_api;
-}
-
-int main() {
-    RENDERDOC_API_1_4_0* rdoc = GetRenderdocAPI();
-
-    winrt::com_ptr<ID3D11Device5> d3d11Device = CreateD3D11Device();
-    winrt::com_ptr<ID3D12Device> d3d12Device = CreateD3D12Device();
-
-    D3D12_FEATURE_DATA_D3D12_OPTIONS4 optionData;
-    d3d12Device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS4, &optionData, sizeof(optionData));
-    std::cout << "SharedResourceCompatibilityTier: " << optionData.SharedResourceCompatibilityTier << "\n\n";
-
-    // Capture on dx11 device
-#ifdef RDOC_CAPTURE_DX11
-    {
-        if (rdoc) {
-            rdoc->SetCaptureFilePathTemplate("SharedTextureArray_DX11Device");
-            rdoc->StartFrameCapture(d3d11Device.get(), nullptr);
-        }
-
-        TextureArrayTest(d3d11Device.get(), d3d12Device.get());
-
-        if (rdoc) {
-            rdoc->EndFrameCapture(d3d11Device.get(), nullptr);
-        }
-    }
-#endif
-
-#ifdef RDOC_CAPTURE_DX12
-    // Capture on dx12 device
-    {
-        if (rdoc) {
-            rdoc->SetCaptureFilePathTemplate("SharedTextureArray_DX12Device");
-            rdoc->StartFrameCapture(d3d12Device.get(), nullptr);
-        }
-
-        TextureArrayTest(d3d11Device.get(), d3d12Device.get());
-
-        if (rdoc) {
-            rdoc->EndFrameCapture(d3d12Device.get(), nullptr);
-        }
-    }
-#endif
-}
+#include <iostream>
+
+#include <sdkddkver.h>
+
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <Unknwnbase.h>
+
+#include <winrt/base.h>
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <d3d11_4.h>
+#include <d3d12.h>
+#include <d3d12sdklayers.h>
+#include <dxgi1_6.h>
+#include <DirectXMath.h>
+
+#include "renderdoc_app.h"
+
+#include "BatchedReadback.h"
+#include "BenchmarkReport.h"
+#include "CapabilityCache.h"
+#include "ContextRing.h"
+#include "CopyQueueHandoff.h"
+#include "CpuInteropBackend.h"
+#include "CrossApiTimeline.h"
+#include "DescriptorSlots.h"
+#include "DevicePool.h"
+#include "DirtyRegion.h"
+#include "FenceTimeline.h"
+#include "GpuScopes.h"
+#include "HeapRanges.h"
+#include "InteropBackend.h"
+#include "ParallelRecording.h"
+#include "PathSelection.h"
+#include "ReadbackFrames.h"
+#include "ReadbackPages.h"
+#include "SharedHandles.h"
+#include "SlicePool.h"
+#include "StagingReadback.h"
+#include "SubresourceStateTracker.h"
+#include "TextureArrayDesc.h"
+#include "TransientPacking.h"
+#include "VerifySurface.h"
+
+//#define FORCE_WARP
+
+// #define RUN_VERIFY_BENCHMARK
+// #define RUN_COPY_QUEUE_BENCHMARK
+// #define RUN_PARALLEL_RECORDING_BENCHMARK
+// #define RUN_TEXTURE_ARRAY_BENCHMARK
+// #define RUN_BACKEND_TEST
+
+#define RDOC_CAPTURE_DX11
+// #define RDOC_CAPTURE_DX12
+
+using namespace DirectX;
+
+winrt::com_ptr<ID3D11Device5> CreateD3D11Device() {
+    UINT creationFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+#if defined(_DEBUG)
+    creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    D3D_FEATURE_LEVEL featureLevels[] = {D3D_FEATURE_LEVEL_12_1,
+                                         D3D_FEATURE_LEVEL_12_0,
+                                         D3D_FEATURE_LEVEL_11_1,
+                                         D3D_FEATURE_LEVEL_11_0,
+                                         D3D_FEATURE_LEVEL_10_1,
+                                         D3D_FEATURE_LEVEL_10_0};
+
+    winrt::com_ptr<ID3D11Device> device;
+    winrt::com_ptr<ID3D11DeviceContext> context;
+
+#ifdef FORCE_WARP
+    const D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_WARP;
+#else
+    const D3D_DRIVER_TYPE driverType = D3D_DRIVER_TYPE_HARDWARE;
+#endif
+
+    D3D_FEATURE_LEVEL d3dFeatureLevel;
+    winrt::check_hresult(D3D11CreateDevice(nullptr,
+                                           driverType,
+                                           0,
+                                           creationFlags,
+                                           featureLevels,
+                                           static_cast<UINT>(std::size(featureLevels)),
+                                           D3D11_SDK_VERSION,
+                                           device.put(),
+                                           &d3dFeatureLevel,
+                                           context.put()));
+
+    return device.as<ID3D11Device5>();
+}
+
+winrt::com_ptr<IDXGIFactory4> CreateDXGIFactoryForD3D12() {
+    UINT dxgiFactoryFlags = 0;
+
+#if defined(_DEBUG)
+    winrt::com_ptr<ID3D12Debug> debugCtrl;
+    if (SUCCEEDED(D3D12GetDebugInterface(IID_ID3D12Debug, debugCtrl.put_void()))) {
+        debugCtrl->EnableDebugLayer();
+
+        dxgiFactoryFlags |= DXGI_CREATE_FACTORY_DEBUG;
+    }
+#endif
+
+    winrt::com_ptr<IDXGIFactory4> dxgiFactory;
+    winrt::check_hresult(CreateDXGIFactory2(dxgiFactoryFlags, IID_IDXGIFactory4, dxgiFactory.put_void()));
+    return dxgiFactory;
+}
+
+// Identifies the kind of device a caller wants: which adapter, and the minimum feature level it is created with
+struct D3D12DeviceKey {
+    LUID adapterLuid = {};
+    D3D_FEATURE_LEVEL minFeatureLevel = D3D_FEATURE_LEVEL_11_0;
+
+    bool operator<(const D3D12DeviceKey& rhs) const {
+        return std::tie(adapterLuid.HighPart, adapterLuid.LowPart, minFeatureLevel) <
+               std::tie(rhs.adapterLuid.HighPart, rhs.adapterLuid.LowPart, rhs.minFeatureLevel);
+    }
+};
+
+// The device on the default adapter, and its key, so devices pooled for the same adapter don't enumerate it again
+std::tuple<winrt::com_ptr<ID3D12Device>, D3D12DeviceKey> CreateD3D12Device() {
+    winrt::com_ptr<IDXGIFactory4> dxgiFactory = CreateDXGIFactoryForD3D12();
+
+    winrt::com_ptr<IDXGIAdapter> dxgiAdapter;
+#ifdef FORCE_WARP
+    dxgiFactory->EnumWarpAdapter(winrt::guid_of<IDXGIAdapter>(), dxgiAdapter.put_void());
+#endif
+
+    D3D12DeviceKey key;
+    winrt::com_ptr<ID3D12Device> d3d12Device;
+    winrt::check_hresult(
+        D3D12CreateDevice(dxgiAdapter.get(), key.minFeatureLevel, winrt::guid_of<ID3D12Device>(), d3d12Device.put_void()));
+    key.adapterLuid = d3d12Device->GetAdapterLuid();
+
+    return {d3d12Device, key};
+}
+
+winrt::com_ptr<ID3D12Device> CreateD3D12DeviceOnAdapter(const D3D12DeviceKey& key) {
+    winrt::com_ptr<IDXGIFactory4> dxgiFactory = CreateDXGIFactoryForD3D12();
+
+    winrt::com_ptr<IDXGIAdapter> dxgiAdapter;
+    winrt::check_hresult(dxgiFactory->EnumAdapterByLuid(key.adapterLuid, winrt::guid_of<IDXGIAdapter>(), dxgiAdapter.put_void()));
+
+    winrt::com_ptr<ID3D12Device> d3d12Device;
+    winrt::check_hresult(D3D12CreateDevice(dxgiAdapter.get(), key.minFeatureLevel, winrt::guid_of<ID3D12Device>(), d3d12Device.put_void()));
+
+    return d3d12Device;
+}
+
+// The D3D12 fence of a FenceTimeline: signals from one queue and waits on one reusable event, instead of a new fence
+// and kernel event for every drain
+class D3D12TimelineFence {
+public:
+    D3D12TimelineFence(ID3D12Device* device, ID3D12CommandQueue* cmdQueue) {
+        m_cmdQueue.copy_from(cmdQueue);
+        winrt::check_hresult(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, winrt::guid_of<ID3D12Fence>(), m_fence.put_void()));
+        m_fenceEvent.attach(CreateEvent(nullptr, FALSE, FALSE, nullptr));
+        if (!m_fenceEvent) {
+            winrt::throw_last_error();
+        }
+    }
+
+    ID3D12CommandQueue* Queue() const {
+        return m_cmdQueue.get();
+    }
+
+    ID3D12Fence* Fence() const {
+        return m_fence.get();
+    }
+
+    void Signal(uint64_t value) {
+        winrt::check_hresult(m_cmdQueue->Signal(m_fence.get(), value));
+    }
+
+    uint64_t CompletedValue() const {
+        return m_fence->GetCompletedValue();
+    }
+
+    // The event is auto-reset and may still carry a signal from an earlier timed out wait, so a wakeup doesn't mean
+    // the fence reached the value
+    bool Wait(uint64_t value, uint32_t timeoutMs) {
+        winrt::check_hresult(m_fence->SetEventOnCompletion(value, m_fenceEvent.get()));
+        switch (WaitForSingleObjectEx(m_fenceEvent.get(), timeoutMs, FALSE)) {
+        case WAIT_OBJECT_0:
+            return true;
+
+        case WAIT_TIMEOUT:
+            return false;
+
+        default:
+            winrt::check_hresult(E_FAIL);
+            return false;
+        }
+    }
+
+    uint64_t NowMs() const {
+        return GetTickCount64();
+    }
+
+private:
+    winrt::com_ptr<ID3D12CommandQueue> m_cmdQueue;
+    winrt::com_ptr<ID3D12Fence> m_fence;
+    winrt::handle m_fenceEvent;
+};
+
+// Per-queue timeline on a D3D12 fence
+class D3D12QueueSync : public FenceTimeline<D3D12TimelineFence> {
+public:
+    D3D12QueueSync(ID3D12Device* device, ID3D12CommandQueue* cmdQueue) : FenceTimeline(device, cmdQueue) {
+    }
+
+    ID3D12CommandQueue* Queue() const {
+        return GetFence().Queue();
+    }
+
+    ID3D12Fence* Fence() const {
+        return GetFence().Fence();
+    }
+};
+
+// A ring of command allocators and lists on one queue of the given type, scheduled by a ContextRing. A context is only
+// reset once its last submission retired, so recording the next batch doesn't wait for the GPU to drain the previous
+// one. Begin() hands out the open list until Submit(), so several steps can append to one batch.
+class D3D12CommandContextRing {
+public:
+    using Stats = ContextRing::Stats;
+
+    D3D12CommandContextRing(ID3D12Device* device,
+                            D3D12QueueSync& queueSync,
+                            D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT,
+                            uint32_t numContexts = 3)
+        : m_queueSync(queueSync), m_ring(numContexts), m_contexts(numContexts) {
+        for (auto& context : m_contexts) {
+            winrt::check_hresult(
+                device->CreateCommandAllocator(type, winrt::guid_of<ID3D12CommandAllocator>(), context.cmdAllocator.put_void()));
+            winrt::check_hresult(device->CreateCommandList(0,
+                                                           type,
+                                                           context.cmdAllocator.get(),
+                                                           nullptr,
+                                                           winrt::guid_of<ID3D12GraphicsCommandList>(),
+                                                           context.cmdList.put_void()));
+            context.cmdList->Close();
+        }
+    }
+
+    ~D3D12CommandContextRing() {
+        m_queueSync.WaitFor(m_queueSync.LastSignaled());
+    }
+
+    D3D12CommandContextRing(const D3D12CommandContextRing&) = delete;
+    D3D12CommandContextRing& operator=(const D3D12CommandContextRing&) = delete;
+
+    ID3D12CommandQueue* Queue() const {
+        return m_queueSync.Queue();
+    }
+
+    D3D12QueueSync& Sync() const {
+        return m_queueSync;
+    }
+
+    // Makes this ring's queue wait on the GPU until the other ring's queue reaches the value
+    void Wait(D3D12CommandContextRing& other, uint64_t value) {
+        winrt::check_hresult(m_queueSync.Queue()->Wait(other.Sync().Fence(), value));
+    }
+
+    // Records the tracker's pending barriers into the open list
+    template <typename StateTracker>
+    void FlushBarriers(StateTracker& stateTracker) {
+        stateTracker.Flush(Begin());
+    }
+
+    // The open list, or the next context's list once its last submission retired
+    ID3D12GraphicsCommandList* Begin() {
+        if (m_ring.IsOpen()) {
+            return m_contexts[m_ring.Current()].cmdList.get();
+        }
+
+        Context& next = m_contexts[m_ring.Open(m_queueSync)];
+        winrt::check_hresult(next.cmdAllocator->Reset());
+        winrt::check_hresult(next.cmdList->Reset(next.cmdAllocator.get(), nullptr));
+        return next.cmdList.get();
+    }
+
+    // Submits the open list, if any. Returns the fence value that retires everything submitted so far.
+    uint64_t Submit() {
+        if (!m_ring.IsOpen()) {
+            return m_queueSync.LastSignaled();
+        }
+
+        Context& context = m_contexts[m_ring.Current()];
+        context.cmdList->Close();
+        ID3D12CommandList* cmdLists[] = {context.cmdList.get()};
+        m_queueSync.Queue()->ExecuteCommandLists(static_cast<uint32_t>(std::size(cmdLists)), cmdLists);
+        const uint64_t fenceValue = m_queueSync.Signal();
+        m_ring.Close(fenceValue);
+        return fenceValue;
+    }
+
+    const Stats& GetStats() const {
+        return m_ring.GetStats();
+    }
+
+private:
+    struct Context {
+        winrt::com_ptr<ID3D12CommandAllocator> cmdAllocator;
+        winrt::com_ptr<ID3D12GraphicsCommandList> cmdList;
+    };
+
+    D3D12QueueSync& m_queueSync;
+    ContextRing m_ring;
+    std::vector<Context> m_contexts;
+};
+
+// A device with a direct queue and a ring of command contexts recording for it
+struct D3D12DeviceContext {
+    D3D12DeviceKey key;
+    winrt::com_ptr<ID3D12Device> device;
+    winrt::com_ptr<ID3D12CommandQueue> cmdQueue;
+    std::unique_ptr<D3D12QueueSync> queueSync;
+    std::unique_ptr<D3D12CommandContextRing> commandRing;
+};
+
+// Creates D3D12 devices through a factory and a direct queue with a ring of command contexts per context, for a
+// DevicePool. The factory is the only place devices are created, so a stand-in can replace it.
+class D3D12DeviceBackend {
+public:
+    using Key = D3D12DeviceKey;
+    using Device = winrt::com_ptr<ID3D12Device>;
+    using Context = D3D12DeviceContext;
+    using DeviceFactory = std::function<winrt::com_ptr<ID3D12Device>(const D3D12DeviceKey& key)>;
+
+    explicit D3D12DeviceBackend(DeviceFactory factory) : m_factory(std::move(factory)) {
+    }
+
+    winrt::com_ptr<ID3D12Device> CreateDevice(const D3D12DeviceKey& key) {
+        return m_factory(key);
+    }
+
+    std::unique_ptr<D3D12DeviceContext> CreateContext(const D3D12DeviceKey& key, const winrt::com_ptr<ID3D12Device>& device) {
+        auto context = std::make_unique<D3D12DeviceContext>();
+        context->key = key;
+        context->device = device;
+
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        winrt::check_hresult(
+            device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), context->cmdQueue.put_void()));
+        context->queueSync = std::make_unique<D3D12QueueSync>(device.get(), context->cmdQueue.get());
+        context->commandRing = std::make_unique<D3D12CommandContextRing>(device.get(), *context->queueSync);
+        return context;
+    }
+
+    const D3D12DeviceKey& KeyOf(const D3D12DeviceContext& context) const {
+        return context.key;
+    }
+
+    void Retire(D3D12DeviceContext& context) {
+        context.queueSync->WaitFor(context.queueSync->LastSignaled());
+    }
+
+    double NowMs() const {
+        const std::chrono::duration<double, std::milli> now = std::chrono::high_resolution_clock::now().time_since_epoch();
+        return now.count();
+    }
+
+private:
+    DeviceFactory m_factory;
+};
+
+// Keeps secondary devices and their queue and command contexts alive between uses, keyed by adapter and creation
+// parameters, so opening a secondary device is a lookup instead of a D3D12CreateDevice. Devices stay until evicted.
+class D3D12DevicePool : public DevicePool<D3D12DeviceBackend> {
+public:
+    using DeviceFactory = D3D12DeviceBackend::DeviceFactory;
+
+    explicit D3D12DevicePool(DeviceFactory factory = CreateD3D12DeviceOnAdapter) : DevicePool(std::move(factory)) {
+    }
+};
+
+// Suballocates placed-footprint regions out of large persistently mapped readback buffers, one committed buffer per
+// page of a ReadbackPageAllocator
+class D3D12ReadbackAllocator {
+public:
+    struct Allocation {
+        ID3D12Resource* buffer = nullptr;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint8_t* cpuAddress = nullptr;
+        uint32_t page = 0;
+    };
+
+    using Stats = ReadbackPageAllocator::Stats;
+
+    D3D12ReadbackAllocator(ID3D12Device* device, D3D12QueueSync& queueSync, uint64_t pageSize = 64 * 1024 * 1024)
+        : m_device(device), m_queueSync(queueSync), m_pageAllocator(pageSize) {
+    }
+
+    ~D3D12ReadbackAllocator() {
+        for (uint32_t page = 0; page < m_buffers.size(); ++page) {
+            m_queueSync.WaitFor(m_pageAllocator.RetireFenceValue(page));
+
+            D3D12_RANGE writtenRange{0, 0};
+            m_buffers[page].buffer->Unmap(0, &writtenRange);
+        }
+    }
+
+    D3D12ReadbackAllocator(const D3D12ReadbackAllocator&) = delete;
+    D3D12ReadbackAllocator& operator=(const D3D12ReadbackAllocator&) = delete;
+
+    Allocation Allocate(uint64_t size, uint64_t alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) {
+        const ReadbackPageAllocator::Allocation pageAllocation =
+            m_pageAllocator.Allocate(size, alignment, [this](uint64_t fenceValue) { return m_queueSync.IsComplete(fenceValue); });
+        if (pageAllocation.page == m_buffers.size()) {
+            CreateBuffer(m_pageAllocator.PageSize(pageAllocation.page));
+        }
+
+        const MappedBuffer& buffer = m_buffers[pageAllocation.page];
+        Allocation allocation;
+        allocation.buffer = buffer.buffer.get();
+        allocation.offset = pageAllocation.offset;
+        allocation.size = size;
+        allocation.cpuAddress = buffer.mapped + pageAllocation.offset;
+        allocation.page = pageAllocation.page;
+        return allocation;
+    }
+
+    // The region may be reused once the queue passes fenceValue; its contents stay readable until then
+    void Release(const Allocation& allocation, uint64_t fenceValue) {
+        m_pageAllocator.Release({allocation.page, allocation.offset, allocation.size}, fenceValue);
+    }
+
+    const Stats& GetStats() const {
+        return m_pageAllocator.GetStats();
+    }
+
+private:
+    struct MappedBuffer {
+        winrt::com_ptr<ID3D12Resource> buffer;
+        uint8_t* mapped = nullptr;
+    };
+
+    void CreateBuffer(uint64_t size) {
+        D3D12_HEAP_PROPERTIES heap;
+        heap.Type = D3D12_HEAP_TYPE_READBACK;
+        heap.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heap.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heap.CreationNodeMask = 1;
+        heap.VisibleNodeMask = 1;
+
+        D3D12_RESOURCE_DESC bufferDesc{};
+        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        bufferDesc.Alignment = 0;
+        bufferDesc.Width = size;
+        bufferDesc.Height = 1;
+        bufferDesc.DepthOrArraySize = 1;
+        bufferDesc.MipLevels = 1;
+        bufferDesc.SampleDesc.Count = 1;
+        bufferDesc.SampleDesc.Quality = 0;
+        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        MappedBuffer buffer;
+        winrt::check_hresult(m_device->CreateCommittedResource(&heap,
+                                                               D3D12_HEAP_FLAG_NONE,
+                                                               &bufferDesc,
+                                                               D3D12_RESOURCE_STATE_COPY_DEST,
+                                                               nullptr,
+                                                               IID_ID3D12Resource,
+                                                               buffer.buffer.put_void()));
+
+        // Persistently mapped, the hot path never calls Map/Unmap
+        D3D12_RANGE readRange;
+        readRange.Begin = 0;
+        readRange.End = static_cast<SIZE_T>(size);
+        winrt::check_hresult(buffer.buffer->Map(0, &readRange, reinterpret_cast<void**>(&buffer.mapped)));
+
+        m_buffers.push_back(std::move(buffer));
+    }
+
+    ID3D12Device* m_device;
+    D3D12QueueSync& m_queueSync;
+    ReadbackPageAllocator m_pageAllocator;
+    std::vector<MappedBuffer> m_buffers;
+};
+
+// The D3D12 to D3D11 sharing of a SharedHandleRegistry: an NT handle per resource, opened as a D3D11 texture
+class D3D12ToD3D11Sharing {
+public:
+    using Resource = ID3D12Resource*;
+    using Opened = winrt::com_ptr<ID3D11Texture2D>;
+
+    struct Entry {
+        winrt::com_ptr<ID3D12Resource> d3d12Resource;
+        winrt::handle sharedHandle;
+        Opened opened;
+    };
+
+    D3D12ToD3D11Sharing(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) {
+        m_d3d11Device.copy_from(d3d11Device);
+        m_d3d12Device.copy_from(d3d12Device);
+    }
+
+    Entry Share(ID3D12Resource* d3d12Resource) {
+        Entry entry;
+        entry.d3d12Resource.copy_from(d3d12Resource);
+
+        HANDLE sharedHandle;
+        winrt::check_hresult(m_d3d12Device->CreateSharedHandle(d3d12Resource, nullptr, GENERIC_ALL, nullptr, &sharedHandle));
+        entry.sharedHandle.attach(sharedHandle);
+
+        winrt::check_hresult(
+            m_d3d11Device->OpenSharedResource1(sharedHandle, winrt::guid_of<ID3D11Texture2D>(), entry.opened.put_void()));
+        return entry;
+    }
+
+private:
+    winrt::com_ptr<ID3D11Device5> m_d3d11Device;
+    winrt::com_ptr<ID3D12Device> m_d3d12Device;
+};
+
+// Shares D3D12 resources to the D3D11 device once. The NT handle is created on first use, the opened D3D11 texture is
+// cached, and the handle is closed when the resource is released from the registry.
+class SharedResourceRegistry : public SharedHandleRegistry<D3D12ToD3D11Sharing> {
+public:
+    SharedResourceRegistry(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device)
+        : SharedHandleRegistry(d3d11Device, d3d12Device) {
+    }
+
+    winrt::com_ptr<ID3D11Texture2D> OpenOnD3D11(ID3D12Resource* d3d12Resource) {
+        return Open(d3d12Resource);
+    }
+};
+
+D3D12_RESOURCE_DESC ToD3D12(const TextureArrayDesc& desc) {
+    D3D12_RESOURCE_DESC d3d12TextureDesc{};
+    d3d12TextureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    d3d12TextureDesc.Alignment = 0;
+    d3d12TextureDesc.Width = desc.width;
+    d3d12TextureDesc.Height = desc.height;
+    d3d12TextureDesc.DepthOrArraySize = static_cast<UINT16>(desc.arraySize);
+    d3d12TextureDesc.MipLevels = static_cast<UINT16>(desc.mipLevels);
+    d3d12TextureDesc.Format = desc.format;
+    d3d12TextureDesc.SampleDesc.Count = desc.sampleCount;
+    d3d12TextureDesc.SampleDesc.Quality = 0;
+    d3d12TextureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    d3d12TextureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    if (!desc.Multisampled()) {
+        // Simultaneous access is not allowed on MSAA resources
+        d3d12TextureDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS;
+    }
+    return d3d12TextureDesc;
+}
+
+std::tuple<winrt::com_ptr<ID3D11Texture2D>, winrt::com_ptr<ID3D12Resource>, winrt::com_ptr<ID3D11Texture2D>>
+CreateTextureArray(ID3D11Device5* d3d11Device,
+                   ID3D12Device* d3d12Device,
+                   SharedResourceRegistry& sharedResourceRegistry,
+                   const TextureArrayDesc& desc) {
+    D3D12_RESOURCE_DESC d3d12TextureDesc = ToD3D12(desc);
+
+    D3D12_HEAP_PROPERTIES heapProperties;
+    heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+    heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+    heapProperties.CreationNodeMask = 0;
+    heapProperties.VisibleNodeMask = 0;
+
+    D3D12_CLEAR_VALUE clearValue{};
+    clearValue.Format = d3d12TextureDesc.Format;
+
+    winrt::com_ptr<ID3D12Resource> d3d12Texture;
+    winrt::check_hresult(d3d12Device->CreateCommittedResource(&heapProperties,
+                                                              D3D12_HEAP_FLAG_SHARED,
+                                                              &d3d12TextureDesc,
+                                                              D3D12_RESOURCE_STATE_RENDER_TARGET,
+                                                              &clearValue,
+                                                              winrt::guid_of<ID3D12Resource>(),
+                                                              d3d12Texture.put_void()));
+
+    winrt::com_ptr<ID3D11Texture2D> sharedD3d11Texture = sharedResourceRegistry.OpenOnD3D11(d3d12Texture.get());
+
+    // Create another from dx11
+    winrt::com_ptr<ID3D11Texture2D> d3d11Texture;
+    D3D11_TEXTURE2D_DESC dx11TexDesc;
+    sharedD3d11Texture->GetDesc(&dx11TexDesc);
+    winrt::check_hresult(d3d11Device->CreateTexture2D(&dx11TexDesc, nullptr, d3d11Texture.put()));
+
+    return {sharedD3d11Texture, d3d12Texture, d3d11Texture};
+}
+
+// Hands out CPU-only RTV descriptors from a few large heaps, one per heap of a DescriptorSlotAllocator
+class D3D12DescriptorAllocator {
+public:
+    using Stats = DescriptorSlotAllocator::Stats;
+
+    D3D12DescriptorAllocator(ID3D12Device* d3d12Device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t descriptorsPerHeap = 1024)
+        : m_type(type), m_slots(descriptorsPerHeap) {
+        m_d3d12Device.copy_from(d3d12Device);
+        m_descriptorSize = d3d12Device->GetDescriptorHandleIncrementSize(type);
+    }
+
+    D3D12DescriptorAllocator(const D3D12DescriptorAllocator&) = delete;
+    D3D12DescriptorAllocator& operator=(const D3D12DescriptorAllocator&) = delete;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE Allocate() {
+        const DescriptorSlotAllocator::Slot slot = m_slots.Allocate();
+        if (slot.heap == m_heaps.size()) {
+            D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+            heapDesc.NumDescriptors = m_slots.DescriptorsPerHeap();
+            heapDesc.Type = m_type;
+            heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+            winrt::com_ptr<ID3D12DescriptorHeap> heap;
+            winrt::check_hresult(m_d3d12Device->CreateDescriptorHeap(&heapDesc, winrt::guid_of<ID3D12DescriptorHeap>(), heap.put_void()));
+            m_heapStarts.push_back(heap->GetCPUDescriptorHandleForHeapStart());
+            m_heaps.push_back(std::move(heap));
+        }
+
+        D3D12_CPU_DESCRIPTOR_HANDLE handle;
+        handle.ptr = m_heapStarts[slot.heap].ptr + static_cast<SIZE_T>(slot.index) * m_descriptorSize;
+        return handle;
+    }
+
+    void Free(D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+        const SIZE_T heapBytes = static_cast<SIZE_T>(m_slots.DescriptorsPerHeap()) * m_descriptorSize;
+        for (uint32_t heap = 0; heap < m_heapStarts.size(); ++heap) {
+            if ((handle.ptr >= m_heapStarts[heap].ptr) && (handle.ptr < m_heapStarts[heap].ptr + heapBytes)) {
+                m_slots.Free({heap, static_cast<uint32_t>((handle.ptr - m_heapStarts[heap].ptr) / m_descriptorSize)});
+                return;
+            }
+        }
+        throw std::invalid_argument("Descriptor doesn't belong to the allocator");
+    }
+
+    Stats GetStats() const {
+        return m_slots.GetStats();
+    }
+
+private:
+    winrt::com_ptr<ID3D12Device> m_d3d12Device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    uint32_t m_descriptorSize;
+
+    DescriptorSlotAllocator m_slots;
+    std::vector<winrt::com_ptr<ID3D12DescriptorHeap>> m_heaps;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_heapStarts;
+};
+
+// Single-slice render target views on both APIs, created on first use and kept until the resource is released.
+// Views are keyed by (resource, mip, first slice, format).
+class RenderTargetViewCache {
+public:
+    struct Stats {
+        uint64_t numLookups = 0;
+        uint64_t numCreated = 0;
+    };
+
+    explicit RenderTargetViewCache(ID3D12Device* d3d12Device)
+        : m_descriptorAllocator(d3d12Device, D3D12_DESCRIPTOR_HEAP_TYPE_RTV) {
+        m_d3d12Device.copy_from(d3d12Device);
+    }
+
+    ~RenderTargetViewCache() {
+        Clear();
+    }
+
+    RenderTargetViewCache(const RenderTargetViewCache&) = delete;
+    RenderTargetViewCache& operator=(const RenderTargetViewCache&) = delete;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetD3D12(ID3D12Resource* resource, uint32_t mip, uint32_t slice, DXGI_FORMAT format) {
+        ++m_stats.numLookups;
+
+        auto iter = m_d3d12Views.find({resource, mip, slice, format});
+        if (iter != m_d3d12Views.end()) {
+            return iter->second.handle;
+        }
+
+        const D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
+        D3D12_RENDER_TARGET_VIEW_DESC rtvDesc;
+        rtvDesc.Format = format;
+        if (resourceDesc.SampleDesc.Count > 1) {
+            rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DMSARRAY;
+            rtvDesc.Texture2DMSArray.FirstArraySlice = slice;
+            rtvDesc.Texture2DMSArray.ArraySize = 1;
+        } else {
+            rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2DARRAY;
+            rtvDesc.Texture2DArray.MipSlice = mip;
+            rtvDesc.Texture2DArray.FirstArraySlice = slice;
+            rtvDesc.Texture2DArray.ArraySize = 1;
+            rtvDesc.Texture2DArray.PlaneSlice = 0;
+        }
+
+        D3D12View view;
+        view.resource.copy_from(resource);
+        view.handle = m_descriptorAllocator.Allocate();
+        m_d3d12Device->CreateRenderTargetView(resource, &rtvDesc, view.handle);
+        ++m_stats.numCreated;
+
+        return m_d3d12Views.emplace(D3D12Key{resource, mip, slice, format}, std::move(view)).first->second.handle;
+    }
+
+    ID3D11RenderTargetView* GetD3D11(ID3D11Texture2D* texture, uint32_t mip, uint32_t slice, DXGI_FORMAT format) {
+        ++m_stats.numLookups;
+
+        auto iter = m_d3d11Views.find({texture, mip, slice, format});
+        if (iter != m_d3d11Views.end()) {
+            return iter->second.view.get();
+        }
+
+        D3D11_TEXTURE2D_DESC textureDesc;
+        texture->GetDesc(&textureDesc);
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc;
+        rtvDesc.Format = format;
+        if (textureDesc.SampleDesc.Count > 1) {
+            rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DMSARRAY;
+            rtvDesc.Texture2DMSArray.FirstArraySlice = slice;
+            rtvDesc.Texture2DMSArray.ArraySize = 1;
+        } else {
+            rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2DARRAY;
+            rtvDesc.Texture2DArray.MipSlice = mip;
+            rtvDesc.Texture2DArray.FirstArraySlice = slice;
+            rtvDesc.Texture2DArray.ArraySize = 1;
+        }
+
+        winrt::com_ptr<ID3D11Device> d3d11Device;
+        texture->GetDevice(d3d11Device.put());
+
+        D3D11View view;
+        view.texture.copy_from(texture);
+        winrt::check_hresult(d3d11Device->CreateRenderTargetView(texture, &rtvDesc, view.view.put()));
+        ++m_stats.numCreated;
+
+        return m_d3d11Views.emplace(D3D11Key{texture, mip, slice, format}, std::move(view)).first->second.view.get();
+    }
+
+    // Drops every view of the resource and returns its descriptors to the allocator
+    void Release(ID3D12Resource* resource) {
+        for (auto iter = m_d3d12Views.begin(); iter != m_d3d12Views.end();) {
+            if (std::get<0>(iter->first) == resource) {
+                m_descriptorAllocator.Free(iter->second.handle);
+                iter = m_d3d12Views.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    void Release(ID3D11Texture2D* texture) {
+        for (auto iter = m_d3d11Views.begin(); iter != m_d3d11Views.end();) {
+            if (std::get<0>(iter->first) == texture) {
+                iter = m_d3d11Views.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    void Clear() {
+        for (auto& [key, view] : m_d3d12Views) {
+            m_descriptorAllocator.Free(view.handle);
+        }
+        m_d3d12Views.clear();
+        m_d3d11Views.clear();
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+    D3D12DescriptorAllocator::Stats GetDescriptorStats() const {
+        return m_descriptorAllocator.GetStats();
+    }
+
+private:
+    using D3D12Key = std::tuple<ID3D12Resource*, uint32_t, uint32_t, DXGI_FORMAT>;
+    using D3D11Key = std::tuple<ID3D11Texture2D*, uint32_t, uint32_t, DXGI_FORMAT>;
+
+    struct D3D12View {
+        // Keeps the key's pointer from being recycled for another resource while the view is cached
+        winrt::com_ptr<ID3D12Resource> resource;
+        D3D12_CPU_DESCRIPTOR_HANDLE handle;
+    };
+
+    struct D3D11View {
+        winrt::com_ptr<ID3D11Texture2D> texture;
+        winrt::com_ptr<ID3D11RenderTargetView> view;
+    };
+
+    winrt::com_ptr<ID3D12Device> m_d3d12Device;
+    D3D12DescriptorAllocator m_descriptorAllocator;
+    std::map<D3D12Key, D3D12View> m_d3d12Views;
+    std::map<D3D11Key, D3D11View> m_d3d11Views;
+    Stats m_stats;
+};
+
+void PrintGpuScopes(const char* api, const std::map<std::string, GpuScopeStats>& scopes) {
+    for (const auto& [name, stats] : scopes) {
+        std::cout << api << " " << name << ": " << stats.count << " runs, avg " << stats.totalGpuMs / stats.count << " ms, max "
+                  << stats.maxGpuMs << " ms GPU";
+        if (stats.totalSubmitLatencyMs != 0) {
+            std::cout << ", avg " << stats.totalSubmitLatencyMs / stats.count << " ms from recording to GPU start";
+        }
+        std::cout << "\n";
+    }
+}
+
+// The clocks of a GpuScopeLog on a D3D12 queue: QueryPerformanceCounter on the CPU and the queue's timestamps
+class D3D12QueueClock {
+public:
+    explicit D3D12QueueClock(ID3D12CommandQueue* cmdQueue) {
+        m_cmdQueue.copy_from(cmdQueue);
+
+        winrt::check_hresult(cmdQueue->GetTimestampFrequency(&m_gpuFrequency));
+        LARGE_INTEGER cpuFrequency;
+        QueryPerformanceFrequency(&cpuFrequency);
+        m_cpuFrequency = cpuFrequency.QuadPart;
+    }
+
+    uint64_t CpuTicks() const {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return static_cast<uint64_t>(now.QuadPart);
+    }
+
+    uint64_t CpuFrequency() const {
+        return m_cpuFrequency;
+    }
+
+    uint64_t GpuFrequency() const {
+        return m_gpuFrequency;
+    }
+
+    void Calibrate(uint64_t& gpuTicks, uint64_t& cpuTicks) {
+        winrt::check_hresult(m_cmdQueue->GetClockCalibration(&gpuTicks, &cpuTicks));
+    }
+
+private:
+    winrt::com_ptr<ID3D12CommandQueue> m_cmdQueue;
+    uint64_t m_gpuFrequency = 0;
+    uint64_t m_cpuFrequency = 0;
+};
+
+// Named GPU scopes on a direct queue, timed with timestamp query heaps. Each scope resolves its pair of timestamps
+// into a persistently mapped readback buffer when it ends, so Collect() only has to wait for the queue. Query heaps come
+// in blocks of `scopesPerBlock` scopes; a frame that opens more scopes than the existing blocks hold gets another block,
+// which later frames reuse.
+class D3D12GpuTimer {
+public:
+    static constexpr uint32_t InvalidScope = ~0U;
+
+    D3D12GpuTimer(ID3D12Device* device, D3D12QueueSync& queueSync, uint32_t scopesPerBlock = 256)
+        : m_queueSync(queueSync), m_scopesPerBlock(scopesPerBlock), m_log(queueSync.Queue()) {
+        m_device.copy_from(device);
+    }
+
+    ~D3D12GpuTimer() {
+        m_queueSync.WaitFor(m_queueSync.LastSignaled());
+        for (QueryBlock& block : m_blocks) {
+            block.readbackBuffer->Unmap(0, nullptr);
+        }
+    }
+
+    D3D12GpuTimer(const D3D12GpuTimer&) = delete;
+    D3D12GpuTimer& operator=(const D3D12GpuTimer&) = delete;
+
+    // Not safe while End() is being recorded on another thread, a new block may be added
+    uint32_t Begin(ID3D12GraphicsCommandList* cmdList, const char* name) {
+        if (m_log.NumOpen() == m_blocks.size() * m_scopesPerBlock) {
+            AddBlock();
+        }
+        const uint32_t scope = m_log.Open(name);
+
+        const QueryBlock& block = m_blocks[scope / m_scopesPerBlock];
+        cmdList->EndQuery(block.queryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, (scope % m_scopesPerBlock) * 2);
+        return scope;
+    }
+
+    // May be recorded into a different list than Begin(), as long as that list executes later on the same queue. Safe
+    // to call from the thread recording that list.
+    void End(ID3D12GraphicsCommandList* cmdList, uint32_t scope) const {
+        if (scope == InvalidScope) {
+            return;
+        }
+
+        const QueryBlock& block = m_blocks[scope / m_scopesPerBlock];
+        const uint32_t index = (scope % m_scopesPerBlock) * 2;
+        cmdList->EndQuery(block.queryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, index + 1);
+        cmdList->ResolveQueryData(
+            block.queryHeap.get(), D3D12_QUERY_TYPE_TIMESTAMP, index, 2, block.readbackBuffer.get(), index * sizeof(uint64_t));
+    }
+
+    // Every scope has to be in a submitted command list
+    void Collect() {
+        m_queueSync.WaitFor(m_queueSync.LastSignaled());
+        m_log.Collect([this](uint32_t scope) { return m_blocks[scope / m_scopesPerBlock].timestamps + (scope % m_scopesPerBlock) * 2; });
+    }
+
+    const std::map<std::string, GpuScopeStats>& GetStats() const {
+        return m_log.GetStats();
+    }
+
+private:
+    struct QueryBlock {
+        winrt::com_ptr<ID3D12QueryHeap> queryHeap;
+        winrt::com_ptr<ID3D12Resource> readbackBuffer;
+        const uint64_t* timestamps = nullptr;
+    };
+
+    void AddBlock() {
+        QueryBlock block;
+
+        D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+        queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        queryHeapDesc.Count = m_scopesPerBlock * 2;
+        winrt::check_hresult(m_device->CreateQueryHeap(&queryHeapDesc, winrt::guid_of<ID3D12QueryHeap>(), block.queryHeap.put_void()));
+
+        D3D12_HEAP_PROPERTIES heapProp = {D3D12_HEAP_TYPE_READBACK, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1, 1};
+        D3D12_RESOURCE_DESC bufferDesc = {};
+        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        bufferDesc.Width = queryHeapDesc.Count * sizeof(uint64_t);
+        bufferDesc.Height = 1;
+        bufferDesc.DepthOrArraySize = 1;
+        bufferDesc.MipLevels = 1;
+        bufferDesc.SampleDesc.Count = 1;
+        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        winrt::check_hresult(m_device->CreateCommittedResource(&heapProp,
+                                                               D3D12_HEAP_FLAG_NONE,
+                                                               &bufferDesc,
+                                                               D3D12_RESOURCE_STATE_COPY_DEST,
+                                                               nullptr,
+                                                               winrt::guid_of<ID3D12Resource>(),
+                                                               block.readbackBuffer.put_void()));
+        void* timestamps;
+        winrt::check_hresult(block.readbackBuffer->Map(0, nullptr, &timestamps));
+        block.timestamps = static_cast<const uint64_t*>(timestamps);
+
+        m_blocks.push_back(std::move(block));
+    }
+
+    D3D12QueueSync& m_queueSync;
+    winrt::com_ptr<ID3D12Device> m_device;
+    uint32_t m_scopesPerBlock;
+    std::vector<QueryBlock> m_blocks;
+    GpuScopeLog<D3D12QueueClock> m_log;
+};
+
+// Named GPU scopes on the D3D11 immediate context. Scopes live inside a BeginFrame()/EndFrame() pair bracketed by a
+// TIMESTAMP_DISJOINT query, which supplies the tick frequency and flags frames whose timestamps can't be trusted.
+class D3D11GpuTimer {
+public:
+    explicit D3D11GpuTimer(ID3D11Device* device) {
+        m_device.copy_from(device);
+        device->GetImmediateContext(m_context.put());
+
+        D3D11_QUERY_DESC queryDesc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+        winrt::check_hresult(device->CreateQuery(&queryDesc, m_disjointQuery.put()));
+    }
+
+    D3D11GpuTimer(const D3D11GpuTimer&) = delete;
+    D3D11GpuTimer& operator=(const D3D11GpuTimer&) = delete;
+
+    void BeginFrame() {
+        m_context->Begin(m_disjointQuery.get());
+    }
+
+    uint32_t Begin(const char* name) {
+        const uint32_t scope = static_cast<uint32_t>(m_scopes.size());
+        if (scope == m_queries.size()) {
+            // Queries are reused across frames, so they are only created the first time this many scopes are open
+            D3D11_QUERY_DESC queryDesc = {D3D11_QUERY_TIMESTAMP, 0};
+            std::array<winrt::com_ptr<ID3D11Query>, 2> queries;
+            winrt::check_hresult(m_device->CreateQuery(&queryDesc, queries[0].put()));
+            winrt::check_hresult(m_device->CreateQuery(&queryDesc, queries[1].put()));
+            m_queries.push_back(std::move(queries));
+        }
+        m_scopes.push_back(name);
+
+        m_context->End(m_queries[scope][0].get());
+        return scope;
+    }
+
+    void End(uint32_t scope) {
+        m_context->End(m_queries[scope][1].get());
+    }
+
+    void EndFrame() {
+        m_context->End(m_disjointQuery.get());
+    }
+
+    // Blocks until the frame's queries are available. Disjoint frames are dropped.
+    void Collect() {
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+        GetData(m_disjointQuery.get(), &disjoint, sizeof(disjoint));
+
+        if (!disjoint.Disjoint) {
+            for (uint32_t scope = 0; scope < m_scopes.size(); ++scope) {
+                uint64_t begin;
+                uint64_t end;
+                GetData(m_queries[scope][0].get(), &begin, sizeof(begin));
+                GetData(m_queries[scope][1].get(), &end, sizeof(end));
+                m_stats[m_scopes[scope]].Add((end - begin) * 1000.0 / disjoint.Frequency, 0);
+            }
+        }
+        m_scopes.clear();
+    }
+
+    const std::map<std::string, GpuScopeStats>& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    void GetData(ID3D11Query* query, void* data, uint32_t size) {
+        for (;;) {
+            const HRESULT hr = m_context->GetData(query, data, size, 0);
+            if (hr != S_FALSE) {
+                winrt::check_hresult(hr);
+                return;
+            }
+            SwitchToThread();
+        }
+    }
+
+    winrt::com_ptr<ID3D11Device> m_device;
+    winrt::com_ptr<ID3D11DeviceContext> m_context;
+    winrt::com_ptr<ID3D11Query> m_disjointQuery;
+    std::vector<std::array<winrt::com_ptr<ID3D11Query>, 2>> m_queries;
+
+    std::vector<const char*> m_scopes;
+    std::map<std::string, GpuScopeStats> m_stats;
+};
+
+// Optional instrumentation threaded through the fill and copy paths
+struct GpuTimers {
+    D3D12GpuTimer* d3d12 = nullptr;
+    D3D11GpuTimer* d3d11 = nullptr;
+};
+
+// Records ranges of work items (slices, subresources) into one command list per worker thread. Each worker owns its
+// list and two allocators; the lists are submitted together in one ExecuteCommandLists call in range order, so the GPU
+// sees the same command stream as a serial recording regardless of which worker finishes first. The ring's open list is
+// submitted first, so the worker lists land behind everything already recorded for the queue. Submissions alternate
+// between the allocator sets, so recording only waits for the submission before the previous one.
+class D3D12ParallelRecorder {
+public:
+    using RecordFunc = std::function<void(ID3D12GraphicsCommandList* cmdList, uint32_t begin, uint32_t end)>;
+
+    D3D12ParallelRecorder(ID3D12Device* device, D3D12CommandContextRing& commandRing, uint32_t numThreads)
+        : m_commandRing(commandRing), m_runner(numThreads), m_workers(m_runner.NumThreads()) {
+        for (auto& worker : m_workers) {
+            for (auto& cmdAllocator : worker.cmdAllocators) {
+                winrt::check_hresult(device->CreateCommandAllocator(
+                    D3D12_COMMAND_LIST_TYPE_DIRECT, winrt::guid_of<ID3D12CommandAllocator>(), cmdAllocator.put_void()));
+            }
+            winrt::check_hresult(device->CreateCommandList(0,
+                                                           D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                           worker.cmdAllocators[0].get(),
+                                                           nullptr,
+                                                           winrt::guid_of<ID3D12GraphicsCommandList>(),
+                                                           worker.cmdList.put_void()));
+            worker.cmdList->Close();
+        }
+    }
+
+    ~D3D12ParallelRecorder() {
+        m_commandRing.Sync().WaitFor(*std::max_element(m_setFenceValues.begin(), m_setFenceValues.end()));
+    }
+
+    D3D12ParallelRecorder(const D3D12ParallelRecorder&) = delete;
+    D3D12ParallelRecorder& operator=(const D3D12ParallelRecorder&) = delete;
+
+    uint32_t NumThreads() const {
+        return m_runner.NumThreads();
+    }
+
+    // Splits [0, numItems) into one contiguous range per worker and records them concurrently. Returns the fence value
+    // of the submission.
+    uint64_t RecordAndSubmit(uint32_t numItems, const RecordFunc& record) {
+        // Worker allocators are reset by the workers themselves, so the last submission from this set has to retire
+        const uint32_t set = m_nextSet;
+        m_commandRing.Sync().WaitFor(m_setFenceValues[set]);
+
+        const uint32_t numRanges = m_runner.Run(numItems, [&](uint32_t index, uint32_t begin, uint32_t end) {
+            Worker& worker = m_workers[index];
+            try {
+                winrt::check_hresult(worker.cmdAllocators[set]->Reset());
+                winrt::check_hresult(worker.cmdList->Reset(worker.cmdAllocators[set].get(), nullptr));
+                record(worker.cmdList.get(), begin, end);
+                winrt::check_hresult(worker.cmdList->Close());
+            } catch (...) {
+                // Keep the list resettable for the next submission
+                worker.cmdList->Close();
+                throw;
+            }
+        });
+
+        std::vector<ID3D12CommandList*> cmdLists;
+        for (uint32_t i = 0; i < numRanges; ++i) {
+            cmdLists.push_back(m_workers[i].cmdList.get());
+        }
+        m_commandRing.Submit();
+        m_commandRing.Queue()->ExecuteCommandLists(static_cast<uint32_t>(cmdLists.size()), cmdLists.data());
+
+        m_setFenceValues[set] = m_commandRing.Sync().Signal();
+        m_nextSet = (set + 1) % NumAllocatorSets;
+        return m_setFenceValues[set];
+    }
+
+private:
+    static constexpr uint32_t NumAllocatorSets = 2;
+
+    struct Worker {
+        std::array<winrt::com_ptr<ID3D12CommandAllocator>, NumAllocatorSets> cmdAllocators;
+        winrt::com_ptr<ID3D12GraphicsCommandList> cmdList;
+    };
+
+    D3D12CommandContextRing& m_commandRing;
+    ParallelRangeRunner m_runner;
+    std::vector<Worker> m_workers;
+    std::array<uint64_t, NumAllocatorSets> m_setFenceValues = {};
+    uint32_t m_nextSet = 0;
+};
+
+// Clears every mip of `slices` to their colors and marks only those dirty. With a parallel recorder the clears are
+// recorded across its workers and submitted right away, behind whatever was already recorded into the ring's open list;
+// otherwise they are recorded into that list for the caller to submit.
+void FillTextureArray(RenderTargetViewCache& rtvCache,
+                      D3D12ParallelRecorder* parallelRecorder,
+                      D3D12CommandContextRing& commandRing,
+                      ID3D12Resource* d3d12Texture,
+                      ID3D11Texture2D* d3d11Texture,
+                      const TextureArrayDesc& desc,
+                      const XMFLOAT4 sliceColors[],
+                      const std::vector<uint32_t>& slices,
+                      DirtyRegionTracker* dirtyRegions = nullptr,
+                      const GpuTimers* gpuTimers = nullptr) {
+    std::vector<uint32_t> subresources;
+    for (uint32_t slice : slices) {
+        for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+            subresources.push_back(desc.Subresource(mip, slice));
+        }
+    }
+    const uint32_t numSubres = static_cast<uint32_t>(subresources.size());
+
+    // The view cache isn't thread safe, so views are looked up before recording
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvHandles(numSubres);
+    for (uint32_t i = 0; i < numSubres; ++i) {
+        rtvHandles[i] = rtvCache.GetD3D12(d3d12Texture, desc.MipOf(subresources[i]), desc.SliceOf(subresources[i]), desc.format);
+    }
+
+    ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+    // Without clears no range would end a scope begun here
+    D3D12GpuTimer* d3d12Timer = (gpuTimers && (numSubres > 0)) ? gpuTimers->d3d12 : nullptr;
+    const uint32_t clearScope = d3d12Timer ? d3d12Timer->Begin(d3d12CmdList, "ClearRenderTargetView") : D3D12GpuTimer::InvalidScope;
+
+    const auto recordClears = [&](ID3D12GraphicsCommandList* cmdList, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            cmdList->ClearRenderTargetView(rtvHandles[i], &sliceColors[desc.SliceOf(subresources[i])].x, 0, nullptr);
+        }
+        // The range that finishes the list closes the scope, which makes it the last list of the submission
+        if ((d3d12Timer != nullptr) && (end == numSubres)) {
+            d3d12Timer->End(cmdList, clearScope);
+        }
+    };
+    if (dirtyRegions != nullptr) {
+        for (uint32_t subres : subresources) {
+            dirtyRegions->MarkSubresourceDirty(subres);
+        }
+    }
+
+    if (parallelRecorder != nullptr) {
+        parallelRecorder->RecordAndSubmit(numSubres, recordClears);
+    } else {
+        recordClears(d3d12CmdList, 0, numSubres);
+    }
+
+    // Fill the same data to d3d11 natively created texture
+    winrt::com_ptr<ID3D11Device> d3d11Device;
+    d3d11Texture->GetDevice(d3d11Device.put());
+    winrt::com_ptr<ID3D11DeviceContext> d3d11Context;
+    d3d11Device->GetImmediateContext(d3d11Context.put());
+    D3D11GpuTimer* d3d11Timer = gpuTimers ? gpuTimers->d3d11 : nullptr;
+    const uint32_t d3d11ClearScope = d3d11Timer ? d3d11Timer->Begin("ClearRenderTargetView") : 0;
+    for (uint32_t subres : subresources) {
+        ID3D11RenderTargetView* rtvD3d11 = rtvCache.GetD3D11(d3d11Texture, desc.MipOf(subres), desc.SliceOf(subres), desc.format);
+        d3d11Context->ClearRenderTargetView(rtvD3d11, &sliceColors[desc.SliceOf(subres)].x);
+    }
+    if (d3d11Timer != nullptr) {
+        d3d11Timer->End(d3d11ClearScope);
+    }
+}
+
+// The one owner of the states of registered resources: every path that touches a registered texture transitions it here
+// instead of writing its own barriers. Flush() emits the pending changes of SubresourceStateTracker as one
+// ResourceBarrier call.
+class D3D12StateTracker {
+public:
+    using Tracker = SubresourceStateTracker<ID3D12Resource*, D3D12_RESOURCE_STATES>;
+    using Stats = Tracker::Stats;
+
+    static constexpr uint32_t AllSubresources = Tracker::AllSubresources;
+    static_assert(AllSubresources == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+    void Register(ID3D12Resource* resource, uint32_t numSubresources, D3D12_RESOURCE_STATES state) {
+        m_tracker.Register(resource, numSubresources, state);
+    }
+
+    void Unregister(ID3D12Resource* resource) {
+        m_tracker.Unregister(resource);
+    }
+
+    // `subres` may be D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+    void Transition(ID3D12Resource* resource, uint32_t subres, D3D12_RESOURCE_STATES state) {
+        m_tracker.Transition(resource, subres, state);
+    }
+
+    // For state changes the GPU makes on its own, like promotion and decay of COMMON resources on a copy queue
+    void Assume(ID3D12Resource* resource, uint32_t subres, D3D12_RESOURCE_STATES state) {
+        m_tracker.Assume(resource, subres, state);
+    }
+
+    D3D12_RESOURCE_STATES StateOf(ID3D12Resource* resource, uint32_t subres) {
+        return m_tracker.StateOf(resource, subres);
+    }
+
+    void Flush(ID3D12GraphicsCommandList* cmdList) {
+        m_barriers.clear();
+        for (const Tracker::Change& change : m_tracker.Collect()) {
+            D3D12_RESOURCE_BARRIER barrier;
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            barrier.Transition.pResource = change.resource;
+            barrier.Transition.Subresource = change.subres;
+            barrier.Transition.StateBefore = change.before;
+            barrier.Transition.StateAfter = change.after;
+            m_barriers.push_back(barrier);
+        }
+
+        if (!m_barriers.empty()) {
+            cmdList->ResourceBarrier(static_cast<uint32_t>(m_barriers.size()), m_barriers.data());
+        }
+    }
+
+    const Stats& GetStats() const {
+        return m_tracker.GetStats();
+    }
+
+private:
+    Tracker m_tracker;
+    std::vector<D3D12_RESOURCE_BARRIER> m_barriers;
+};
+
+// One copy per subresource into its own readback region. The barriers of all subresources are flushed together before
+// and after the copies, and everything goes out in one submit.
+std::vector<VerifyResult> TryDirectlyCopyFromD3D12ToD3D12(ID3D12Device* d3d12Device,
+                                                          D3D12CommandContextRing& commandRing,
+                                                          D3D12ReadbackAllocator& readbackAllocator,
+                                                          D3D12StateTracker& stateTracker,
+                                                          ID3D12Resource* d3d12Texture,
+                                                          const TextureArrayDesc& desc,
+                                                          const uint32_t expectedRgbas[]) {
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<VerifyResult> ret(numSubres);
+    ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        stateTracker.Transition(d3d12Texture, subres, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    }
+    stateTracker.Flush(d3d12CmdList);
+
+    D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    std::vector<D3D12ReadbackAllocator::Allocation> readbacks(numSubres);
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = layouts[subres];
+        uint32_t numRows = 0;
+        uint64_t rowSizeInBytes = 0;
+        uint64_t requiredSize = 0;
+        d3d12Device->GetCopyableFootprints(&colorDesc, subres, 1, 0, &layout, &numRows, &rowSizeInBytes, &requiredSize);
+
+        readbacks[subres] = readbackAllocator.Allocate(requiredSize);
+        layout.Offset += readbacks[subres].offset;
+
+        D3D12_BOX srcBox;
+        srcBox.left = 0;
+        srcBox.top = 0;
+        srcBox.front = 0;
+        srcBox.right = layout.Footprint.Width;
+        srcBox.bottom = layout.Footprint.Height;
+        srcBox.back = 1;
+
+        D3D12_TEXTURE_COPY_LOCATION src;
+        src.pResource = d3d12Texture;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = subres;
+
+        D3D12_TEXTURE_COPY_LOCATION dst;
+        dst.pResource = readbacks[subres].buffer;
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dst.PlacedFootprint = layout;
+
+        d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, &srcBox);
+    }
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    stateTracker.Flush(d3d12CmdList);
+
+    const uint64_t fenceValue = commandRing.Submit();
+    commandRing.Sync().WaitFor(fenceValue);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        ret[subres] = VerifySurface(readbacks[subres].cpuAddress,
+                                    layouts[subres].Footprint.RowPitch,
+                                    layouts[subres].Footprint.Width,
+                                    layouts[subres].Footprint.Height,
+                                    expectedRgbas[desc.SliceOf(subres)]);
+
+        readbackAllocator.Release(readbacks[subres], fenceValue);
+    }
+
+    return ret;
+}
+
+std::vector<VerifyResult> TryBatchedCopyFromD3D12ToD3D12(ID3D12Device* d3d12Device,
+                                                         D3D12CommandContextRing& commandRing,
+                                                         D3D12ReadbackAllocator& readbackAllocator,
+                                                         D3D12StateTracker& stateTracker,
+                                                         ID3D12Resource* d3d12Texture,
+                                                         const TextureArrayDesc& desc,
+                                                         const uint32_t expectedRgbas[],
+                                                         D3D12GpuTimer* gpuTimer = nullptr) {
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<VerifyResult> ret(numSubres);
+
+    // One footprint query and one readback region for the whole subresource range
+    D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    uint64_t requiredSize = 0;
+    d3d12Device->GetCopyableFootprints(&colorDesc, 0, numSubres, 0, layouts.data(), nullptr, nullptr, &requiredSize);
+
+    const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+    for (auto& layout : layouts) {
+        layout.Offset += readback.offset;
+    }
+
+    const auto recordCopies = [&](ID3D12GraphicsCommandList* d3d12CmdList) {
+        // The texture goes back to the state it had: RENDER_TARGET for the test's array, COMMON for a shared heap view
+        const D3D12_RESOURCE_STATES restingState = stateTracker.StateOf(d3d12Texture, 0);
+        stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        stateTracker.Flush(d3d12CmdList);
+
+        const uint32_t copyScope =
+            gpuTimer ? gpuTimer->Begin(d3d12CmdList, "CopyTextureRegion to readback") : D3D12GpuTimer::InvalidScope;
+        for (uint32_t subres = 0; subres < numSubres; ++subres) {
+            D3D12_BOX srcBox;
+            srcBox.left = 0;
+            srcBox.top = 0;
+            srcBox.front = 0;
+            srcBox.right = layouts[subres].Footprint.Width;
+            srcBox.bottom = layouts[subres].Footprint.Height;
+            srcBox.back = 1;
+
+            D3D12_TEXTURE_COPY_LOCATION src;
+            src.pResource = d3d12Texture;
+            src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            src.SubresourceIndex = subres;
+
+            D3D12_TEXTURE_COPY_LOCATION dst;
+            dst.pResource = readback.buffer;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            dst.PlacedFootprint = layouts[subres];
+
+            d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, &srcBox);
+        }
+        if (gpuTimer != nullptr) {
+            gpuTimer->End(d3d12CmdList, copyScope);
+        }
+
+        stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, restingState);
+        stateTracker.Flush(d3d12CmdList);
+    };
+
+    const auto verify = [&](uint32_t subres) {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[subres].Footprint;
+        ret[subres] = VerifySurface(readback.cpuAddress + (layouts[subres].Offset - readback.offset),
+                                    footprint.RowPitch,
+                                    footprint.Width,
+                                    footprint.Height,
+                                    expectedRgbas[desc.SliceOf(subres)]);
+    };
+
+    // Single submit and single wait for all slices
+    const uint64_t fenceValue = SubmitAndVerifyOnce(commandRing, numSubres, recordCopies, verify);
+
+    readbackAllocator.Release(readback, fenceValue);
+
+    return ret;
+}
+
+// Suballocates placed resources out of one large shared ID3D12Heap. The heap is shared once, so consumers open one NT
+// handle and place their views of any resource at the same offset, instead of opening a handle per committed
+// resource. The ranges are handed out by a HeapRangeAllocator.
+// D3D11 can't open heaps or placed resources, so only D3D12 consumers can use this.
+class SharedHeapAllocator {
+public:
+    struct Placement {
+        winrt::com_ptr<ID3D12Resource> resource;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    using Stats = HeapRangeAllocator::Stats;
+
+    // `heapFlags` selects the resource category on resource heap tier 1, e.g. D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES
+    SharedHeapAllocator(ID3D12Device* device, uint64_t heapSize, D3D12_HEAP_FLAGS heapFlags) : m_ranges(heapSize) {
+        m_device.copy_from(device);
+
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = heapSize;
+        heapDesc.Properties = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 0, 0};
+        // MSAA placement alignment, so multisampled arrays can be placed too
+        heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = D3D12_HEAP_FLAG_SHARED | heapFlags;
+        winrt::check_hresult(device->CreateHeap(&heapDesc, winrt::guid_of<ID3D12Heap>(), m_heap.put_void()));
+        winrt::check_hresult(device->CreateSharedHandle(m_heap.get(), nullptr, GENERIC_ALL, nullptr, m_sharedHandle.put()));
+    }
+
+    SharedHeapAllocator(const SharedHeapAllocator&) = delete;
+    SharedHeapAllocator& operator=(const SharedHeapAllocator&) = delete;
+
+    HANDLE SharedHandle() const {
+        return m_sharedHandle.get();
+    }
+
+    Placement Place(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue) {
+        const D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+
+        HeapRangeAllocator::Range range;
+        if (!m_ranges.Allocate(info.SizeInBytes, info.Alignment, range)) {
+            throw winrt::hresult_error(E_OUTOFMEMORY, L"Shared heap is full");
+        }
+
+        Placement placement;
+        placement.offset = range.offset;
+        placement.size = range.size;
+        const HRESULT hr = m_device->CreatePlacedResource(
+            m_heap.get(), range.offset, &desc, initialState, clearValue, winrt::guid_of<ID3D12Resource>(), placement.resource.put_void());
+        if (FAILED(hr)) {
+            m_ranges.Free(range);
+            winrt::throw_hresult(hr);
+        }
+        return placement;
+    }
+
+    // The GPU must be done with the resource, on the producer and on every consumer
+    void Free(Placement& placement) {
+        placement.resource = nullptr;
+        m_ranges.Free({placement.offset, placement.size});
+    }
+
+    Stats GetStats() const {
+        return m_ranges.GetStats();
+    }
+
+private:
+    winrt::com_ptr<ID3D12Device> m_device;
+    winrt::com_ptr<ID3D12Heap> m_heap;
+    winrt::handle m_sharedHandle;
+    HeapRangeAllocator m_ranges;
+};
+
+// The consumer side of a shared heap: opens the heap once and places resources at the producer's offsets. Records on a
+// device context from the pool, with its own readback allocator, so it can read what it opened without touching the
+// producer's queue. The context goes back to the pool when the consumer is destroyed.
+class SharedHeapConsumer {
+public:
+    SharedHeapConsumer(D3D12DevicePool& devicePool, const D3D12DeviceKey& deviceKey, HANDLE sharedHeapHandle)
+        : m_devicePool(devicePool), m_context(devicePool.Acquire(deviceKey)) {
+        ID3D12Device* device = m_context->device.get();
+        winrt::check_hresult(device->OpenSharedHandle(sharedHeapHandle, winrt::guid_of<ID3D12Heap>(), m_heap.put_void()));
+        m_readbackAllocator = std::make_unique<D3D12ReadbackAllocator>(device, *m_context->queueSync);
+    }
+
+    ~SharedHeapConsumer() {
+        m_context->queueSync->WaitFor(m_context->queueSync->LastSignaled());
+        m_devicePool.Release(std::move(m_context));
+    }
+
+    SharedHeapConsumer(const SharedHeapConsumer&) = delete;
+    SharedHeapConsumer& operator=(const SharedHeapConsumer&) = delete;
+
+    // Places a view of the producer's placement at the same offset, created in COMMON from the producer's exact
+    // description, flags included, so both resources have the same layout. The placement must have simultaneous access:
+    // such a texture is never compressed and inherits the heap's contents in COMMON instead of needing an initializing
+    // clear or discard, so the view reads what the producer wrote. The producer must be done writing it first.
+    ID3D12Resource* Open(uint64_t offset, const D3D12_RESOURCE_DESC& desc) {
+        if ((desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS) == 0) {
+            throw winrt::hresult_error(E_INVALIDARG, L"Shared heap placements need simultaneous access to be opened");
+        }
+
+        auto iter = m_opened.find(offset);
+        if (iter == m_opened.end()) {
+            winrt::com_ptr<ID3D12Resource> resource;
+            winrt::check_hresult(m_context->device->CreatePlacedResource(m_heap.get(),
+                                                                        offset,
+                                                                        &desc,
+                                                                        D3D12_RESOURCE_STATE_COMMON,
+                                                                        nullptr,
+                                                                        winrt::guid_of<ID3D12Resource>(),
+                                                                        resource.put_void()));
+            m_stateTracker.Register(resource.get(), desc.DepthOrArraySize * desc.MipLevels, D3D12_RESOURCE_STATE_COMMON);
+            iter = m_opened.emplace(offset, std::move(resource)).first;
+        }
+        return iter->second.get();
+    }
+
+    void Close(uint64_t offset) {
+        m_context->queueSync->WaitFor(m_context->queueSync->LastSignaled());
+        auto iter = m_opened.find(offset);
+        if (iter != m_opened.end()) {
+            m_stateTracker.Unregister(iter->second.get());
+            m_opened.erase(iter);
+        }
+    }
+
+    std::vector<VerifyResult> ReadBack(ID3D12Resource* resource, const TextureArrayDesc& desc, const uint32_t expectedRgbas[]) {
+        return TryBatchedCopyFromD3D12ToD3D12(m_context->device.get(),
+                                              *m_context->commandRing,
+                                              *m_readbackAllocator,
+                                              m_stateTracker,
+                                              resource,
+                                              desc,
+                                              expectedRgbas);
+    }
+
+private:
+    D3D12DevicePool& m_devicePool;
+    std::unique_ptr<D3D12DeviceContext> m_context;
+    winrt::com_ptr<ID3D12Heap> m_heap;
+    std::unique_ptr<D3D12ReadbackAllocator> m_readbackAllocator;
+    // States of the consumer's placed views, which are separate resources from the producer's placements
+    D3D12StateTracker m_stateTracker;
+    std::map<uint64_t, winrt::com_ptr<ID3D12Resource>> m_opened;
+};
+
+// Clears an array placed in the shared heap on the producer, then reads it back through the consumer's placed view
+std::vector<VerifyResult> TrySharedHeapPlacementFromD3D12(D3D12CommandContextRing& commandRing,
+                                                          RenderTargetViewCache& rtvCache,
+                                                          SharedHeapConsumer& consumer,
+                                                          const SharedHeapAllocator::Placement& placement,
+                                                          const TextureArrayDesc& desc,
+                                                          const XMFLOAT4 sliceColors[],
+                                                          const uint32_t expectedRgbas[]) {
+    ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle =
+            rtvCache.GetD3D12(placement.resource.get(), desc.MipOf(subres), desc.SliceOf(subres), desc.format);
+        d3d12CmdList->ClearRenderTargetView(rtvHandle, &sliceColors[desc.SliceOf(subres)].x, 0, nullptr);
+    }
+
+    // The consumer submits only after the producer's clears retired
+    commandRing.Sync().WaitFor(commandRing.Submit());
+
+    ID3D12Resource* consumerTexture = consumer.Open(placement.offset, placement.resource->GetDesc());
+    return consumer.ReadBack(consumerTexture, desc, expectedRgbas);
+}
+
+// Same as the batched copy, with the copies recorded across the recorder's workers. The tracker isn't thread safe, so
+// its barriers go into the ring's open list, which the recorder submits ahead of the worker lists, and into a list
+// submitted behind them.
+std::vector<VerifyResult> TryParallelCopyFromD3D12ToD3D12(ID3D12Device* d3d12Device,
+                                                          D3D12CommandContextRing& commandRing,
+                                                          D3D12ParallelRecorder& parallelRecorder,
+                                                          D3D12ReadbackAllocator& readbackAllocator,
+                                                          D3D12StateTracker& stateTracker,
+                                                          ID3D12Resource* d3d12Texture,
+                                                          const TextureArrayDesc& desc,
+                                                          const uint32_t expectedRgbas[]) {
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<VerifyResult> ret(numSubres);
+
+    D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    uint64_t requiredSize = 0;
+    d3d12Device->GetCopyableFootprints(&colorDesc, 0, numSubres, 0, layouts.data(), nullptr, nullptr, &requiredSize);
+
+    const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+    for (auto& layout : layouts) {
+        layout.Offset += readback.offset;
+    }
+
+    const auto recordCopies = [&](ID3D12GraphicsCommandList* cmdList, uint32_t begin, uint32_t end) {
+        for (uint32_t subres = begin; subres < end; ++subres) {
+            D3D12_TEXTURE_COPY_LOCATION src;
+            src.pResource = d3d12Texture;
+            src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            src.SubresourceIndex = subres;
+
+            D3D12_TEXTURE_COPY_LOCATION dst;
+            dst.pResource = readback.buffer;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            dst.PlacedFootprint = layouts[subres];
+
+            cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        }
+    };
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    stateTracker.Flush(commandRing.Begin());
+    parallelRecorder.RecordAndSubmit(numSubres, recordCopies);
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    stateTracker.Flush(commandRing.Begin());
+    const uint64_t fenceValue = commandRing.Submit();
+    commandRing.Sync().WaitFor(fenceValue);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[subres].Footprint;
+        ret[subres] = VerifySurface(readback.cpuAddress + (layouts[subres].Offset - readback.offset),
+                                    footprint.RowPitch,
+                                    footprint.Width,
+                                    footprint.Height,
+                                    expectedRgbas[desc.SliceOf(subres)]);
+    }
+
+    readbackAllocator.Release(readback, fenceValue);
+
+    return ret;
+}
+
+// Copies only the dirty rectangles, packed back to back into one readback region, patches them into the mirror and
+// verifies the mirror. Nothing is submitted when nothing changed since the last call.
+std::vector<VerifyResult> TryDirtyRegionReadbackFromD3D12(D3D12CommandContextRing& commandRing,
+                                                          D3D12ReadbackAllocator& readbackAllocator,
+                                                          D3D12StateTracker& stateTracker,
+                                                          DirtyRegionTracker& dirtyRegions,
+                                                          CpuTextureMirror& mirror,
+                                                          ID3D12Resource* d3d12Texture,
+                                                          const TextureArrayDesc& desc,
+                                                          const uint32_t expectedRgbas[]) {
+    struct Region {
+        uint32_t subres;
+        DirtyRect rect;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout;
+    };
+
+    std::vector<Region> regions;
+    uint64_t requiredSize = 0;
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        for (const DirtyRect& rect : dirtyRegions.Take(subres)) {
+            Region region;
+            region.subres = subres;
+            region.rect = rect;
+            region.layout.Offset =
+                (requiredSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~uint64_t(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+
+            D3D12_SUBRESOURCE_FOOTPRINT& footprint = region.layout.Footprint;
+            footprint.Format = desc.format;
+            footprint.Width = rect.right - rect.left;
+            footprint.Height = rect.bottom - rect.top;
+            footprint.Depth = 1;
+            footprint.RowPitch = (footprint.Width * BytesPerPixel(desc.format) + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
+                                 ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+
+            requiredSize = region.layout.Offset + static_cast<uint64_t>(footprint.RowPitch) * footprint.Height;
+            regions.push_back(region);
+        }
+    }
+
+    if (!regions.empty()) {
+        ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+        const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+
+        for (const Region& region : regions) {
+            stateTracker.Transition(d3d12Texture, region.subres, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        }
+        stateTracker.Flush(d3d12CmdList);
+
+        for (const Region& region : regions) {
+            D3D12_BOX srcBox;
+            srcBox.left = region.rect.left;
+            srcBox.top = region.rect.top;
+            srcBox.front = 0;
+            srcBox.right = region.rect.right;
+            srcBox.bottom = region.rect.bottom;
+            srcBox.back = 1;
+
+            D3D12_TEXTURE_COPY_LOCATION src;
+            src.pResource = d3d12Texture;
+            src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            src.SubresourceIndex = region.subres;
+
+            D3D12_TEXTURE_COPY_LOCATION dst;
+            dst.pResource = readback.buffer;
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            dst.PlacedFootprint = region.layout;
+            dst.PlacedFootprint.Offset += readback.offset;
+
+            d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, &srcBox);
+        }
+
+        for (const Region& region : regions) {
+            stateTracker.Transition(d3d12Texture, region.subres, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        }
+        stateTracker.Flush(d3d12CmdList);
+
+        const uint64_t fenceValue = commandRing.Submit();
+        commandRing.Sync().WaitFor(fenceValue);
+
+        for (const Region& region : regions) {
+            mirror.Patch(region.subres, region.rect, readback.cpuAddress + region.layout.Offset, region.layout.Footprint.RowPitch);
+        }
+
+        readbackAllocator.Release(readback, fenceValue);
+    }
+    mirror.MarkSynced();
+
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        const uint32_t mip = desc.MipOf(subres);
+        ret[subres] = VerifySurface(mirror.Data(subres),
+                                    mirror.RowPitch(subres),
+                                    desc.MipWidth(mip),
+                                    desc.MipHeight(mip),
+                                    expectedRgbas[desc.SliceOf(subres)]);
+    }
+
+    return ret;
+}
+
+// Re-clears the top-left quarter of every slice's top mip with its current color, the way an overlay update would
+// touch a small part of the array, and marks those rectangles dirty
+void UpdateOverlayRegion(RenderTargetViewCache& rtvCache,
+                         ID3D12GraphicsCommandList* d3d12CmdList,
+                         DirtyRegionTracker& dirtyRegions,
+                         ID3D12Resource* d3d12Texture,
+                         const TextureArrayDesc& desc,
+                         const XMFLOAT4 sliceColors[]) {
+    const DirtyRect rect = {0, 0, std::max(1U, desc.width / 4), std::max(1U, desc.height / 4)};
+    const D3D12_RECT clearRect = {
+        static_cast<LONG>(rect.left),
+        static_cast<LONG>(rect.top),
+        static_cast<LONG>(rect.right),
+        static_cast<LONG>(rect.bottom),
+    };
+
+    for (uint32_t slice = 0; slice < desc.arraySize; ++slice) {
+        const uint32_t subres = desc.Subresource(0, slice);
+        const D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = rtvCache.GetD3D12(d3d12Texture, 0, slice, desc.format);
+        d3d12CmdList->ClearRenderTargetView(rtvHandle, &sliceColors[slice].x, 1, &clearRect);
+        dirtyRegions.MarkDirty(subres, rect);
+    }
+}
+
+D3D12_FEATURE_DATA_ARCHITECTURE1 QueryArchitecture(ID3D12Device* device) {
+    D3D12_FEATURE_DATA_ARCHITECTURE1 architecture = {};
+    architecture.NodeIndex = 0;
+    winrt::check_hresult(device->CheckFeatureSupport(D3D12_FEATURE_ARCHITECTURE1, &architecture, sizeof(architecture)));
+    return architecture;
+}
+
+// What the interop paths check on a device before picking a path
+struct D3D12CapabilitySnapshot {
+    LUID adapterLuid = {};
+    uint64_t driverVersion = 0;
+    D3D12_SHARED_RESOURCE_COMPATIBILITY_TIER sharedResourceCompatibilityTier = D3D12_SHARED_RESOURCE_COMPATIBILITY_TIER_0;
+    D3D12_RESOURCE_HEAP_TIER resourceHeapTier = D3D12_RESOURCE_HEAP_TIER_1;
+    D3D12_FEATURE_DATA_ARCHITECTURE1 architecture = {};
+    std::vector<D3D12_FEATURE_DATA_FORMAT_SUPPORT> formats;
+
+    const D3D12_FEATURE_DATA_FORMAT_SUPPORT* FormatSupport(DXGI_FORMAT format) const {
+        for (const auto& support : formats) {
+            if (support.Format == format) {
+                return &support;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// CPU readable twin of a texture array in a WRITE_BACK / L0 custom heap. The GPU copies into it in the driver's own
+// layout and the CPU pulls texels out with ReadFromSubresource, so no readback buffer or footprint layout is involved.
+class D3D12ZeroCopyMirror {
+public:
+    D3D12ZeroCopyMirror(ID3D12Device* device, const TextureArrayDesc& desc) {
+        D3D12_RESOURCE_DESC mirrorDesc = ToD3D12(desc);
+        mirrorDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        D3D12_HEAP_PROPERTIES heapProp = {};
+        heapProp.Type = D3D12_HEAP_TYPE_CUSTOM;
+        heapProp.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_WRITE_BACK;
+        heapProp.MemoryPoolPreference = D3D12_MEMORY_POOL_L0;
+        winrt::check_hresult(device->CreateCommittedResource(&heapProp,
+                                                             D3D12_HEAP_FLAG_NONE,
+                                                             &mirrorDesc,
+                                                             D3D12_RESOURCE_STATE_COPY_DEST,
+                                                             nullptr,
+                                                             winrt::guid_of<ID3D12Resource>(),
+                                                             m_texture.put_void()));
+    }
+
+    ID3D12Resource* Texture() const {
+        return m_texture.get();
+    }
+
+    // The copy into the mirror must have retired
+    void Read(uint32_t subres, void* dst, uint32_t rowPitch, uint32_t height) {
+        winrt::check_hresult(m_texture->Map(subres, nullptr, nullptr));
+        const HRESULT hr = m_texture->ReadFromSubresource(dst, rowPitch, rowPitch * height, subres, nullptr);
+        m_texture->Unmap(subres, nullptr);
+        winrt::check_hresult(hr);
+    }
+
+private:
+    winrt::com_ptr<ID3D12Resource> m_texture;
+};
+
+std::vector<VerifyResult> TryZeroCopyReadbackFromD3D12(D3D12CommandContextRing& commandRing,
+                                                       D3D12StateTracker& stateTracker,
+                                                       D3D12ZeroCopyMirror& mirror,
+                                                       ID3D12Resource* d3d12Texture,
+                                                       const TextureArrayDesc& desc,
+                                                       const uint32_t expectedRgbas[]) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+
+    ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    stateTracker.Flush(d3d12CmdList);
+
+    // The mirror stays in COPY_DEST, the CPU doesn't care about resource states
+    d3d12CmdList->CopyResource(mirror.Texture(), d3d12Texture);
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    stateTracker.Flush(d3d12CmdList);
+
+    commandRing.Sync().WaitFor(commandRing.Submit());
+
+    std::vector<uint8_t> texels(static_cast<size_t>(desc.width) * desc.height * BytesPerPixel(desc.format));
+    for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+        const uint32_t mip = desc.MipOf(subres);
+        const uint32_t rowPitch = desc.MipWidth(mip) * BytesPerPixel(desc.format);
+        mirror.Read(subres, texels.data(), rowPitch, desc.MipHeight(mip));
+        ret[subres] = VerifySurface(texels.data(), rowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[desc.SliceOf(subres)]);
+    }
+
+    return ret;
+}
+
+// Places resources whose lifetimes never overlap in the same heap memory. Users declare every transient with the
+// passes it is used in, Compile() packs and places them, and Begin() at the first pass emits the aliasing barrier and
+// the initialization a placed resource needs before its first use. Declarations are per frame, the heap only grows.
+// Placed resources outlive the frame: one with the same description at the same offset is reused by the next
+// Compile(), so an unchanged packing creates nothing.
+class TransientResourceAllocator {
+public:
+    struct Stats {
+        uint64_t heapSize = 0;
+        uint64_t peakUnaliasedSize = 0;
+        uint32_t numHeapsCreated = 0;
+        uint64_t numPlacedResourcesCreated = 0;
+        uint64_t numAliasingBarriers = 0;
+        uint64_t numDiscards = 0;
+    };
+
+    TransientResourceAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags)
+        : m_heapType(heapType), m_heapFlags(heapFlags) {
+        m_device.copy_from(device);
+    }
+
+    TransientResourceAllocator(const TransientResourceAllocator&) = delete;
+    TransientResourceAllocator& operator=(const TransientResourceAllocator&) = delete;
+
+    // Ends last frame's transients; the GPU must be done with them. Their placed resources are kept for Compile().
+    void Reset() {
+        for (auto& transient : m_transients) {
+            m_previous.push_back(std::move(transient));
+        }
+        m_transients.clear();
+        m_lifetimes.clear();
+    }
+
+    // Declares a resource used from `firstPass` through `lastPass`, inclusive. Render targets and depth stencils must be
+    // declared in RENDER_TARGET or DEPTH_WRITE, as they are discarded in that state by Begin().
+    uint32_t Declare(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, uint32_t firstPass, uint32_t lastPass) {
+        const D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+
+        Transient transient;
+        transient.desc = desc;
+        transient.initialState = initialState;
+        m_transients.push_back(std::move(transient));
+
+        TransientLifetime lifetime;
+        lifetime.size = info.SizeInBytes;
+        lifetime.alignment = info.Alignment;
+        lifetime.firstPass = firstPass;
+        lifetime.lastPass = lastPass;
+        m_lifetimes.push_back(lifetime);
+
+        return static_cast<uint32_t>(m_transients.size() - 1);
+    }
+
+    void Compile() {
+        const uint64_t heapSize = PackTransientLifetimes(m_lifetimes);
+        if (heapSize > m_stats.heapSize) {
+            // Placed resources die with their heap
+            m_previous.clear();
+
+            D3D12_HEAP_DESC heapDesc = {};
+            heapDesc.SizeInBytes = heapSize;
+            heapDesc.Properties = {m_heapType, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 0, 0};
+            heapDesc.Alignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+            heapDesc.Flags = m_heapFlags;
+            m_heap = nullptr;
+            winrt::check_hresult(m_device->CreateHeap(&heapDesc, winrt::guid_of<ID3D12Heap>(), m_heap.put_void()));
+            m_stats.heapSize = heapSize;
+            ++m_stats.numHeapsCreated;
+        }
+
+        uint64_t unaliasedSize = 0;
+        for (size_t i = 0; i < m_transients.size(); ++i) {
+            Transient& transient = m_transients[i];
+            transient.offset = m_lifetimes[i].offset;
+            if (!ReusePlaced(transient)) {
+                transient.state = transient.initialState;
+                winrt::check_hresult(m_device->CreatePlacedResource(m_heap.get(),
+                                                                    transient.offset,
+                                                                    &transient.desc,
+                                                                    transient.initialState,
+                                                                    nullptr,
+                                                                    winrt::guid_of<ID3D12Resource>(),
+                                                                    transient.resource.put_void()));
+                ++m_stats.numPlacedResourcesCreated;
+            }
+            unaliasedSize += m_lifetimes[i].size;
+
+            // The aliasing barrier can name the previous occupant when there is exactly one, otherwise it covers all
+            transient.aliasBefore = nullptr;
+            uint32_t numPrevious = 0;
+            for (size_t j = 0; j < i; ++j) {
+                if ((m_lifetimes[j].lastPass < m_lifetimes[i].firstPass) && m_lifetimes[j].OverlapsInMemory(m_lifetimes[i])) {
+                    transient.aliasBefore = m_transients[j].resource.get();
+                    ++numPrevious;
+                }
+            }
+            if (numPrevious != 1) {
+                transient.aliasBefore = nullptr;
+            }
+        }
+        m_previous.clear();
+        m_stats.peakUnaliasedSize = std::max(m_stats.peakUnaliasedSize, unaliasedSize);
+    }
+
+    // A reused resource is returned to its declared state along with the aliasing barrier
+    ID3D12Resource* Begin(ID3D12GraphicsCommandList* cmdList, uint32_t id) {
+        Transient& transient = m_transients[id];
+
+        D3D12_RESOURCE_BARRIER barriers[2];
+        barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        barriers[0].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barriers[0].Aliasing.pResourceBefore = transient.aliasBefore;
+        barriers[0].Aliasing.pResourceAfter = transient.resource.get();
+        uint32_t numBarriers = 1;
+        if (transient.state != transient.initialState) {
+            barriers[1] = TransitionBarrier(transient, transient.initialState);
+            ++numBarriers;
+        }
+        cmdList->ResourceBarrier(numBarriers, barriers);
+        ++m_stats.numAliasingBarriers;
+
+        // Placed render targets and depth stencils have undefined metadata until cleared, discarded or fully copied to
+        if (transient.desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) {
+            cmdList->DiscardResource(transient.resource.get(), nullptr);
+            ++m_stats.numDiscards;
+        }
+
+        return transient.resource.get();
+    }
+
+    // Transitions go through here so a reused resource's state is known to the next frame
+    void Transition(ID3D12GraphicsCommandList* cmdList, uint32_t id, D3D12_RESOURCE_STATES state) {
+        Transient& transient = m_transients[id];
+        if (transient.state != state) {
+            const D3D12_RESOURCE_BARRIER barrier = TransitionBarrier(transient, state);
+            cmdList->ResourceBarrier(1, &barrier);
+        }
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Transient {
+        D3D12_RESOURCE_DESC desc;
+        D3D12_RESOURCE_STATES initialState;
+        uint64_t offset = 0;
+        winrt::com_ptr<ID3D12Resource> resource;
+        D3D12_RESOURCE_STATES state;
+        ID3D12Resource* aliasBefore = nullptr;
+    };
+
+    static bool SameDesc(const D3D12_RESOURCE_DESC& lhs, const D3D12_RESOURCE_DESC& rhs) {
+        return (lhs.Dimension == rhs.Dimension) && (lhs.Alignment == rhs.Alignment) && (lhs.Width == rhs.Width) &&
+               (lhs.Height == rhs.Height) && (lhs.DepthOrArraySize == rhs.DepthOrArraySize) && (lhs.MipLevels == rhs.MipLevels) &&
+               (lhs.Format == rhs.Format) && (lhs.SampleDesc.Count == rhs.SampleDesc.Count) &&
+               (lhs.SampleDesc.Quality == rhs.SampleDesc.Quality) && (lhs.Layout == rhs.Layout) && (lhs.Flags == rhs.Flags);
+    }
+
+    static D3D12_RESOURCE_BARRIER TransitionBarrier(Transient& transient, D3D12_RESOURCE_STATES state) {
+        D3D12_RESOURCE_BARRIER barrier;
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        barrier.Transition.pResource = transient.resource.get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = transient.state;
+        barrier.Transition.StateAfter = state;
+        transient.state = state;
+        return barrier;
+    }
+
+    // Takes over last frame's resource with the same description at the same offset, if there is one
+    bool ReusePlaced(Transient& transient) {
+        for (auto& previous : m_previous) {
+            if (previous.resource && (previous.offset == transient.offset) && SameDesc(previous.desc, transient.desc)) {
+                transient.resource = std::move(previous.resource);
+                transient.state = previous.state;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    winrt::com_ptr<ID3D12Device> m_device;
+    D3D12_HEAP_TYPE m_heapType;
+    D3D12_HEAP_FLAGS m_heapFlags;
+    winrt::com_ptr<ID3D12Heap> m_heap;
+    std::vector<Transient> m_transients;
+    std::vector<TransientLifetime> m_lifetimes;
+    // Last frame's transients between Reset() and Compile()
+    std::vector<Transient> m_previous;
+    Stats m_stats;
+};
+
+// Resolves each subresource of a multisampled array into a transient single-sampled texture and reads that back. The
+// resolve targets are used in one pass each, so all of them alias the memory of the largest one.
+std::vector<VerifyResult> TryTransientResolveReadbackFromD3D12(ID3D12Device* d3d12Device,
+                                                               D3D12CommandContextRing& commandRing,
+                                                               TransientResourceAllocator& transients,
+                                                               D3D12ReadbackAllocator& readbackAllocator,
+                                                               D3D12StateTracker& stateTracker,
+                                                               ID3D12Resource* d3d12Texture,
+                                                               const TextureArrayDesc& desc,
+                                                               const uint32_t expectedRgbas[]) {
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<VerifyResult> ret(numSubres);
+
+    transients.Reset();
+    std::vector<uint32_t> resolveTargets(numSubres);
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    uint64_t requiredSize = 0;
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        const uint32_t mip = desc.MipOf(subres);
+        D3D12_RESOURCE_DESC resolveDesc = ToD3D12(TextureArrayDesc{desc.MipWidth(mip), desc.MipHeight(mip), 1, 1, desc.format});
+        resolveDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+        resolveTargets[subres] = transients.Declare(resolveDesc, D3D12_RESOURCE_STATE_RESOLVE_DEST, subres, subres);
+
+        uint64_t size = 0;
+        d3d12Device->GetCopyableFootprints(&resolveDesc, 0, 1, requiredSize, &layouts[subres], nullptr, nullptr, &size);
+        requiredSize = (layouts[subres].Offset + size + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) &
+                       ~static_cast<uint64_t>(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+    }
+    transients.Compile();
+
+    ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+    const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+    for (auto& layout : layouts) {
+        layout.Offset += readback.offset;
+    }
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+    stateTracker.Flush(d3d12CmdList);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        ID3D12Resource* resolveTarget = transients.Begin(d3d12CmdList, resolveTargets[subres]);
+        d3d12CmdList->ResolveSubresource(resolveTarget, 0, d3d12Texture, subres, desc.format);
+        transients.Transition(d3d12CmdList, resolveTargets[subres], D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+        D3D12_TEXTURE_COPY_LOCATION src;
+        src.pResource = resolveTarget;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION dst;
+        dst.pResource = readback.buffer;
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dst.PlacedFootprint = layouts[subres];
+
+        d3d12CmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    stateTracker.Flush(d3d12CmdList);
+
+    const uint64_t fenceValue = commandRing.Submit();
+    commandRing.Sync().WaitFor(fenceValue);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[subres].Footprint;
+        ret[subres] = VerifySurface(readback.cpuAddress + (layouts[subres].Offset - readback.offset),
+                                    footprint.RowPitch,
+                                    footprint.Width,
+                                    footprint.Height,
+                                    expectedRgbas[desc.SliceOf(subres)]);
+    }
+
+    readbackAllocator.Release(readback, fenceValue);
+
+    return ret;
+}
+
+// A COPY queue that runs readbacks on the copy engine, next to whatever the direct queue is rendering. Resources are
+// handed over through the COMMON state in the order CopyQueueHandoff sequences.
+class D3D12CopyQueue {
+public:
+    explicit D3D12CopyQueue(ID3D12Device* device) {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        winrt::check_hresult(device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), m_cmdQueue.put_void()));
+        m_queueSync = std::make_unique<D3D12QueueSync>(device, m_cmdQueue.get());
+        m_commandRing = std::make_unique<D3D12CommandContextRing>(device, *m_queueSync, D3D12_COMMAND_LIST_TYPE_COPY);
+        m_handoff = std::make_unique<CopyQueueHandoff<D3D12CommandContextRing>>(*m_commandRing);
+        m_readbackAllocator = std::make_unique<D3D12ReadbackAllocator>(device, *m_queueSync);
+    }
+
+    D3D12CopyQueue(const D3D12CopyQueue&) = delete;
+    D3D12CopyQueue& operator=(const D3D12CopyQueue&) = delete;
+
+    D3D12QueueSync& Sync() {
+        return *m_queueSync;
+    }
+
+    // The copy ring's open list
+    ID3D12GraphicsCommandList* CmdList() {
+        return m_commandRing->Begin();
+    }
+
+    // Readback memory written by copy lists, retired on the copy queue's timeline
+    D3D12ReadbackAllocator& ReadbackAllocator() {
+        return *m_readbackAllocator;
+    }
+
+    // Submits the producer's open list with a transition of `resource` to COMMON and makes the copy queue wait for it
+    // on the GPU. On the copy queue the resource is promoted out of COMMON by the copies and decays back to it once
+    // they completed, so the tracker keeps it in COMMON.
+    void AcquireFrom(D3D12CommandContextRing& producer, D3D12StateTracker& stateTracker, ID3D12Resource* resource) {
+        m_handoff->AcquireFrom(producer, stateTracker, resource, D3D12_RESOURCE_STATE_COMMON);
+    }
+
+    // Returns the fence value on the copy queue's timeline that retires with the copies
+    uint64_t Submit() {
+        return m_handoff->Submit();
+    }
+
+    // Makes the consumer queue wait for the copies on the GPU and records the transition of `resource` out of COMMON
+    // into the consumer's open list
+    void ReturnTo(D3D12CommandContextRing& consumer,
+                  D3D12StateTracker& stateTracker,
+                  ID3D12Resource* resource,
+                  D3D12_RESOURCE_STATES stateAfter,
+                  uint64_t copyValue) {
+        m_handoff->ReturnTo(consumer, stateTracker, resource, stateAfter, copyValue);
+    }
+
+private:
+    winrt::com_ptr<ID3D12CommandQueue> m_cmdQueue;
+    std::unique_ptr<D3D12QueueSync> m_queueSync;
+    // Copy allocators are recycled per fence value like the direct ones, instead of draining the queue before each
+    // reset
+    std::unique_ptr<D3D12CommandContextRing> m_commandRing;
+    std::unique_ptr<CopyQueueHandoff<D3D12CommandContextRing>> m_handoff;
+    std::unique_ptr<D3D12ReadbackAllocator> m_readbackAllocator;
+};
+
+// Records copies of subresources [firstSubres, firstSubres + layouts.size()) into one readback region
+void RecordReadbackCopies(ID3D12GraphicsCommandList* cmdList,
+                          ID3D12Resource* d3d12Texture,
+                          const D3D12ReadbackAllocator::Allocation& readback,
+                          const std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>& layouts,
+                          uint32_t firstSubres = 0) {
+    for (uint32_t subres = 0; subres < layouts.size(); ++subres) {
+        D3D12_TEXTURE_COPY_LOCATION src;
+        src.pResource = d3d12Texture;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = firstSubres + subres;
+
+        D3D12_TEXTURE_COPY_LOCATION dst;
+        dst.pResource = readback.buffer;
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dst.PlacedFootprint = layouts[subres];
+
+        cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+}
+
+std::vector<VerifyResult> TryCopyQueueReadbackFromD3D12(ID3D12Device* d3d12Device,
+                                                        D3D12CommandContextRing& commandRing,
+                                                        D3D12CopyQueue& copyQueue,
+                                                        D3D12StateTracker& stateTracker,
+                                                        ID3D12Resource* d3d12Texture,
+                                                        const TextureArrayDesc& desc,
+                                                        const uint32_t expectedRgbas[]) {
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<VerifyResult> ret(numSubres);
+
+    D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    uint64_t requiredSize = 0;
+    d3d12Device->GetCopyableFootprints(&colorDesc, 0, numSubres, 0, layouts.data(), nullptr, nullptr, &requiredSize);
+
+    D3D12ReadbackAllocator& readbackAllocator = copyQueue.ReadbackAllocator();
+    const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+    for (auto& layout : layouts) {
+        layout.Offset += readback.offset;
+    }
+
+    copyQueue.AcquireFrom(commandRing, stateTracker, d3d12Texture);
+    RecordReadbackCopies(copyQueue.CmdList(), d3d12Texture, readback, layouts);
+    const uint64_t copyValue = copyQueue.Submit();
+    copyQueue.ReturnTo(commandRing, stateTracker, d3d12Texture, D3D12_RESOURCE_STATE_RENDER_TARGET, copyValue);
+
+    copyQueue.Sync().WaitFor(copyValue);
+
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layouts[subres].Footprint;
+        ret[subres] = VerifySurface(readback.cpuAddress + (layouts[subres].Offset - readback.offset),
+                                    footprint.RowPitch,
+                                    footprint.Width,
+                                    footprint.Height,
+                                    expectedRgbas[desc.SliceOf(subres)]);
+    }
+
+    readbackAllocator.Release(readback, copyValue);
+
+    return ret;
+}
+
+// Compares readback of the texture array running serialized behind a burst of rendering on the direct queue against
+// running on the copy queue while that rendering executes
+void CopyQueueOverlapBenchmark(ID3D12Device* d3d12Device,
+                               D3D12CommandContextRing& commandRing,
+                               D3D12CopyQueue& copyQueue,
+                               D3D12ReadbackAllocator& readbackAllocator,
+                               D3D12StateTracker& stateTracker,
+                               ID3D12Resource* d3d12Texture,
+                               const TextureArrayDesc& desc) {
+    constexpr uint32_t numClears = 256;
+    constexpr uint32_t iterations = 10;
+
+    // Stand-in for the producer's rendering: many full clears of a large render target
+    D3D12_RESOURCE_DESC scratchDesc = ToD3D12(TextureArrayDesc{4096, 4096, 1});
+    D3D12_HEAP_PROPERTIES heapProp = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 1, 1};
+    winrt::com_ptr<ID3D12Resource> scratch;
+    winrt::check_hresult(d3d12Device->CreateCommittedResource(&heapProp,
+                                                              D3D12_HEAP_FLAG_NONE,
+                                                              &scratchDesc,
+                                                              D3D12_RESOURCE_STATE_RENDER_TARGET,
+                                                              nullptr,
+                                                              winrt::guid_of<ID3D12Resource>(),
+                                                              scratch.put_void()));
+    RenderTargetViewCache rtvCache(d3d12Device);
+    const D3D12_CPU_DESCRIPTOR_HANDLE scratchRtv = rtvCache.GetD3D12(scratch.get(), 0, 0, scratchDesc.Format);
+    const float clearColor[] = {0.25f, 0.5f, 0.75f, 1.0f};
+    const auto recordRendering = [&] {
+        for (uint32_t i = 0; i < numClears; ++i) {
+            commandRing.Begin()->ClearRenderTargetView(scratchRtv, clearColor, 0, nullptr);
+        }
+    };
+    const auto submitDirect = [&] {
+        return commandRing.Submit();
+    };
+    const auto flushDirect = [&] {
+        commandRing.Sync().WaitFor(submitDirect());
+    };
+
+    const uint32_t numSubres = desc.NumSubresources();
+    D3D12_RESOURCE_DESC colorDesc = d3d12Texture->GetDesc();
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+    uint64_t requiredSize = 0;
+    d3d12Device->GetCopyableFootprints(&colorDesc, 0, numSubres, 0, layouts.data(), nullptr, nullptr, &requiredSize);
+    const D3D12ReadbackAllocator::Allocation readback = readbackAllocator.Allocate(requiredSize);
+    for (auto& layout : layouts) {
+        layout.Offset += readback.offset;
+    }
+
+    const auto measure = [&](const std::function<void()>& body) {
+        flushDirect();
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            body();
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count() / iterations;
+    };
+
+    const double renderMs = measure([&] {
+        recordRendering();
+        flushDirect();
+    });
+
+    const double serializedMs = measure([&] {
+        recordRendering();
+        ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+        stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        stateTracker.Flush(d3d12CmdList);
+        RecordReadbackCopies(d3d12CmdList, d3d12Texture, readback, layouts);
+        stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        stateTracker.Flush(d3d12CmdList);
+        flushDirect();
+    });
+
+    double copyOnlyMs = 0;
+    const double overlappedMs = measure([&] {
+        const auto copyStart = std::chrono::high_resolution_clock::now();
+        copyQueue.AcquireFrom(commandRing, stateTracker, d3d12Texture);
+        RecordReadbackCopies(copyQueue.CmdList(), d3d12Texture, readback, layouts);
+        const uint64_t copyValue = copyQueue.Submit();
+
+        // The producer keeps rendering to other targets while the copy engine reads the array
+        recordRendering();
+        submitDirect();
+
+        copyQueue.Sync().WaitFor(copyValue);
+        copyOnlyMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - copyStart).count();
+
+        copyQueue.ReturnTo(commandRing, stateTracker, d3d12Texture, D3D12_RESOURCE_STATE_RENDER_TARGET, copyValue);
+        flushDirect();
+    });
+    copyOnlyMs /= iterations;
+
+    readbackAllocator.Release(readback, commandRing.Sync().LastSignaled());
+
+    // Fraction of the readback hidden behind rendering, relative to running both back to back on the direct queue
+    const double readbackMs = serializedMs - renderMs;
+    const double hiddenMs = serializedMs - overlappedMs;
+    std::cout << "Copy queue overlap: render " << renderMs << " ms, render + direct readback " << serializedMs
+              << " ms, render + copy queue readback " << overlappedMs << " ms (copy done after " << copyOnlyMs << " ms), "
+              << (readbackMs > 0 ? 100.0 * hiddenMs / readbackMs : 0.0) << "% of readback hidden\n\n";
+}
+
+// CPU time to record clears of every subresource on one thread into the ring's open list against recording them across
+// the recorder's workers. The GPU work is the same either way, so the difference is the cost of recording.
+void ParallelRecordingBenchmark(D3D12CommandContextRing& commandRing,
+                                D3D12ParallelRecorder& parallelRecorder,
+                                RenderTargetViewCache& rtvCache,
+                                D3D12StateTracker& stateTracker,
+                                ID3D12Resource* d3d12Texture,
+                                const TextureArrayDesc& desc) {
+    constexpr uint32_t iterations = 10;
+    // Every subresource is cleared this many times, so even a small array takes measurable time to record
+    constexpr uint32_t clearsPerSubresource = 64;
+
+    const uint32_t numSubres = desc.NumSubresources();
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvHandles(numSubres);
+    for (uint32_t subres = 0; subres < numSubres; ++subres) {
+        rtvHandles[subres] = rtvCache.GetD3D12(d3d12Texture, desc.MipOf(subres), desc.SliceOf(subres), desc.format);
+    }
+    const float clearColor[] = {0.25f, 0.5f, 0.75f, 1.0f};
+    const uint32_t numClears = numSubres * clearsPerSubresource;
+    const auto recordClears = [&](ID3D12GraphicsCommandList* cmdList, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            cmdList->ClearRenderTargetView(rtvHandles[i % numSubres], clearColor, 0, nullptr);
+        }
+    };
+
+    stateTracker.Transition(d3d12Texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    stateTracker.Flush(commandRing.Begin());
+
+    // From the start of recording to the submission, with the GPU idle before each iteration
+    const auto measure = [&](const std::function<uint64_t()>& recordAndSubmit) {
+        commandRing.Sync().WaitFor(commandRing.Submit());
+        double totalMs = 0;
+        for (uint32_t i = 0; i < iterations; ++i) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            const uint64_t fenceValue = recordAndSubmit();
+            totalMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            commandRing.Sync().WaitFor(fenceValue);
+        }
+        return totalMs / iterations;
+    };
+
+    const double serialMs = measure([&] {
+        recordClears(commandRing.Begin(), 0, numClears);
+        return commandRing.Submit();
+    });
+    const double parallelMs = measure([&] {
+        return parallelRecorder.RecordAndSubmit(numClears, recordClears);
+    });
+
+    std::cout << "Parallel recording: " << numClears << " clears, 1 thread " << serialMs << " ms, " << parallelRecorder.NumThreads()
+              << " threads " << parallelMs << " ms, " << (parallelMs > 0 ? serialMs / parallelMs : 0.0) << "x speedup\n\n";
+}
+
+// Streams readbacks of a texture's subresources with up to `depth` frames in flight. Every frame slot of the
+// ReadbackFrameRing owns a persistently mapped readback buffer; commands are recorded through the caller's ring, so
+// frame N can be consumed on the CPU while frame N+1 is recorded and executed on the GPU.
+class D3D12ReadbackPipeline {
+public:
+    using ConsumeFunc = std::function<void(uint64_t frameId, const uint8_t* data)>;
+
+    D3D12ReadbackPipeline(ID3D12Device* device,
+                          D3D12CommandContextRing& commandRing,
+                          const D3D12_RESOURCE_DESC& textureDesc,
+                          uint32_t depth)
+        : m_commandRing(commandRing), m_frames(depth), m_buffers(depth) {
+        const uint32_t numSubres = textureDesc.DepthOrArraySize * textureDesc.MipLevels;
+        m_layouts.resize(numSubres);
+        uint64_t requiredSize = 0;
+        device->GetCopyableFootprints(&textureDesc, 0, numSubres, 0, m_layouts.data(), nullptr, nullptr, &requiredSize);
+
+        D3D12_HEAP_PROPERTIES heap;
+        heap.Type = D3D12_HEAP_TYPE_READBACK;
+        heap.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heap.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heap.CreationNodeMask = 1;
+        heap.VisibleNodeMask = 1;
+
+        D3D12_RESOURCE_DESC bufferDesc{};
+        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        bufferDesc.Alignment = 0;
+        bufferDesc.Width = requiredSize;
+        bufferDesc.Height = 1;
+        bufferDesc.DepthOrArraySize = 1;
+        bufferDesc.MipLevels = 1;
+        bufferDesc.SampleDesc.Count = 1;
+        bufferDesc.SampleDesc.Quality = 0;
+        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        for (auto& buffer : m_buffers) {
+            winrt::check_hresult(device->CreateCommittedResource(&heap,
+                                                                 D3D12_HEAP_FLAG_NONE,
+                                                                 &bufferDesc,
+                                                                 D3D12_RESOURCE_STATE_COPY_DEST,
+                                                                 nullptr,
+                                                                 IID_ID3D12Resource,
+                                                                 buffer.resource.put_void()));
+
+            // Readback buffers stay mapped for the lifetime of the pipeline
+            D3D12_RANGE readRange;
+            readRange.Begin = 0;
+            readRange.End = static_cast<SIZE_T>(requiredSize);
+            winrt::check_hresult(buffer.resource->Map(0, &readRange, reinterpret_cast<void**>(&buffer.mapped)));
+        }
+    }
+
+    ~D3D12ReadbackPipeline() {
+        // Nothing may still be writing into the mapped buffers when they are released
+        for (uint32_t slot = 0; slot < m_frames.Depth(); ++slot) {
+            if (m_frames.InFlight(slot)) {
+                m_commandRing.Sync().WaitFor(m_frames.FenceValue(slot));
+            }
+
+            D3D12_RANGE writtenRange{0, 0};
+            m_buffers[slot].resource->Unmap(0, &writtenRange);
+        }
+    }
+
+    D3D12ReadbackPipeline(const D3D12ReadbackPipeline&) = delete;
+    D3D12ReadbackPipeline& operator=(const D3D12ReadbackPipeline&) = delete;
+
+    uint32_t Depth() const {
+        return m_frames.Depth();
+    }
+
+    const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& Layout(uint32_t subres) const {
+        return m_layouts[subres];
+    }
+
+    // Records a readback of every subresource of the texture into the ring's open list and submits it, behind anything
+    // already recorded there. Only blocks when all frames are in flight, in which case the oldest one is waited for and
+    // consumed to free its slot.
+    uint64_t Submit(ID3D12Resource* texture,
+                    D3D12StateTracker& stateTracker,
+                    D3D12_RESOURCE_STATES restingState,
+                    const ConsumeFunc& consume) {
+        const Buffer& buffer = m_buffers[m_frames.Acquire(m_commandRing.Sync(), ConsumeSlot(consume))];
+        ID3D12GraphicsCommandList* cmdList = m_commandRing.Begin();
+        stateTracker.Transition(texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        stateTracker.Flush(cmdList);
+
+        for (uint32_t subres = 0; subres < m_layouts.size(); ++subres) {
+            D3D12_TEXTURE_COPY_LOCATION src;
+            src.pResource = texture;
+            src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+            src.SubresourceIndex = subres;
+
+            D3D12_TEXTURE_COPY_LOCATION dst;
+            dst.pResource = buffer.resource.get();
+            dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            dst.PlacedFootprint = m_layouts[subres];
+
+            cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+        }
+
+        stateTracker.Transition(texture, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, restingState);
+        stateTracker.Flush(cmdList);
+
+        return m_frames.Commit(m_commandRing.Submit());
+    }
+
+    // Consumes, in submission order, every frame the GPU has already finished without blocking
+    void Poll(const ConsumeFunc& consume) {
+        m_frames.Poll(m_commandRing.Sync(), ConsumeSlot(consume));
+    }
+
+    void Drain(const ConsumeFunc& consume) {
+        m_frames.Drain(m_commandRing.Sync(), ConsumeSlot(consume));
+    }
+
+private:
+    struct Buffer {
+        winrt::com_ptr<ID3D12Resource> resource;
+        uint8_t* mapped = nullptr;
+    };
+
+    // Hands the consumer the mapped memory of the frame's slot
+    std::function<void(uint32_t, uint64_t)> ConsumeSlot(const ConsumeFunc& consume) const {
+        return [this, &consume](uint32_t slot, uint64_t frameId) { consume(frameId, m_buffers[slot].mapped); };
+    }
+
+    D3D12CommandContextRing& m_commandRing;
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> m_layouts;
+    ReadbackFrameRing m_frames;
+    std::vector<Buffer> m_buffers;
+};
+
+std::vector<VerifyResult> TryPipelinedReadbackFromD3D12(D3D12ReadbackPipeline& readbackPipeline,
+                                                        D3D12StateTracker& stateTracker,
+                                                        ID3D12Resource* d3d12Texture,
+                                                        const TextureArrayDesc& desc,
+                                                        const uint32_t expectedRgbas[],
+                                                        uint32_t numFrames) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+
+    const auto consume = [&](uint64_t, const uint8_t* data) {
+        for (uint32_t subres = 0; subres < ret.size(); ++subres) {
+            const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = readbackPipeline.Layout(subres);
+            ret[subres].Merge(VerifySurface(data + layout.Offset,
+                                            layout.Footprint.RowPitch,
+                                            layout.Footprint.Width,
+                                            layout.Footprint.Height,
+                                            expectedRgbas[desc.SliceOf(subres)]));
+        }
+    };
+
+    for (uint32_t frame = 0; frame < numFrames; ++frame) {
+        readbackPipeline.Submit(d3d12Texture, stateTracker, D3D12_RESOURCE_STATE_RENDER_TARGET, consume);
+        readbackPipeline.Poll(consume);
+    }
+    readbackPipeline.Drain(consume);
+
+    return ret;
+}
+
+// The D3D11 device of a StagingPool
+class D3D11StagingDevice {
+public:
+    using Texture = winrt::com_ptr<ID3D11Texture2D>;
+    using Desc = D3D11_TEXTURE2D_DESC;
+    using Key = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, DXGI_FORMAT, uint32_t>;
+
+    explicit D3D11StagingDevice(ID3D11Device* d3d11Device) {
+        m_d3d11Device.copy_from(d3d11Device);
+    }
+
+    Key KeyOf(const Desc& desc) const {
+        return {desc.Width, desc.Height, desc.MipLevels, desc.ArraySize, desc.Format, desc.SampleDesc.Count};
+    }
+
+    Desc DescOf(const Texture& texture) const {
+        Desc desc;
+        texture->GetDesc(&desc);
+        return desc;
+    }
+
+    Texture CreateStaging(const Desc& sourceDesc) {
+        D3D11_TEXTURE2D_DESC colorDesc = sourceDesc;
+        colorDesc.Usage = D3D11_USAGE_STAGING;
+        colorDesc.BindFlags = 0;
+        colorDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        colorDesc.MiscFlags = 0;
+        winrt::com_ptr<ID3D11Texture2D> texture;
+        winrt::check_hresult(m_d3d11Device->CreateTexture2D(&colorDesc, nullptr, texture.put()));
+        return texture;
+    }
+
+private:
+    winrt::com_ptr<ID3D11Device> m_d3d11Device;
+};
+
+// Recycles D3D11 staging textures by descriptor
+using D3D11StagingPool = StagingPool<D3D11StagingDevice>;
+
+// The D3D11 context of a StagingReadback: maps one staging texture with D3D11_MAP_FLAG_DO_NOT_WAIT
+class D3D11StagingContext {
+public:
+    using Mapped = D3D11_MAPPED_SUBRESOURCE;
+
+    D3D11StagingContext(ID3D11DeviceContext* d3d11Context, ID3D11Texture2D* stagingTexture)
+        : m_d3d11Context(d3d11Context), m_stagingTexture(stagingTexture) {
+    }
+
+    ID3D11DeviceContext* Context() const {
+        return m_d3d11Context;
+    }
+
+    ID3D11Texture2D* StagingTexture() const {
+        return m_stagingTexture;
+    }
+
+    void Flush() {
+        m_d3d11Context->Flush();
+    }
+
+    bool TryMap(uint32_t subres, Mapped& mapped) {
+        const HRESULT hr = m_d3d11Context->Map(m_stagingTexture, subres, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+        if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+            return false;
+        }
+        winrt::check_hresult(hr);
+        return true;
+    }
+
+    void Unmap(uint32_t subres) {
+        m_d3d11Context->Unmap(m_stagingTexture, subres);
+    }
+
+private:
+    ID3D11DeviceContext* m_d3d11Context;
+    ID3D11Texture2D* m_stagingTexture;
+};
+
+// Reads a staging texture back without blocking: every subresource is mapped with D3D11_MAP_FLAG_DO_NOT_WAIT and
+// Poll() returns to the caller while the copy is still in flight.
+class D3D11StagingReadback : public StagingReadback<D3D11StagingContext> {
+public:
+    D3D11StagingReadback(ID3D11DeviceContext* d3d11Context, ID3D11Texture2D* stagingTexture)
+        : StagingReadback(d3d11Context, stagingTexture) {
+    }
+
+    // Copies every subresource of `source` and reads all of them back
+    void CopyFrom(ID3D11Texture2D* source) {
+        ID3D11Texture2D* stagingTexture = GetContext().StagingTexture();
+        GetContext().Context()->CopyResource(stagingTexture, source);
+
+        D3D11_TEXTURE2D_DESC desc;
+        stagingTexture->GetDesc(&desc);
+        std::vector<uint32_t> subresources(desc.MipLevels * desc.ArraySize);
+        for (uint32_t subres = 0; subres < subresources.size(); ++subres) {
+            subresources[subres] = subres;
+        }
+        Issue(std::move(subresources));
+    }
+};
+
+// Creates shared single-slice intermediates (every mip of one array slice) and opens them on D3D11 once, for a
+// FencedSlicePool. Intermediates are created in COPY_DEST and have to be returned in that state.
+class D3D12SharedSliceDevice {
+public:
+    struct Slice {
+        winrt::com_ptr<ID3D12Resource> d3d12Texture;
+        winrt::com_ptr<ID3D11Texture2D> d3d11Texture;
+    };
+
+    using Desc = TextureArrayDesc;
+    using Key = std::tuple<uint32_t, uint32_t, uint32_t, DXGI_FORMAT>;
+
+    D3D12SharedSliceDevice(ID3D12Device* d3d12Device, SharedResourceRegistry& sharedResourceRegistry)
+        : m_d3d12Device(d3d12Device), m_sharedResourceRegistry(sharedResourceRegistry) {
+    }
+
+    Key KeyOf(const TextureArrayDesc& desc) const {
+        return {desc.width, desc.height, desc.mipLevels, desc.format};
+    }
+
+    Slice CreateSlice(const TextureArrayDesc& desc) {
+        D3D12_RESOURCE_DESC sliceTextureDesc = ToD3D12(desc);
+        sliceTextureDesc.DepthOrArraySize = 1;
+
+        D3D12_HEAP_PROPERTIES heapProperties;
+        heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+        heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        heapProperties.CreationNodeMask = 0;
+        heapProperties.VisibleNodeMask = 0;
+
+        D3D12_CLEAR_VALUE clearValue{};
+        clearValue.Format = desc.format;
+
+        Slice slice;
+        winrt::check_hresult(m_d3d12Device->CreateCommittedResource(&heapProperties,
+                                                                    D3D12_HEAP_FLAG_SHARED,
+                                                                    &sliceTextureDesc,
+                                                                    D3D12_RESOURCE_STATE_COPY_DEST,
+                                                                    &clearValue,
+                                                                    winrt::guid_of<ID3D12Resource>(),
+                                                                    slice.d3d12Texture.put_void()));
+        slice.d3d11Texture = m_sharedResourceRegistry.OpenOnD3D11(slice.d3d12Texture.get());
+        return slice;
+    }
+
+    void DestroySlice(Slice& slice) {
+        m_sharedResourceRegistry.Release(slice.d3d12Texture.get());
+    }
+
+private:
+    ID3D12Device* m_d3d12Device;
+    SharedResourceRegistry& m_sharedResourceRegistry;
+};
+
+// Recycles shared single-slice intermediates. An intermediate is handed out again only after the fence value of its
+// last use has retired; callers release it once the D3D11 side is done reading from it too.
+class SharedSlicePool : public FencedSlicePool<D3D12SharedSliceDevice, D3D12QueueSync> {
+public:
+    SharedSlicePool(ID3D12Device* d3d12Device, D3D12QueueSync& queueSync, SharedResourceRegistry& sharedResourceRegistry)
+        : FencedSlicePool(queueSync, d3d12Device, sharedResourceRegistry) {
+    }
+};
+
+// Copies up to slicesPerSubmit array slices into as many pooled intermediates with a single submit, then reads them
+// back through D3D11. A batch's D3D11 readback stays in flight while the next batch is copied on D3D12, and is only
+// polled to completion once that batch's readback has been issued.
+std::vector<VerifyResult> TryIntermediateTextureCopyFromD3D12ToD3D11(ID3D11Device5* d3d11Device,
+                                                                     D3D12CommandContextRing& commandRing,
+                                                                     D3D12CopyQueue* copyQueue,
+                                                                     SharedSlicePool& sharedSlicePool,
+                                                                     D3D11StagingPool& stagingPool,
+                                                                     D3D12StateTracker& stateTracker,
+                                                                     ID3D11Texture2D* d3d11Texture,
+                                                                     ID3D12Resource* d3d12Texture,
+                                                                     const TextureArrayDesc& desc,
+                                                                     const uint32_t expectedRgbas[],
+                                                                     uint32_t slicesPerSubmit,
+                                                                     const GpuTimers* gpuTimers = nullptr) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+
+    winrt::com_ptr<ID3D11DeviceContext> deviceContext;
+    d3d11Device->GetImmediateContext(deviceContext.put());
+
+    D3D11_TEXTURE2D_DESC colorDesc;
+    d3d11Texture->GetDesc(&colorDesc);
+
+    struct Batch {
+        std::vector<SharedSlicePool::Slice> intermediates;
+        winrt::com_ptr<ID3D11Texture2D> staging;
+        std::unique_ptr<D3D11StagingReadback> readback;
+        uint64_t fenceValue = 0;
+    };
+
+    const auto finishBatch = [&](Batch& batch) {
+        while (!batch.readback->Poll([&](uint32_t subres, const D3D11_MAPPED_SUBRESOURCE& mappedRes) {
+            const uint32_t mip = desc.MipOf(subres);
+            ret[subres] = VerifySurface(
+                mappedRes.pData, mappedRes.RowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[desc.SliceOf(subres)]);
+        })) {
+            SwitchToThread();
+        }
+        batch.readback.reset();
+        stagingPool.Release(std::move(batch.staging));
+
+        // The D3D11 reads are done once the maps returned, so the D3D12 fence value is the last use
+        for (auto& intermediate : batch.intermediates) {
+            sharedSlicePool.Release(std::move(intermediate), desc, batch.fenceValue);
+        }
+    };
+
+    std::unique_ptr<Batch> inFlight;
+    for (uint32_t firstSlice = 0; firstSlice < desc.arraySize; firstSlice += slicesPerSubmit) {
+        const uint32_t numSlices = std::min(slicesPerSubmit, desc.arraySize - firstSlice);
+
+        auto batch = std::make_unique<Batch>();
+        std::vector<SharedSlicePool::Slice>& intermediates = batch->intermediates;
+        for (uint32_t i = 0; i < numSlices; ++i) {
+            intermediates.push_back(sharedSlicePool.Acquire(desc));
+        }
+
+        ID3D12GraphicsCommandList* d3d12CmdList = commandRing.Begin();
+
+        // Only the slices of this batch leave RENDER_TARGET on the direct queue
+        const auto transitionBatch = [&](D3D12_RESOURCE_STATES state) {
+            for (uint32_t i = 0; i < numSlices; ++i) {
+                for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+                    stateTracker.Transition(d3d12Texture, desc.Subresource(mip, firstSlice + i), state);
+                }
+            }
+            stateTracker.Flush(d3d12CmdList);
+        };
+
+        ID3D12GraphicsCommandList* copyCmdList = d3d12CmdList;
+        if (copyQueue != nullptr) {
+            copyQueue->AcquireFrom(commandRing, stateTracker, d3d12Texture);
+            copyCmdList = copyQueue->CmdList();
+        } else {
+            transitionBatch(D3D12_RESOURCE_STATE_COPY_SOURCE);
+        }
+
+        // Timestamps on a copy queue need a query heap of their own, so only the direct queue copies are timed
+        D3D12GpuTimer* d3d12Timer = (gpuTimers && (copyQueue == nullptr)) ? gpuTimers->d3d12 : nullptr;
+        const uint32_t copyScope =
+            d3d12Timer ? d3d12Timer->Begin(copyCmdList, "CopyTextureRegion to intermediates") : D3D12GpuTimer::InvalidScope;
+        for (uint32_t i = 0; i < numSlices; ++i) {
+            for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+                D3D12_TEXTURE_COPY_LOCATION src;
+                src.pResource = d3d12Texture;
+                src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                src.SubresourceIndex = desc.Subresource(mip, firstSlice + i);
+
+                D3D12_TEXTURE_COPY_LOCATION dst;
+                dst.pResource = intermediates[i].d3d12Texture.get();
+                dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+                dst.SubresourceIndex = mip;
+
+                copyCmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+            }
+        }
+        if (d3d12Timer != nullptr) {
+            d3d12Timer->End(copyCmdList, copyScope);
+        }
+
+        if (copyQueue != nullptr) {
+            const uint64_t copyValue = copyQueue->Submit();
+            copyQueue->ReturnTo(commandRing, stateTracker, d3d12Texture, D3D12_RESOURCE_STATE_RENDER_TARGET, copyValue);
+            copyQueue->Sync().WaitFor(copyValue);
+            // Tags the intermediates' last use on the direct queue's timeline, which the pool waits on
+            commandRing.Sync().Signal();
+        } else {
+            transitionBatch(D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+            commandRing.Sync().WaitFor(commandRing.Submit());
+        }
+        batch->fenceValue = commandRing.Sync().LastSignaled();
+
+        batch->staging = stagingPool.Acquire(colorDesc);
+        ID3D11Texture2D* capturedCpuColorBuffer = batch->staging.get();
+
+        D3D11GpuTimer* d3d11Timer = gpuTimers ? gpuTimers->d3d11 : nullptr;
+        const uint32_t d3d11CopyScope = d3d11Timer ? d3d11Timer->Begin("CopySubresourceRegion from intermediates") : 0;
+        std::vector<uint32_t> batchSubresources;
+        for (uint32_t i = 0; i < numSlices; ++i) {
+            for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+                const uint32_t subres = desc.Subresource(mip, firstSlice + i);
+                deviceContext->CopySubresourceRegion(
+                    capturedCpuColorBuffer, subres, 0, 0, 0, intermediates[i].d3d11Texture.get(), mip, nullptr);
+                batchSubresources.push_back(subres);
+            }
+        }
+        if (d3d11Timer != nullptr) {
+            d3d11Timer->End(d3d11CopyScope);
+        }
+
+        batch->readback = std::make_unique<D3D11StagingReadback>(deviceContext.get(), capturedCpuColorBuffer);
+        batch->readback->Issue(std::move(batchSubresources));
+
+        if (inFlight) {
+            finishBatch(*inFlight);
+        }
+        inFlight = std::move(batch);
+    }
+    if (inFlight) {
+        finishBatch(*inFlight);
+    }
+
+    return ret;
+}
+
+std::vector<VerifyResult> TryDirectlyShareFromD3D12ToD3D11(ID3D11Device5* d3d11Device,
+                                                           D3D11StagingPool& stagingPool,
+                                                           ID3D11Texture2D* d3d11Texture,
+                                                           const TextureArrayDesc& desc,
+                                                           const uint32_t expectedRgbas[]) {
+    std::vector<VerifyResult> ret(desc.NumSubresources());
+
+    D3D11_TEXTURE2D_DESC colorDesc;
+    d3d11Texture->GetDesc(&colorDesc);
+    winrt::com_ptr<ID3D11Texture2D> capturedCpuColorBuffer = stagingPool.Acquire(colorDesc);
+
+    winrt::com_ptr<ID3D11DeviceContext> deviceContext;
+    d3d11Device->GetImmediateContext(deviceContext.put());
+
+    D3D11StagingReadback readback(deviceContext.get(), capturedCpuColorBuffer.get());
+    readback.CopyFrom(d3d11Texture);
+
+    // The CPU is free to do other work between polls
+    while (!readback.Poll([&](uint32_t subres, const D3D11_MAPPED_SUBRESOURCE& mappedRes) {
+        const uint32_t mip = desc.MipOf(subres);
+        ret[subres] = VerifySurface(
+            mappedRes.pData, mappedRes.RowPitch, desc.MipWidth(mip), desc.MipHeight(mip), expectedRgbas[desc.SliceOf(subres)]);
+    })) {
+        SwitchToThread();
+    }
+
+    stagingPool.Release(std::move(capturedCpuColorBuffer));
+
+    return ret;
+}
+
+// The fence of a CrossApiTimeline: created on D3D11 and opened on D3D12 through a shared handle
+class D3D11D3D12SharedFence {
+public:
+    D3D11D3D12SharedFence(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) {
+        winrt::check_hresult(
+            d3d11Device->CreateFence(0, D3D11_FENCE_FLAG_SHARED, winrt::guid_of<ID3D11Fence>(), m_d3d11Fence.put_void()));
+
+        HANDLE d3d12FenceSharedFromD3d11;
+        winrt::check_hresult(m_d3d11Fence->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, &d3d12FenceSharedFromD3d11));
+        winrt::handle sharedHandle(d3d12FenceSharedFromD3d11);
+        winrt::check_hresult(d3d12Device->OpenSharedHandle(sharedHandle.get(), __uuidof(ID3D12Fence), m_d3d12Fence.put_void()));
+
+        winrt::com_ptr<ID3D11DeviceContext> d3d11Context;
+        d3d11Device->GetImmediateContext(d3d11Context.put());
+        m_d3d11Context = d3d11Context.as<ID3D11DeviceContext4>();
+    }
+
+    void SignalOnD3D12(ID3D12CommandQueue* d3d12CmdQueue, uint64_t value) {
+        winrt::check_hresult(d3d12CmdQueue->Signal(m_d3d12Fence.get(), value));
+    }
+
+    void WaitOnD3D12(ID3D12CommandQueue* d3d12CmdQueue, uint64_t value) {
+        winrt::check_hresult(d3d12CmdQueue->Wait(m_d3d12Fence.get(), value));
+    }
+
+    void SignalOnD3D11(uint64_t value) {
+        winrt::check_hresult(m_d3d11Context->Signal(m_d3d11Fence.get(), value));
+    }
+
+    void WaitOnD3D11(uint64_t value) {
+        winrt::check_hresult(m_d3d11Context->Wait(m_d3d11Fence.get(), value));
+    }
+
+    void FlushD3D11() {
+        m_d3d11Context->Flush();
+    }
+
+    uint64_t CompletedValue() const {
+        return m_d3d12Fence->GetCompletedValue();
+    }
+
+private:
+    winrt::com_ptr<ID3D11Fence> m_d3d11Fence;
+    winrt::com_ptr<ID3D12Fence> m_d3d12Fence;
+    winrt::com_ptr<ID3D11DeviceContext4> m_d3d11Context;
+};
+
+// A fence created on D3D11 and opened on D3D12 that orders access to shared resources between the two devices on the
+// GPU timeline
+class CrossApiFence : public CrossApiTimeline<D3D11D3D12SharedFence> {
+public:
+    CrossApiFence(ID3D11Device5* d3d11Device, ID3D12Device* d3d12Device) : CrossApiTimeline(d3d11Device, d3d12Device) {
+    }
+};
+
+std::vector<VerifyResult> TryShareD3D11FenceToD3D12(ID3D11Device5* d3d11Device,
+                                                    D3D11StagingPool& stagingPool,
+                                                    ID3D12CommandQueue* d3d12CmdQueue,
+                                                    CrossApiFence& crossApiFence,
+                                                    ID3D11Texture2D* d3d11Texture,
+                                                    const TextureArrayDesc& desc,
+                                                    const uint32_t expectedRgbas[]) {
+    // D3D12 is the producer, D3D11 reads only after the D3D12 queue has finished writing
+    crossApiFence.D3D12ToD3D11(d3d12CmdQueue);
+
+    std::vector<VerifyResult> ret = TryDirectlyShareFromD3D12ToD3D11(d3d11Device, stagingPool, d3d11Texture, desc, expectedRgbas);
+
+    // Hand the array back so later D3D12 writes can't overtake the D3D11 reads
+    crossApiFence.D3D11ToD3D12(d3d12CmdQueue);
+
+    return ret;
+}
+
+void TryIUnknownCasting(ID3D11Device* d3d11device, ID3D12Device* d3d12device) {
+    std::cout << "Try back casting d3d12 device from IUnknown" << std::endl;
+    {
+        IUnknown* deviceIUnknown = d3d12device;
+        winrt::com_ptr<ID3D12Device> deviceBackCast;
+        deviceIUnknown->QueryInterface(__uuidof(ID3D12Device), deviceBackCast.put_void());
+
+        if (deviceBackCast.get() != d3d12device) {
+            std::cout << "FAILED..." << std::endl;
+        } else {
+            std::cout << "succeeded!" << std::endl;
+        }
+    }
+
+    std::cout << "Try back casting d3d11 device from IUnknown" << std::endl;
+    {
+        IUnknown* deviceIUnknown = d3d11device;
+        winrt::com_ptr<ID3D11Device> deviceBackCast;
+        deviceIUnknown->QueryInterface(__uuidof(ID3D11Device), deviceBackCast.put_void());
+
+        if (deviceBackCast.get() != d3d11device) {
+            std::cout << "FAILED..." << std::endl;
+        } else {
+            std::cout << "succeeded!" << std::endl;
+        }
+    }
+}
+
+// The texture's states stay in the caller's tracker, so the transitions made on the other device are the ones every
+// later path on the first device sees. The caller's work on the texture has to be finished.
+void TryD3D12ImplicitResourceSharing(D3D12DevicePool& devicePool,
+                                     const D3D12DeviceKey& deviceKey,
+                                     D3D12StateTracker& stateTracker,
+                                     ID3D12Resource* d3d12Texture,
+                                     const TextureArrayDesc& desc) {
+    std::unique_ptr<D3D12DeviceContext> context = devicePool.Acquire(deviceKey);
+    D3D12CommandContextRing& commandRing = *context->commandRing;
+
+    // Try modify the barrier of texture created from the first device
+    {
+        for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+            stateTracker.Transition(d3d12Texture, subres, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        }
+        stateTracker.Flush(commandRing.Begin());
+        commandRing.Sync().WaitFor(commandRing.Submit());
+    }
+    {
+        for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+            stateTracker.Transition(d3d12Texture, subres, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        }
+        stateTracker.Flush(commandRing.Begin());
+        commandRing.Sync().WaitFor(commandRing.Submit());
+    }
+
+    devicePool.Release(std::move(context));
+
+    std::cout << "succeeded!\n";
+}
+
+// Without a report every path prints its per-subresource results. With one, the first `warmupIterations` runs are
+// discarded and the rest are recorded as latency samples.
+void TextureArrayTest(ID3D11Device5* d3d11Device,
+                      ID3D12Device* d3d12Device,
+                      D3D12DevicePool& devicePool,
+                      const D3D12DeviceKey& secondaryDeviceKey,
+                      const D3D12CapabilitySnapshot& capabilities,
+                      const TextureArrayDesc& desc,
+                      uint32_t iterations = 10,
+                      uint32_t warmupIterations = 0,
+                      BenchmarkReport* report = nullptr,
+                      InteropPathSelector* pathSelector = nullptr) {
+    // Every path clears the array as a render target, multisampled ones are resolved before readback
+    const D3D12_FEATURE_DATA_FORMAT_SUPPORT* formatSupport = capabilities.FormatSupport(desc.format);
+    if ((formatSupport == nullptr) || !(formatSupport->Support1 & D3D12_FORMAT_SUPPORT1_RENDER_TARGET) ||
+        (desc.Multisampled() && !(formatSupport->Support1 & D3D12_FORMAT_SUPPORT1_MULTISAMPLE_RESOLVE))) {
+        std::cout << "Skipping " << FormatName(desc.format) << " arrays, the device can't render to or resolve them\n\n";
+        return;
+    }
+
+    winrt::com_ptr<ID3D12CommandQueue> d3d12CmdQueue;
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    winrt::check_hresult(d3d12Device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), d3d12CmdQueue.put_void()));
+    D3D12QueueSync d3d12QueueSync(d3d12Device, d3d12CmdQueue.get());
+
+    D3D12CommandContextRing commandRing(d3d12Device, d3d12QueueSync);
+
+    SharedResourceRegistry sharedResourceRegistry(d3d11Device, d3d12Device);
+    auto [d3d11TextureSharedFromD3d12, d3d12Texture, d3d11Texture] =
+        CreateTextureArray(d3d11Device, d3d12Device, sharedResourceRegistry, desc);
+
+    // Owns the texture's state: every path transitions it here and leaves it in RENDER_TARGET for the next fill
+    D3D12StateTracker stateTracker;
+    stateTracker.Register(d3d12Texture.get(), desc.NumSubresources(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    DirtyRegionTracker dirtyRegions(desc);
+    CpuTextureMirror textureMirror(desc);
+
+    std::unique_ptr<D3D12ZeroCopyMirror> zeroCopyMirror;
+    const D3D12_FEATURE_DATA_ARCHITECTURE1& architecture = capabilities.architecture;
+    if (ZeroCopyReadbackSupported(architecture.UMA, architecture.CacheCoherentUMA) && !desc.Multisampled()) {
+        zeroCopyMirror = std::make_unique<D3D12ZeroCopyMirror>(d3d12Device, desc);
+    }
+
+    // The shared heap and the readback pipeline each hold at least one more copy of the array, so they are only
+    // created by the first run of their path. Every placement is freed after its run, so the heap fits one array.
+    std::unique_ptr<SharedHeapAllocator> sharedHeap;
+    std::unique_ptr<SharedHeapConsumer> sharedHeapConsumer;
+    std::unique_ptr<D3D12ReadbackPipeline> readbackPipeline;
+    constexpr uint32_t readbackPipelineDepth = 3;
+
+    D3D12ReadbackAllocator readbackAllocator(d3d12Device, d3d12QueueSync);
+    TransientResourceAllocator resolveTransients(d3d12Device, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES);
+    CrossApiFence crossApiFence(d3d11Device, d3d12Device);
+    SharedSlicePool sharedSlicePool(d3d12Device, d3d12QueueSync, sharedResourceRegistry);
+    D3D11StagingPool stagingPool(d3d11Device);
+    RenderTargetViewCache rtvCache(d3d12Device);
+    D3D12CopyQueue copyQueue(d3d12Device);
+    D3D12ParallelRecorder parallelRecorder(d3d12Device, commandRing, std::thread::hardware_concurrency());
+    D3D12GpuTimer d3d12GpuTimer(d3d12Device, d3d12QueueSync);
+    D3D11GpuTimer d3d11GpuTimer(d3d11Device);
+    const GpuTimers gpuTimers = {&d3d12GpuTimer, &d3d11GpuTimer};
+
+    // Picked on the first iteration; empty while every candidate runs
+    std::string selectedPath;
+
+    std::vector<XMFLOAT4> sliceColors;
+    std::vector<uint32_t> sliceRgbas;
+
+    for (uint32_t test = 0; test < iterations; ++test) {
+        if (report == nullptr) {
+            std::cout << "================================== Test " << test << " ==================================\n\n";
+        }
+
+        d3d11GpuTimer.BeginFrame();
+
+        // After the first fill every other slice gets a new color, alternating between iterations, so only the slices
+        // that changed are cleared and dirty, and every slice still changes every second iteration
+        std::vector<XMFLOAT4> newColors;
+        std::vector<uint32_t> newRgbas;
+        RandomSliceColors(desc, newColors, newRgbas);
+        std::vector<uint32_t> changedSlices;
+        for (uint32_t slice = 0; slice < desc.arraySize; ++slice) {
+            if ((test == 0) || (slice % 2 == test % 2)) {
+                changedSlices.push_back(slice);
+            }
+        }
+        sliceColors.resize(desc.arraySize);
+        sliceRgbas.resize(desc.arraySize);
+        for (uint32_t slice : changedSlices) {
+            sliceColors[slice] = newColors[slice];
+            sliceRgbas[slice] = newRgbas[slice];
+        }
+
+        // Odd iterations record the clears on the worker threads
+        FillTextureArray(rtvCache,
+                         (test % 2) ? &parallelRecorder : nullptr,
+                         commandRing,
+                         d3d12Texture.get(),
+                         d3d11Texture.get(),
+                         desc,
+                         sliceColors.data(),
+                         changedSlices,
+                         &dirtyRegions,
+                         &gpuTimers);
+
+        // Runs one interop path. In benchmark mode the call is timed, samples past the warm-up are recorded and only
+        // failures are printed.
+        const auto runPath = [&](const char* id, const std::string& title, const std::function<std::vector<VerifyResult>()>& path) {
+            if (report == nullptr) {
+                std::cout << title << "\n";
+                PrintResult(desc, path());
+                std::cout << "\n";
+                return;
+            }
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            const std::vector<VerifyResult> result = path();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+            if (test >= warmupIterations) {
+                report->Record(id, desc, elapsed.count());
+            }
+
+            for (const auto& subres : result) {
+                if (!subres.Passed()) {
+                    std::cout << title << "\n";
+                    PrintResult(desc, result);
+                    std::cout << "\n";
+                    break;
+                }
+            }
+        };
+
+        if (desc.Multisampled()) {
+            runPath("transient_resolve_readback_d3d12", "Resolve into aliased transient textures and read those back", [&] {
+                return TryTransientResolveReadbackFromD3D12(d3d12Device,
+                                                            commandRing,
+                                                            resolveTransients,
+                                                            readbackAllocator,
+                                                            stateTracker,
+                                                            d3d12Texture.get(),
+                                                            desc,
+                                                            sliceRgbas.data());
+            });
+
+            std::cout << "Multisampled arrays cannot be copied to readback memory without a resolve, skipping the other readback tests\n\n";
+        } else {
+            // The three ways production moves the array; the selector picks one of them
+            const auto directCopy = [&] {
+                return TryDirectlyCopyFromD3D12ToD3D12(d3d12Device,
+                                                       commandRing,
+                                                       readbackAllocator,
+                                                       stateTracker,
+                                                       d3d12Texture.get(),
+                                                       desc,
+                                                       sliceRgbas.data());
+            };
+            const auto intermediateCopy = [&] {
+                return TryIntermediateTextureCopyFromD3D12ToD3D11(d3d11Device,
+                                                                  commandRing,
+                                                                  nullptr,
+                                                                  sharedSlicePool,
+                                                                  stagingPool,
+                                                                  stateTracker,
+                                                                  d3d11TextureSharedFromD3d12.get(),
+                                                                  d3d12Texture.get(),
+                                                                  desc,
+                                                                  sliceRgbas.data(),
+                                                                  1,
+                                                                  &gpuTimers);
+            };
+            const auto directShare = [&] {
+                return TryDirectlyShareFromD3D12ToD3D11(
+                    d3d11Device, stagingPool, d3d11TextureSharedFromD3d12.get(), desc, sliceRgbas.data());
+            };
+
+            if ((pathSelector != nullptr) && (test == 0)) {
+                const InteropPathSelector::Selection selection = pathSelector->Select(desc,
+                                                                                      {{"direct_copy_d3d12", directCopy},
+                                                                                       {"intermediate_copy_d3d11", intermediateCopy},
+                                                                                       {"direct_share_d3d11", directShare}});
+                for (const auto& measurement : selection.measurements) {
+                    std::cout << "Path " << measurement.id << ": ";
+                    if (measurement.correct) {
+                        std::cout << measurement.medianMs << " ms\n";
+                    } else {
+                        std::cout << "incorrect\n";
+                    }
+                }
+                std::cout << "Selected path: " << (selection.id.empty() ? "none" : selection.id)
+                          << (selection.fromCache ? " (cached)" : "") << "\n\n";
+                selectedPath = selection.id;
+            }
+
+            // Once a path is selected it's the only candidate that runs, so the test and the report follow the decision
+            const auto runCandidate = [&](const char* id,
+                                          const std::string& title,
+                                          const std::function<std::vector<VerifyResult>()>& path) {
+                if (selectedPath.empty() || (selectedPath == id)) {
+                    runPath(id, title, path);
+                }
+            };
+
+            runCandidate("direct_copy_d3d12", "Directly copy from D3D12 texture to D3D12 texture", directCopy);
+
+            runPath("batched_copy_d3d12", "Batched copy of all slices from D3D12 texture to D3D12 texture", [&] {
+                return TryBatchedCopyFromD3D12ToD3D12(d3d12Device,
+                                                      commandRing,
+                                                      readbackAllocator,
+                                                      stateTracker,
+                                                      d3d12Texture.get(),
+                                                      desc,
+                                                      sliceRgbas.data(),
+                                                      &d3d12GpuTimer);
+            });
+
+            runPath("dirty_region_readback_d3d12", "Read back only the rectangles written since the last readback", [&] {
+                return TryDirtyRegionReadbackFromD3D12(commandRing,
+                                                       readbackAllocator,
+                                                       stateTracker,
+                                                       dirtyRegions,
+                                                       textureMirror,
+                                                       d3d12Texture.get(),
+                                                       desc,
+                                                       sliceRgbas.data());
+            });
+
+            runPath("overlay_dirty_region_readback_d3d12", "Update an overlay region and read back only that region", [&] {
+                UpdateOverlayRegion(rtvCache, commandRing.Begin(), dirtyRegions, d3d12Texture.get(), desc, sliceColors.data());
+                return TryDirtyRegionReadbackFromD3D12(commandRing,
+                                                       readbackAllocator,
+                                                       stateTracker,
+                                                       dirtyRegions,
+                                                       textureMirror,
+                                                       d3d12Texture.get(),
+                                                       desc,
+                                                       sliceRgbas.data());
+            });
+
+            if (zeroCopyMirror) {
+                runPath("zero_copy_readback_d3d12", "Read back through a cache coherent UMA mirror without staging", [&] {
+                    return TryZeroCopyReadbackFromD3D12(commandRing,
+                                                        stateTracker,
+                                                        *zeroCopyMirror,
+                                                        d3d12Texture.get(),
+                                                        desc,
+                                                        sliceRgbas.data());
+                });
+            } else if (report == nullptr) {
+                std::cout << "Zero-copy readback needs a cache coherent UMA adapter (UMA " << capabilities.architecture.UMA
+                          << ", CacheCoherentUMA " << capabilities.architecture.CacheCoherentUMA << "), skipping\n\n";
+            }
+
+            runPath("parallel_copy_d3d12",
+                    "Record copies of all slices on " + std::to_string(parallelRecorder.NumThreads()) + " threads",
+                    [&] {
+                        return TryParallelCopyFromD3D12ToD3D12(d3d12Device,
+                                                               commandRing,
+                                                               parallelRecorder,
+                                                               readbackAllocator,
+                                                               stateTracker,
+                                                               d3d12Texture.get(),
+                                                               desc,
+                                                               sliceRgbas.data());
+                    });
+
+            runPath("copy_queue_d3d12", "Copy all slices to D3D12 readback memory on the copy queue", [&] {
+                return TryCopyQueueReadbackFromD3D12(d3d12Device,
+                                                     commandRing,
+                                                     copyQueue,
+                                                     stateTracker,
+                                                     d3d12Texture.get(),
+                                                     desc,
+                                                     sliceRgbas.data());
+            });
+
+            runPath("pipelined_readback_d3d12",
+                    "Pipelined readback with " + std::to_string(readbackPipelineDepth) + " frames in flight",
+                    [&] {
+                        if (!readbackPipeline) {
+                            readbackPipeline =
+                                std::make_unique<D3D12ReadbackPipeline>(d3d12Device, commandRing, ToD3D12(desc), readbackPipelineDepth);
+                        }
+                        return TryPipelinedReadbackFromD3D12(
+                            *readbackPipeline, stateTracker, d3d12Texture.get(), desc, sliceRgbas.data(), 8);
+                    });
+
+            runPath("shared_heap_placed_d3d12", "Place in a shared heap and read back through the consumer's placed view", [&] {
+                if (!sharedHeap) {
+                    const D3D12_RESOURCE_DESC placedDesc = ToD3D12(desc);
+                    const D3D12_RESOURCE_ALLOCATION_INFO placedInfo = d3d12Device->GetResourceAllocationInfo(0, 1, &placedDesc);
+                    // Producer and consumer both place render targets, which any heap tier can keep in one heap
+                    sharedHeap = std::make_unique<SharedHeapAllocator>(
+                        d3d12Device, placedInfo.SizeInBytes, D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+                    sharedHeapConsumer =
+                        std::make_unique<SharedHeapConsumer>(devicePool, secondaryDeviceKey, sharedHeap->SharedHandle());
+                }
+
+                SharedHeapAllocator::Placement placement =
+                    sharedHeap->Place(ToD3D12(desc), D3D12_RESOURCE_STATE_RENDER_TARGET, nullptr);
+                const std::vector<VerifyResult> result = TrySharedHeapPlacementFromD3D12(commandRing,
+                                                                                         rtvCache,
+                                                                                         *sharedHeapConsumer,
+                                                                                         placement,
+                                                                                         desc,
+                                                                                         sliceColors.data(),
+                                                                                         sliceRgbas.data());
+                rtvCache.Release(placement.resource.get());
+                sharedHeapConsumer->Close(placement.offset);
+                sharedHeap->Free(placement);
+                return result;
+            });
+
+            runCandidate("intermediate_copy_d3d11", "Take a intermediate texture to copy to D3D11 texture", intermediateCopy);
+
+            runPath("pooled_intermediate_copy_d3d11",
+                    "Take pooled intermediate textures for all slices in one submit to copy to D3D11 texture",
+                    [&] {
+                        return TryIntermediateTextureCopyFromD3D12ToD3D11(d3d11Device,
+                                                                          commandRing,
+                                                                          nullptr,
+                                                                          sharedSlicePool,
+                                                                          stagingPool,
+                                                                          stateTracker,
+                                                                          d3d11TextureSharedFromD3d12.get(),
+                                                                          d3d12Texture.get(),
+                                                                          desc,
+                                                                          sliceRgbas.data(),
+                                                                          desc.arraySize,
+                                                                          &gpuTimers);
+                    });
+
+            runPath("copy_queue_intermediate_copy_d3d11",
+                    "Take pooled intermediate textures for all slices on the copy queue to copy to D3D11 texture",
+                    [&] {
+                        return TryIntermediateTextureCopyFromD3D12ToD3D11(d3d11Device,
+                                                                          commandRing,
+                                                                          &copyQueue,
+                                                                          sharedSlicePool,
+                                                                          stagingPool,
+                                                                          stateTracker,
+                                                                          d3d11TextureSharedFromD3d12.get(),
+                                                                          d3d12Texture.get(),
+                                                                          desc,
+                                                                          sliceRgbas.data(),
+                                                                          desc.arraySize,
+                                                                          &gpuTimers);
+                    });
+
+            runCandidate("direct_share_d3d11", "Directly share to D3D11 texture", directShare);
+
+            runPath("fence_share_d3d11", "Share D3D11 fence to D3D12 and order D3D11 reads after D3D12 writes on the GPU", [&] {
+                return TryShareD3D11FenceToD3D12(d3d11Device,
+                                                 stagingPool,
+                                                 d3d12CmdQueue.get(),
+                                                 crossApiFence,
+                                                 d3d11TextureSharedFromD3d12.get(),
+                                                 desc,
+                                                 sliceRgbas.data());
+            });
+        }
+
+        if (report == nullptr) {
+            TryIUnknownCasting(d3d11Device, d3d12Device);
+            std::cout << "\n";
+        }
+
+        // Reports no per-texel results, so only its latency is of interest
+        runPath("implicit_sharing_d3d12", "Try modify states of resource created by an irrelevant D3D12 device", [&] {
+            commandRing.Sync().WaitFor(commandRing.Submit());
+            TryD3D12ImplicitResourceSharing(devicePool, secondaryDeviceKey, stateTracker, d3d12Texture.get(), desc);
+            return std::vector<VerifyResult>();
+        });
+
+        // Submit whatever is still recorded, e.g. the clears of a multisampled array, so every scope can be collected
+        d3d12QueueSync.WaitFor(commandRing.Submit());
+        d3d12GpuTimer.Collect();
+
+        d3d11GpuTimer.EndFrame();
+        d3d11GpuTimer.Collect();
+    }
+
+
+#ifdef RUN_COPY_QUEUE_BENCHMARK
+    if (!desc.Multisampled()) {
+        CopyQueueOverlapBenchmark(d3d12Device,
+                                  commandRing,
+                                  copyQueue,
+                                  readbackAllocator,
+                                  stateTracker,
+                                  d3d12Texture.get(),
+                                  desc);
+    }
+#endif
+
+#ifdef RUN_PARALLEL_RECORDING_BENCHMARK
+    ParallelRecordingBenchmark(commandRing, parallelRecorder, rtvCache, stateTracker, d3d12Texture.get(), desc);
+#endif
+
+    const D3D12ReadbackAllocator::Stats& readbackStats = readbackAllocator.GetStats();
+    std::cout << "Readback allocator: " << readbackStats.numAllocations << " allocations, hit rate " << readbackStats.HitRate() * 100
+              << "%, " << readbackStats.numPagesCreated << " pages, peak " << readbackStats.peakBytesInUse << " of "
+              << readbackStats.reservedBytes << " bytes\n";
+
+    const SharedResourceRegistry::Stats& sharingStats = sharedResourceRegistry.GetStats();
+    std::cout << "Shared resources: " << sharingStats.numOpens << " opens, " << sharingStats.numHits << " cache hits, "
+              << sharingStats.numLiveHandles << " live handles\n";
+
+    const SharedSlicePool::Stats& slicePoolStats = sharedSlicePool.GetStats();
+    std::cout << "Intermediate slice pool: " << slicePoolStats.numAcquires << " acquires, " << slicePoolStats.numCreated << " created\n";
+
+    const D3D11StagingPool::Stats& stagingPoolStats = stagingPool.GetStats();
+    std::cout << "Staging pool: " << stagingPoolStats.numAcquires << " acquires, " << stagingPoolStats.numCreated << " created\n";
+
+    const RenderTargetViewCache::Stats& rtvStats = rtvCache.GetStats();
+    const D3D12DescriptorAllocator::Stats descriptorStats = rtvCache.GetDescriptorStats();
+    std::cout << "RTV cache: " << rtvStats.numLookups << " lookups, " << rtvStats.numCreated << " views created, "
+              << descriptorStats.peakLive << " peak descriptors in " << descriptorStats.numHeaps << " heap(s) of "
+              << descriptorStats.capacity << "\n";
+
+    uint64_t texelsPerSync = 0;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+        texelsPerSync += static_cast<uint64_t>(desc.MipWidth(mip)) * desc.MipHeight(mip) * desc.arraySize;
+    }
+    const CpuTextureMirror::Stats& mirrorStats = textureMirror.GetStats();
+    std::cout << "Dirty region readback: " << mirrorStats.texelsPatched << " texels copied over " << mirrorStats.numSyncs
+              << " syncs, full readbacks would copy " << mirrorStats.numSyncs * texelsPerSync << "\n";
+
+    const D3D12CommandContextRing::Stats& ringStats = commandRing.GetStats();
+    std::cout << "Command context ring: " << ringStats.numSubmits << " submits, " << ringStats.numStalls
+              << " stalls waiting for a context\n";
+
+    const D3D12StateTracker::Stats& trackerStats = stateTracker.GetStats();
+    std::cout << "State tracker: " << trackerStats.numTransitions << " transitions, " << trackerStats.numBarriers << " barriers in "
+              << trackerStats.numBarrierCalls << " calls\n";
+
+    // Across every test sharing the pool, so later tests show the secondary device reused
+    const D3D12DevicePool::Stats& devicePoolStats = devicePool.GetStats();
+    std::cout << "Device pool: " << devicePoolStats.numAcquires << " acquires, " << devicePoolStats.numDevicesCreated
+              << " device(s) created in "
+              << devicePoolStats.AverageDeviceCreateMs() << " ms on average (max " << devicePoolStats.maxDeviceCreateMs << " ms), "
+              << devicePoolStats.numContextsCreated << " context(s) created\n";
+
+    const TransientResourceAllocator::Stats& transientStats = resolveTransients.GetStats();
+    if (transientStats.heapSize > 0) {
+        std::cout << "Transient resolve targets: " << transientStats.heapSize << " byte heap for " << transientStats.peakUnaliasedSize
+                  << " bytes of transients, " << transientStats.numAliasingBarriers << " aliasing barriers, "
+                  << transientStats.numHeapsCreated << " heap(s) and " << transientStats.numPlacedResourcesCreated
+                  << " placed resource(s) created\n";
+    }
+
+    if (sharedHeap) {
+        const SharedHeapAllocator::Stats heapStats = sharedHeap->GetStats();
+        std::cout << "Shared heap: " << heapStats.numPlacements << " placements, peak " << heapStats.peakBytesInUse << " of "
+                  << heapStats.heapSize << " bytes, utilization " << heapStats.Utilization() * 100 << "%, fragmentation "
+                  << heapStats.Fragmentation() * 100 << "% over " << heapStats.numFreeRanges << " free range(s)\n";
+    }
+
+    PrintGpuScopes("D3D12", d3d12GpuTimer.GetStats());
+    PrintGpuScopes("D3D11", d3d11GpuTimer.GetStats());
+}
+
+// The D3D12 paths behind the backend interface. Textures are read back through one batched copy per call and commands
+// are recorded through a command context ring on the backend's own queue. Every texture is registered with the
+// backend's state tracker and is only transitioned when an operation needs another state, not returned to a resting
+// state after each one.
+class D3D12InteropBackend : public InteropBackend {
+public:
+    explicit D3D12InteropBackend(ID3D12Device* device) {
+        m_device.copy_from(device);
+
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        winrt::check_hresult(device->CreateCommandQueue(&queueDesc, winrt::guid_of<ID3D12CommandQueue>(), m_cmdQueue.put_void()));
+        m_queueSync = std::make_unique<D3D12QueueSync>(device, m_cmdQueue.get());
+
+        m_commandRing = std::make_unique<D3D12CommandContextRing>(device, *m_queueSync);
+
+        m_rtvCache = std::make_unique<RenderTargetViewCache>(device);
+        m_readbackAllocator = std::make_unique<D3D12ReadbackAllocator>(device, *m_queueSync);
+    }
+
+    ~D3D12InteropBackend() override {
+        m_queueSync->WaitFor(m_queueSync->LastSignaled());
+    }
+
+    const char* Name() const override {
+        return "d3d12";
+    }
+
+    TextureId CreateTextureArray(const TextureArrayDesc& desc) override {
+        D3D12_RESOURCE_DESC textureDesc = ToD3D12(desc);
+        D3D12_HEAP_PROPERTIES heapProp = {D3D12_HEAP_TYPE_DEFAULT, D3D12_CPU_PAGE_PROPERTY_UNKNOWN, D3D12_MEMORY_POOL_UNKNOWN, 0, 0};
+        D3D12_CLEAR_VALUE clearValue{};
+        clearValue.Format = textureDesc.Format;
+
+        Texture texture;
+        texture.desc = desc;
+        winrt::check_hresult(m_device->CreateCommittedResource(&heapProp,
+                                                               D3D12_HEAP_FLAG_SHARED,
+                                                               &textureDesc,
+                                                               D3D12_RESOURCE_STATE_RENDER_TARGET,
+                                                               &clearValue,
+                                                               winrt::guid_of<ID3D12Resource>(),
+                                                               texture.resource.put_void()));
+        m_stateTracker.Register(texture.resource.get(), desc.NumSubresources(), D3D12_RESOURCE_STATE_RENDER_TARGET);
+        m_textures.push_back(std::move(texture));
+        return static_cast<TextureId>(m_textures.size() - 1);
+    }
+
+    TextureId OpenShared(TextureId texture) override {
+        winrt::handle sharedHandle;
+        winrt::check_hresult(
+            m_device->CreateSharedHandle(m_textures[texture].resource.get(), nullptr, GENERIC_ALL, nullptr, sharedHandle.put()));
+
+        Texture opened;
+        opened.desc = m_textures[texture].desc;
+        winrt::check_hresult(
+            m_device->OpenSharedHandle(sharedHandle.get(), winrt::guid_of<ID3D12Resource>(), opened.resource.put_void()));
+        // An opened shared resource starts out in COMMON
+        m_stateTracker.Register(opened.resource.get(), opened.desc.NumSubresources(), D3D12_RESOURCE_STATE_COMMON);
+        m_textures.push_back(std::move(opened));
+        return static_cast<TextureId>(m_textures.size() - 1);
+    }
+
+    void Clear(TextureId texture, uint32_t subres, const DirectX::XMFLOAT4& color) override {
+        const Texture& target = m_textures[texture];
+        const D3D12_CPU_DESCRIPTOR_HANDLE rtv =
+            m_rtvCache->GetD3D12(target.resource.get(), target.desc.MipOf(subres), target.desc.SliceOf(subres), target.desc.format);
+        ID3D12GraphicsCommandList* cmdList = m_commandRing->Begin();
+        m_stateTracker.Transition(target.resource.get(), subres, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        m_stateTracker.Flush(cmdList);
+        cmdList->ClearRenderTargetView(rtv, &color.x, 0, nullptr);
+    }
+
+    void CopySubresource(TextureId dst, uint32_t dstSubres, TextureId src, uint32_t srcSubres) override {
+        ID3D12GraphicsCommandList* cmdList = m_commandRing->Begin();
+        m_stateTracker.Transition(m_textures[src].resource.get(), srcSubres, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        m_stateTracker.Transition(m_textures[dst].resource.get(), dstSubres, D3D12_RESOURCE_STATE_COPY_DEST);
+        m_stateTracker.Flush(cmdList);
+
+        D3D12_TEXTURE_COPY_LOCATION srcLocation;
+        srcLocation.pResource = m_textures[src].resource.get();
+        srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        srcLocation.SubresourceIndex = srcSubres;
+
+        D3D12_TEXTURE_COPY_LOCATION dstLocation;
+        dstLocation.pResource = m_textures[dst].resource.get();
+        dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dstLocation.SubresourceIndex = dstSubres;
+
+        cmdList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+    }
+
+    // Each submit retires its own allocator in the ring, so allocators are reset once their fence value passed instead
+    // of growing until the whole backend goes idle
+    uint64_t Submit() override {
+        return m_commandRing->Submit();
+    }
+
+    void WaitForFence(uint64_t value) override {
+        m_queueSync->WaitFor(value);
+    }
+
+    void ReadBack(TextureId texture, uint32_t firstSubres, uint32_t numSubres, const ReadbackFunc& consume) override {
+        const Texture& source = m_textures[texture];
+
+        D3D12_RESOURCE_DESC colorDesc = source.resource->GetDesc();
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(numSubres);
+        uint64_t requiredSize = 0;
+        m_device->GetCopyableFootprints(&colorDesc, firstSubres, numSubres, 0, layouts.data(), nullptr, nullptr, &requiredSize);
+
+        const D3D12ReadbackAllocator::Allocation readback = m_readbackAllocator->Allocate(requiredSize);
+        for (auto& layout : layouts) {
+            layout.Offset += readback.offset;
+        }
+
+        ID3D12GraphicsCommandList* cmdList = m_commandRing->Begin();
+        for (uint32_t subres = firstSubres; subres < firstSubres + numSubres; ++subres) {
+            m_stateTracker.Transition(source.resource.get(), subres, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        }
+        m_stateTracker.Flush(cmdList);
+
+        RecordReadbackCopies(cmdList, source.resource.get(), readback, layouts, firstSubres);
+
+        const uint64_t fenceValue = Submit();
+        WaitForFence(fenceValue);
+
+        for (uint32_t i = 0; i < numSubres; ++i) {
+            consume(firstSubres + i, readback.cpuAddress + (layouts[i].Offset - readback.offset), layouts[i].Footprint.RowPitch);
+        }
+
+        m_readbackAllocator->Release(readback, fenceValue);
+    }
+
+private:
+    struct Texture {
+        TextureArrayDesc desc;
+        winrt::com_ptr<ID3D12Resource> resource;
+    };
+
+    winrt::com_ptr<ID3D12Device> m_device;
+    winrt::com_ptr<ID3D12CommandQueue> m_cmdQueue;
+    std::unique_ptr<D3D12QueueSync> m_queueSync;
+    std::unique_ptr<D3D12CommandContextRing> m_commandRing;
+    std::unique_ptr<RenderTargetViewCache> m_rtvCache;
+    std::unique_ptr<D3D12ReadbackAllocator> m_readbackAllocator;
+    D3D12StateTracker m_stateTracker;
+    std::vector<Texture> m_textures;
+};
+
+// Wall-clock phases of startup, relative to when the profile was created. Phases run on different threads may overlap.
+class StartupProfile {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    StartupProfile() : m_start(Clock::now()) {
+    }
+
+    // Records a phase that ran from `begin` until now
+    void Record(const std::string& name, Clock::time_point begin) {
+        const Clock::time_point end = Clock::now();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_phases.push_back({name,
+                            std::chrono::duration<double, std::milli>(begin - m_start).count(),
+                            std::chrono::duration<double, std::milli>(end - begin).count()});
+    }
+
+    void Print() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::cout << "Startup profile:\n";
+        double endMs = 0;
+        for (const auto& phase : m_phases) {
+            std::cout << "  " << phase.name << ": " << phase.durationMs << " ms, started at " << phase.startMs << " ms\n";
+            endMs = std::max(endMs, phase.startMs + phase.durationMs);
+        }
+        std::cout << "  total: " << endMs << " ms\n\n";
+    }
+
+private:
+    struct Phase {
+        std::string name;
+        double startMs;
+        double durationMs;
+    };
+
+    Clock::time_point m_start;
+    mutable std::mutex m_mutex;
+    std::vector<Phase> m_phases;
+};
+
+// Creates the D3D11 device on a worker thread while this thread creates the D3D12 device
+void CreateDevicesInParallel(winrt::com_ptr<ID3D11Device5>& d3d11Device,
+                             winrt::com_ptr<ID3D12Device>& d3d12Device,
+                             D3D12DeviceKey& d3d12DeviceKey,
+                             StartupProfile& profile) {
+    std::exception_ptr d3d11Error;
+    std::thread d3d11Thread([&] {
+        try {
+            const auto begin = StartupProfile::Clock::now();
+            d3d11Device = CreateD3D11Device();
+            profile.Record("CreateD3D11Device", begin);
+        } catch (...) {
+            d3d11Error = std::current_exception();
+        }
+    });
+
+    std::exception_ptr d3d12Error;
+    try {
+        const auto begin = StartupProfile::Clock::now();
+        std::tie(d3d12Device, d3d12DeviceKey) = CreateD3D12Device();
+        profile.Record("CreateD3D12Device", begin);
+    } catch (...) {
+        d3d12Error = std::current_exception();
+    }
+
+    d3d11Thread.join();
+    if (d3d11Error) {
+        std::rethrow_exception(d3d11Error);
+    }
+    if (d3d12Error) {
+        std::rethrow_exception(d3d12Error);
+    }
+}
+
+// The user mode driver version of an adapter, so cached capabilities are dropped when the driver is updated
+uint64_t QueryDriverVersion(LUID adapterLuid) {
+    winrt::com_ptr<IDXGIFactory4> dxgiFactory = CreateDXGIFactoryForD3D12();
+
+    winrt::com_ptr<IDXGIAdapter> dxgiAdapter;
+    winrt::check_hresult(dxgiFactory->EnumAdapterByLuid(adapterLuid, winrt::guid_of<IDXGIAdapter>(), dxgiAdapter.put_void()));
+
+    LARGE_INTEGER umdVersion;
+    winrt::check_hresult(dxgiAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion));
+    return static_cast<uint64_t>(umdVersion.QuadPart);
+}
+
+D3D12CapabilitySnapshot ProbeCapabilities(ID3D12Device* device, uint64_t driverVersion) {
+    D3D12CapabilitySnapshot snapshot;
+    snapshot.adapterLuid = device->GetAdapterLuid();
+    snapshot.driverVersion = driverVersion;
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS4 options4 = {};
+    winrt::check_hresult(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS4, &options4, sizeof(options4)));
+    snapshot.sharedResourceCompatibilityTier = options4.SharedResourceCompatibilityTier;
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    winrt::check_hresult(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+    snapshot.resourceHeapTier = options.ResourceHeapTier;
+
+    snapshot.architecture = QueryArchitecture(device);
+
+    // The formats the texture arrays can be created and verified with
+    const DXGI_FORMAT formats[] = {DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM};
+    for (DXGI_FORMAT format : formats) {
+        D3D12_FEATURE_DATA_FORMAT_SUPPORT support = {format};
+        if (SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT, &support, sizeof(support)))) {
+            snapshot.formats.push_back(support);
+        }
+    }
+
+    return snapshot;
+}
+
+// Conversions to and from the plain-integer record CapabilityCache persists
+CapabilityRecord ToCapabilityRecord(const D3D12CapabilitySnapshot& snapshot) {
+    CapabilityRecord record;
+    record.adapterLuidHighPart = snapshot.adapterLuid.HighPart;
+    record.adapterLuidLowPart = snapshot.adapterLuid.LowPart;
+    record.driverVersion = snapshot.driverVersion;
+    record.sharedResourceCompatibilityTier = snapshot.sharedResourceCompatibilityTier;
+    record.tileBasedRenderer = snapshot.architecture.TileBasedRenderer;
+    record.uma = snapshot.architecture.UMA;
+    record.cacheCoherentUma = snapshot.architecture.CacheCoherentUMA;
+    record.isolatedMmu = snapshot.architecture.IsolatedMMU;
+    record.resourceHeapTier = snapshot.resourceHeapTier;
+    for (const auto& support : snapshot.formats) {
+        record.formats.push_back({static_cast<uint32_t>(support.Format),
+                                  static_cast<uint32_t>(support.Support1),
+                                  static_cast<uint32_t>(support.Support2)});
+    }
+    return record;
+}
+
+D3D12CapabilitySnapshot FromCapabilityRecord(const CapabilityRecord& record) {
+    D3D12CapabilitySnapshot snapshot;
+    snapshot.adapterLuid.HighPart = record.adapterLuidHighPart;
+    snapshot.adapterLuid.LowPart = record.adapterLuidLowPart;
+    snapshot.driverVersion = record.driverVersion;
+    snapshot.sharedResourceCompatibilityTier =
+        static_cast<D3D12_SHARED_RESOURCE_COMPATIBILITY_TIER>(record.sharedResourceCompatibilityTier);
+    snapshot.architecture.TileBasedRenderer = record.tileBasedRenderer != 0;
+    snapshot.architecture.UMA = record.uma != 0;
+    snapshot.architecture.CacheCoherentUMA = record.cacheCoherentUma != 0;
+    snapshot.architecture.IsolatedMMU = record.isolatedMmu != 0;
+    snapshot.resourceHeapTier = static_cast<D3D12_RESOURCE_HEAP_TIER>(record.resourceHeapTier);
+    for (const auto& support : record.formats) {
+        snapshot.formats.push_back({static_cast<DXGI_FORMAT>(support.format),
+                                    static_cast<D3D12_FORMAT_SUPPORT1>(support.support1),
+                                    static_cast<D3D12_FORMAT_SUPPORT2>(support.support2)});
+    }
+    return snapshot;
+}
+
+// A device's capabilities, resolved on first use: taken from the cache when adapter and driver match, probed and
+// stored otherwise. Nothing is queried until then, so startup doesn't pay for capabilities nobody looks at.
+class D3D12Capabilities {
+public:
+    D3D12Capabilities(ID3D12Device* device, CapabilityCache& cache, StartupProfile* profile = nullptr)
+        : m_cache(cache), m_profile(profile) {
+        m_device.copy_from(device);
+    }
+
+    const D3D12CapabilitySnapshot& Get() {
+        std::call_once(m_resolved, [this] {
+            const auto begin = StartupProfile::Clock::now();
+
+            const LUID adapterLuid = m_device->GetAdapterLuid();
+            const uint64_t driverVersion = QueryDriverVersion(adapterLuid);
+            if (const CapabilityRecord* cached = m_cache.Find(adapterLuid.HighPart, adapterLuid.LowPart, driverVersion)) {
+                m_snapshot = FromCapabilityRecord(*cached);
+                m_fromCache = true;
+            } else {
+                m_snapshot = ProbeCapabilities(m_device.get(), driverVersion);
+                m_cache.Store(ToCapabilityRecord(m_snapshot));
+            }
+
+            if (m_profile != nullptr) {
+                m_profile->Record(m_fromCache ? "Capabilities (cached)" : "Capabilities (probed)", begin);
+            }
+        });
+        return m_snapshot;
+    }
+
+    bool FromCache() {
+        Get();
+        return m_fromCache;
+    }
+
+private:
+    winrt::com_ptr<ID3D12Device> m_device;
+    CapabilityCache& m_cache;
+    StartupProfile* m_profile;
+    std::once_flag m_resolved;
+    D3D12CapabilitySnapshot m_snapshot;
+    bool m_fromCache = false;
+};
+
+RENDERDOC_API_1_4_0* GetRenderdocAPI() {
+    RENDERDOC_API_1_4_0* rdoc_api = nullptr;
+
+    if (HMODULE mod = GetModuleHandleA("renderdoc.dll")) {
+        pRENDERDOC_GetAPI RENDERDOC_GetAPI = (pRENDERDOC_GetAPI)GetProcAddress(mod, "RENDERDOC_GetAPI");
+        int ret = RENDERDOC_GetAPI(eRENDERDOC_API_Version_1_4_0, (void**)&rdoc_api);
+        assert(ret == 1);
+    }
+
+    return rdoc_api;
+}
+
+// Takes the benchmark options of ParseBenchmarkArgs(), which only RUN_TEXTURE_ARRAY_BENCHMARK uses
+int main(int argc, char** argv) {
+    BenchmarkOptions benchmarkOptions;
+    try {
+        benchmarkOptions = ParseBenchmarkArgs(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 2;
+    }
+
+    StartupProfile startupProfile;
+
+    RENDERDOC_API_1_4_0* rdoc = GetRenderdocAPI();
+
+#ifdef RUN_VERIFY_BENCHMARK
+    VerifySurfaceBenchmark();
+#endif
+
+    winrt::com_ptr<ID3D11Device5> d3d11Device;
+    winrt::com_ptr<ID3D12Device> d3d12Device;
+    D3D12DeviceKey d3d12DeviceKey;
+    CreateDevicesInParallel(d3d11Device, d3d12Device, d3d12DeviceKey, startupProfile);
+
+    // Secondary devices on the same adapter, created once and reused by every test
+    D3D12DevicePool devicePool;
+
+    CapabilityCache capabilityCache("SharedTextureArray_Capabilities.txt");
+    D3D12Capabilities capabilities(d3d12Device.get(), capabilityCache, &startupProfile);
+
+    // Production arrays are e.g. {2048, 2048, 64, TextureArrayDesc::FullMipChain(2048, 2048)}
+    TextureArrayDesc textureArrayDesc;
+
+    startupProfile.Print();
+
+    // Capabilities, and the path selector keyed by them, are resolved by the first test instead of at startup
+    std::unique_ptr<InteropPathSelector> pathSelector;
+    const auto textureArrayTest = [&](const TextureArrayDesc& desc,
+                                      uint32_t iterations,
+                                      uint32_t warmupIterations,
+                                      BenchmarkReport* report) {
+        const D3D12CapabilitySnapshot& snapshot = capabilities.Get();
+        if (!pathSelector) {
+            std::cout << "SharedResourceCompatibilityTier: " << snapshot.sharedResourceCompatibilityTier
+                      << (capabilities.FromCache() ? " (cached)" : "") << "\n\n";
+            pathSelector = std::make_unique<InteropPathSelector>(
+                "SharedTextureArray_PathSelection.txt", snapshot.sharedResourceCompatibilityTier, snapshot.driverVersion);
+        }
+        TextureArrayTest(d3d11Device.get(),
+                         d3d12Device.get(),
+                         devicePool,
+                         d3d12DeviceKey,
+                         snapshot,
+                         desc,
+                         iterations,
+                         warmupIterations,
+                         report,
+                         pathSelector.get());
+    };
+
+#ifdef RUN_BACKEND_TEST
+    {
+        D3D12InteropBackend d3d12Backend(d3d12Device.get());
+        BackendTextureArrayTest(d3d12Backend, textureArrayDesc);
+
+        CpuInteropBackend cpuBackend;
+        BackendTextureArrayTest(cpuBackend, textureArrayDesc);
+    }
+#endif
+
+#ifdef RUN_TEXTURE_ARRAY_BENCHMARK
+    {
+        const uint32_t warmupIterations = benchmarkOptions.warmupIterations;
+        const uint32_t iterations = benchmarkOptions.iterations;
+
+        BenchmarkReport report;
+        D3D12InteropBackend d3d12Backend(d3d12Device.get());
+        CpuInteropBackend cpuBackend;
+        for (const auto& desc : benchmarkOptions.matrix) {
+            if (TextureArrayBytes(desc) > benchmarkOptions.maxArrayMiB * 1024 * 1024) {
+                continue;
+            }
+            textureArrayTest(desc, warmupIterations + iterations, warmupIterations, &report);
+            BackendTextureArrayTest(d3d12Backend, desc, warmupIterations + iterations, warmupIterations, &report);
+            BackendTextureArrayTest(cpuBackend, desc, warmupIterations + iterations, warmupIterations, &report);
+        }
+        report.Print();
+        report.WriteJson("SharedTextureArray_Benchmark.json");
+    }
+#endif
+
+    // Capture on dx11 device
+#ifdef RDOC_CAPTURE_DX11
+    {
+        if (rdoc) {
+            rdoc->SetCaptureFilePathTemplate("SharedTextureArray_DX11Device");
+            rdoc->StartFrameCapture(d3d11Device.get(), nullptr);
+        }
+
+        textureArrayTest(textureArrayDesc, 10, 0, nullptr);
+
+        if (rdoc) {
+            rdoc->EndFrameCapture(d3d11Device.get(), nullptr);
+        }
+    }
+#endif
+
+#ifdef RDOC_CAPTURE_DX12
+    // Capture on dx12 device
+    {
+        if (rdoc) {
+            rdoc->SetCaptureFilePathTemplate("SharedTextureArray_DX12Device");
+            rdoc->StartFrameCapture(d3d12Device.get(), nullptr);
+        }
+
+        textureArrayTest(textureArrayDesc, 10, 0, nullptr);
+
+        if (rdoc) {
+            rdoc->EndFrameCapture(d3d12Device.get(), nullptr);
+        }
+    }
+#endif
+}
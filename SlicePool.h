@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// The recycling behind SharedSlicePool, independent of the API so reuse can be tested without a device. Unlike D3D11
+// staging textures, nothing tracks the GPU use of these slices, so a released slice is tagged with the fence value of
+// its last use and handed out again only once `timeline`, a FenceTimeline, has passed it. `Device` provides
+//     using Slice, Desc, Key                  an owning slice, the description it is created from and an ordered key
+//     Key KeyOf(const Desc& desc) const       the fields two slices have to share to be interchangeable
+//     Slice CreateSlice(const Desc& desc)
+//     void DestroySlice(Slice& slice)         called once the slice's last use has retired, before it is dropped
+template <typename Device, typename Timeline>
+class FencedSlicePool {
+public:
+    using Slice = typename Device::Slice;
+    using Desc = typename Device::Desc;
+
+    struct Stats {
+        uint64_t numAcquires = 0;
+        uint64_t numCreated = 0;
+    };
+
+    template <typename... Args>
+    explicit FencedSlicePool(Timeline& timeline, Args&&... args)
+        : m_timeline(timeline), m_device(std::forward<Args>(args)...) {
+    }
+
+    ~FencedSlicePool() {
+        for (auto& [key, freeSlices] : m_freeSlices) {
+            for (auto& freeSlice : freeSlices) {
+                m_timeline.WaitFor(freeSlice.fenceValue);
+                m_device.DestroySlice(freeSlice.slice);
+            }
+        }
+    }
+
+    FencedSlicePool(const FencedSlicePool&) = delete;
+    FencedSlicePool& operator=(const FencedSlicePool&) = delete;
+
+    Slice Acquire(const Desc& desc) {
+        ++m_stats.numAcquires;
+
+        auto& freeSlices = m_freeSlices[m_device.KeyOf(desc)];
+        for (auto iter = freeSlices.begin(); iter != freeSlices.end(); ++iter) {
+            if (m_timeline.IsComplete(iter->fenceValue)) {
+                Slice slice = std::move(iter->slice);
+                freeSlices.erase(iter);
+                return slice;
+            }
+        }
+
+        ++m_stats.numCreated;
+        return m_device.CreateSlice(desc);
+    }
+
+    // Hands the slice back once the work up to `fenceValue`, its last use, has retired
+    void Release(Slice slice, const Desc& desc, uint64_t fenceValue) {
+        m_freeSlices[m_device.KeyOf(desc)].push_back({std::move(slice), fenceValue});
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct FreeSlice {
+        Slice slice;
+        uint64_t fenceValue;
+    };
+
+    Timeline& m_timeline;
+    Device m_device;
+    std::map<typename Device::Key, std::vector<FreeSlice>> m_freeSlices;
+    Stats m_stats;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// The recycling behind D3D11StagingPool, independent of the API so reuse can be tested without a device. Staging
+// textures are kept by the key of their description; the runtime tracks their GPU use itself, so a texture can be
+// handed out again right after it is released. `Device` provides
+//     using Texture, Desc, Key                    an owning texture handle, its description and an ordered key of it
+//     Key KeyOf(const Desc& desc) const           the fields a staging twin has to match
+//     Desc DescOf(const Texture& texture) const
+//     Texture CreateStaging(const Desc& desc)     a CPU readable staging twin of a texture with the description
+template <typename Device>
+class StagingPool {
+public:
+    using Texture = typename Device::Texture;
+    using Desc = typename Device::Desc;
+
+    struct Stats {
+        uint64_t numAcquires = 0;
+        uint64_t numCreated = 0;
+    };
+
+    template <typename... Args>
+    explicit StagingPool(Args&&... args) : m_device(std::forward<Args>(args)...) {
+    }
+
+    StagingPool(const StagingPool&) = delete;
+    StagingPool& operator=(const StagingPool&) = delete;
+
+    // Returns a CPU readable staging twin of a texture with the given description
+    Texture Acquire(const Desc& sourceDesc) {
+        ++m_stats.numAcquires;
+
+        auto& freeTextures = m_freeTextures[m_device.KeyOf(sourceDesc)];
+        if (!freeTextures.empty()) {
+            Texture texture = std::move(freeTextures.back());
+            freeTextures.pop_back();
+            return texture;
+        }
+
+        ++m_stats.numCreated;
+        return m_device.CreateStaging(sourceDesc);
+    }
+
+    void Release(Texture texture) {
+        const auto key = m_device.KeyOf(m_device.DescOf(texture));
+        m_freeTextures[key].push_back(std::move(texture));
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    Device m_device;
+    std::map<typename Device::Key, std::vector<Texture>> m_freeTextures;
+    Stats m_stats;
+};
+
+// The non-blocking readback behind D3D11StagingReadback, independent of the API so its states can be tested without a
+// device. Poll() maps one subresource after another without waiting and returns to the caller as soon as the copy into
+// one is still in flight, resuming with that subresource on the next call. `Context` provides
+//     using Mapped                                the mapping of a subresource handed to the consumer
+//     void Flush()                                submits the copies recorded so far
+//     bool TryMap(uint32_t subres, Mapped& mapped)  maps without waiting, false while the copy is still in flight
+//     void Unmap(uint32_t subres)
+template <typename Context>
+class StagingReadback {
+public:
+    using Mapped = typename Context::Mapped;
+
+    enum class State {
+        Idle,
+        Pending,
+        Done,
+    };
+
+    template <typename... Args>
+    explicit StagingReadback(Args&&... args) : m_context(std::forward<Args>(args)...) {
+    }
+
+    Context& GetContext() {
+        return m_context;
+    }
+
+    // Reads back `subresources` of the staging texture, after the caller recorded its copies into them
+    void Issue(std::vector<uint32_t> subresources) {
+        // Without a flush the copy may sit in the command buffer and the non-blocking maps would never succeed
+        m_context.Flush();
+
+        m_subresources = std::move(subresources);
+        m_next = 0;
+        m_state = State::Pending;
+    }
+
+    // Consumes every subresource that has landed, in order, as `consume(subres, mapped)`. Returns true once all of them
+    // have been consumed, and false while they are in flight or if nothing was issued.
+    template <typename Consume>
+    bool Poll(Consume&& consume) {
+        if (m_state != State::Pending) {
+            return m_state == State::Done;
+        }
+
+        while (m_next < m_subresources.size()) {
+            const uint32_t subres = m_subresources[m_next];
+            Mapped mapped;
+            if (!m_context.TryMap(subres, mapped)) {
+                ++m_numBusyPolls;
+                return false;
+            }
+
+            consume(subres, mapped);
+            m_context.Unmap(subres);
+            ++m_next;
+        }
+
+        m_state = State::Done;
+        return true;
+    }
+
+    State GetState() const {
+        return m_state;
+    }
+
+    uint64_t NumBusyPolls() const {
+        return m_numBusyPolls;
+    }
+
+private:
+    Context m_context;
+    std::vector<uint32_t> m_subresources;
+    size_t m_next = 0;
+    State m_state = State::Idle;
+    uint64_t m_numBusyPolls = 0;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+// The bookkeeping behind D3D12StateTracker, independent of the API so the emitted barrier sets can be tested without a
+// device. Transition() only updates the requested state; Collect() returns one change for each subresource whose state
+// differs from the previous collection, folded into one AllSubresources change when every subresource of a resource
+// moves the same way. A transition that is undone before the next collection costs nothing.
+template <typename Resource, typename State>
+class SubresourceStateTracker {
+public:
+    // Same value as D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+    static constexpr uint32_t AllSubresources = 0xFFFFFFFF;
+
+    struct Change {
+        Resource resource;
+        uint32_t subres;
+        State before;
+        State after;
+    };
+
+    struct Stats {
+        uint64_t numTransitions = 0;
+        uint64_t numBarriers = 0;
+        uint64_t numBarrierCalls = 0;
+    };
+
+    void Register(Resource resource, uint32_t numSubresources, State state) {
+        Tracked& tracked = m_resources[resource];
+        tracked.flushed.assign(numSubresources, state);
+        tracked.current.assign(numSubresources, state);
+    }
+
+    void Unregister(Resource resource) {
+        m_resources.erase(resource);
+    }
+
+    bool IsRegistered(Resource resource) const {
+        return m_resources.find(resource) != m_resources.end();
+    }
+
+    // `subres` may be AllSubresources
+    void Transition(Resource resource, uint32_t subres, State state) {
+        Tracked& tracked = Find(resource);
+        ++m_stats.numTransitions;
+        Assign(tracked.current, subres, state);
+    }
+
+    // Records a state change that happens without a barrier, like implicit promotion out of or decay back to COMMON
+    void Assume(Resource resource, uint32_t subres, State state) {
+        Tracked& tracked = Find(resource);
+        Assign(tracked.current, subres, state);
+        Assign(tracked.flushed, subres, state);
+    }
+
+    // The requested state, which is what the GPU sees once the pending changes are collected
+    State StateOf(Resource resource, uint32_t subres) {
+        return Find(resource).current[subres];
+    }
+
+    // The changes since the previous collection. Counted as one barrier call when not empty.
+    const std::vector<Change>& Collect() {
+        m_changes.clear();
+        for (auto& [resource, tracked] : m_resources) {
+            const size_t firstChange = m_changes.size();
+            bool uniform = true;
+            for (uint32_t subres = 0; subres < tracked.current.size(); ++subres) {
+                if (tracked.flushed[subres] == tracked.current[subres]) {
+                    uniform = false;
+                    continue;
+                }
+
+                const Change change = {resource, subres, tracked.flushed[subres], tracked.current[subres]};
+                if ((m_changes.size() > firstChange) &&
+                    ((m_changes[firstChange].before != change.before) || (m_changes[firstChange].after != change.after))) {
+                    uniform = false;
+                }
+                m_changes.push_back(change);
+            }
+
+            if (uniform && (tracked.current.size() > 1)) {
+                m_changes.resize(firstChange + 1);
+                m_changes[firstChange].subres = AllSubresources;
+            }
+            tracked.flushed = tracked.current;
+        }
+
+        if (!m_changes.empty()) {
+            m_stats.numBarriers += m_changes.size();
+            ++m_stats.numBarrierCalls;
+        }
+        return m_changes;
+    }
+
+    const Stats& GetStats() const {
+        return m_stats;
+    }
+
+private:
+    struct Tracked {
+        // State as of the last collection, i.e. what the GPU will see, and the state requested since
+        std::vector<State> flushed;
+        std::vector<State> current;
+    };
+
+    static void Assign(std::vector<State>& states, uint32_t subres, State state) {
+        if (subres == AllSubresources) {
+            std::fill(states.begin(), states.end(), state);
+        } else {
+            states.at(subres) = state;
+        }
+    }
+
+    Tracked& Find(Resource resource) {
+        auto iter = m_resources.find(resource);
+        if (iter == m_resources.end()) {
+            throw std::invalid_argument("Resource isn't registered with the state tracker");
+        }
+        return iter->second;
+    }
+
+    std::map<Resource, Tracked> m_resources;
+    std::vector<Change> m_changes;
+    Stats m_stats;
+};
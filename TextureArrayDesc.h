@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#include <DirectXMath.h>
+#else
+// The subset of the Windows SDK types the portable code uses, with the same values
+enum DXGI_FORMAT : uint32_t {
+    DXGI_FORMAT_UNKNOWN = 0,
+    DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+    DXGI_FORMAT_B8G8R8A8_UNORM = 87,
+};
+
+namespace DirectX {
+struct XMFLOAT4 {
+    float x;
+    float y;
+    float z;
+    float w;
+};
+} // namespace DirectX
+#endif
+
+// Geometry and format of the shared texture array. Subresources are indexed the same way as D3D12CalcSubresource and
+// D3D11CalcSubresource, every mip of an array slice is filled with that slice's color.
+struct TextureArrayDesc {
+    uint32_t width = 256;
+    uint32_t height = 256;
+    uint32_t arraySize = 2;
+    uint32_t mipLevels = 1;
+    DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    uint32_t sampleCount = 1;
+
+    static uint32_t FullMipChain(uint32_t width, uint32_t height) {
+        uint32_t mipLevels = 1;
+        while ((width | height) >> mipLevels) {
+            ++mipLevels;
+        }
+        return mipLevels;
+    }
+
+    uint32_t NumSubresources() const {
+        return arraySize * mipLevels;
+    }
+
+    uint32_t Subresource(uint32_t mip, uint32_t slice) const {
+        return mip + slice * mipLevels;
+    }
+
+    uint32_t MipOf(uint32_t subres) const {
+        return subres % mipLevels;
+    }
+
+    uint32_t SliceOf(uint32_t subres) const {
+        return subres / mipLevels;
+    }
+
+    uint32_t MipWidth(uint32_t mip) const {
+        return std::max(1u, width >> mip);
+    }
+
+    uint32_t MipHeight(uint32_t mip) const {
+        return std::max(1u, height >> mip);
+    }
+
+    bool Multisampled() const {
+        return sampleCount > 1;
+    }
+
+    bool operator==(const TextureArrayDesc& rhs) const {
+        return (width == rhs.width) && (height == rhs.height) && (arraySize == rhs.arraySize) && (mipLevels == rhs.mipLevels) &&
+               (format == rhs.format) && (sampleCount == rhs.sampleCount);
+    }
+};
+
+inline const char* FormatName(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return "R8G8B8A8_UNORM";
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return "B8G8R8A8_UNORM";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+// The inverse of FormatName, DXGI_FORMAT_UNKNOWN for names it doesn't return
+inline DXGI_FORMAT FormatFromName(const std::string& name) {
+    for (DXGI_FORMAT format : {DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM}) {
+        if (name == FormatName(format)) {
+            return format;
+        }
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+inline uint32_t BytesPerPixel(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return 4;
+
+    default:
+        throw std::invalid_argument("Unsupported texture array format");
+    }
+}
+
+// Bytes of every subresource of every slice, without row padding
+inline uint64_t TextureArrayBytes(const TextureArrayDesc& desc) {
+    uint64_t bytes = 0;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+        bytes += static_cast<uint64_t>(desc.MipWidth(mip)) * desc.MipHeight(mip) * BytesPerPixel(desc.format);
+    }
+    return bytes * desc.arraySize * desc.sampleCount;
+}
+
+// Packs 8-bit RGBA components the way a texel of the given format is laid out in memory
+inline uint32_t PackColor(DXGI_FORMAT format, const uint8_t rgba[4]) {
+    switch (format) {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return (uint32_t(rgba[0]) << 0) | (uint32_t(rgba[1]) << 8) | (uint32_t(rgba[2]) << 16) | (uint32_t(rgba[3]) << 24);
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return (uint32_t(rgba[2]) << 0) | (uint32_t(rgba[1]) << 8) | (uint32_t(rgba[0]) << 16) | (uint32_t(rgba[3]) << 24);
+
+    default:
+        throw std::invalid_argument("Only 32bpp UNORM color formats can be verified");
+    }
+}
+
+// Random per-slice clear colors and their packed texel values
+inline void RandomSliceColors(const TextureArrayDesc& desc,
+                              std::vector<DirectX::XMFLOAT4>& sliceColors,
+                              std::vector<uint32_t>& sliceRgbas) {
+    sliceColors.resize(desc.arraySize);
+    sliceRgbas.resize(desc.arraySize);
+    for (size_t i = 0; i < sliceRgbas.size(); ++i) {
+        const uint8_t components[] = {
+            static_cast<uint8_t>(rand() & 0xFF),
+            static_cast<uint8_t>(rand() & 0xFF),
+            static_cast<uint8_t>(rand() & 0xFF),
+            static_cast<uint8_t>(rand() & 0xFF),
+        };
+
+        sliceColors[i] = {
+            std::min(1.0f, components[0] / 255.0f),
+            std::min(1.0f, components[1] / 255.0f),
+            std::min(1.0f, components[2] / 255.0f),
+            std::min(1.0f, components[3] / 255.0f),
+        };
+        sliceRgbas[i] = PackColor(desc.format, components);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A transient's size and pass range going into the packer; the packer fills in the offset
+struct TransientLifetime {
+    uint64_t size = 0;
+    // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+    uint64_t alignment = 64 * 1024;
+    uint32_t firstPass = 0;
+    uint32_t lastPass = 0;
+    uint64_t offset = 0;
+
+    bool OverlapsInTime(const TransientLifetime& other) const {
+        return (firstPass <= other.lastPass) && (other.firstPass <= lastPass);
+    }
+
+    bool OverlapsInMemory(const TransientLifetime& other) const {
+        return (offset < other.offset + other.size) && (other.offset < offset + size);
+    }
+};
+
+// Greedy interval packing: largest transients first, each at the lowest aligned offset that no transient alive in an
+// overlapping pass occupies. Returns the heap size needed.
+inline uint64_t PackTransientLifetimes(std::vector<TransientLifetime>& transients) {
+    std::vector<size_t> order(transients.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        if (transients[lhs].size != transients[rhs].size) {
+            return transients[lhs].size > transients[rhs].size;
+        }
+        return transients[lhs].firstPass < transients[rhs].firstPass;
+    });
+
+    uint64_t heapSize = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> occupied;
+    for (size_t i = 0; i < order.size(); ++i) {
+        TransientLifetime& transient = transients[order[i]];
+
+        occupied.clear();
+        for (size_t j = 0; j < i; ++j) {
+            const TransientLifetime& placed = transients[order[j]];
+            if (placed.OverlapsInTime(transient)) {
+                occupied.emplace_back(placed.offset, placed.offset + placed.size);
+            }
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        const uint64_t alignMask = transient.alignment - 1;
+        uint64_t offset = 0;
+        for (const auto& [begin, end] : occupied) {
+            offset = (offset + alignMask) & ~alignMask;
+            if (offset + transient.size <= begin) {
+                break;
+            }
+            offset = std::max(offset, end);
+        }
+        transient.offset = (offset + alignMask) & ~alignMask;
+        heapSize = std::max(heapSize, transient.offset + transient.size);
+    }
+    return heapSize;
+}
@@ -0,0 +1,239 @@
+#include "VerifySurface.h"
+
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <tuple>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VERIFY_X86_SIMD
+#ifdef _MSC_VER
+#include <intrin.h>
+#define VERIFY_TARGET(isa)
+#else
+// GCC and Clang only emit SSE4.1/AVX2 instructions in functions that ask for them
+#define VERIFY_TARGET(isa) __attribute__((target(isa)))
+#endif
+#include <immintrin.h>
+#endif
+
+namespace {
+
+SimdLevel DetectSimdLevel() {
+#if defined(VERIFY_X86_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    bool avx2 = false;
+    if ((maxLeaf >= 7) && osxsave && avx && ((_xgetbv(0) & 0x6) == 0x6)) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    if (avx2) {
+        return SimdLevel::Avx2;
+    }
+    if (sse41) {
+        return SimdLevel::Sse41;
+    }
+#elif defined(VERIFY_X86_SIMD)
+    // Also checks that the OS saves the AVX registers
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return SimdLevel::Sse41;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+// The row kernels return the number of mismatching texels in [begin, width) and update firstX/lastX. firstX has to be
+// UINT32_MAX on entry of a new row.
+uint32_t VerifyRowScalar(const uint32_t* row, uint32_t begin, uint32_t width, uint32_t expected, uint32_t& firstX, uint32_t& lastX) {
+    uint32_t count = 0;
+    for (uint32_t x = begin; x < width; ++x) {
+        if (row[x] != expected) {
+            firstX = std::min(firstX, x);
+            lastX = x;
+            ++count;
+        }
+    }
+    return count;
+}
+
+#ifdef VERIFY_X86_SIMD
+void RecordMismatchMask(uint32_t mismatchMask, uint32_t laneCount, uint32_t x, uint32_t& count, uint32_t& firstX, uint32_t& lastX) {
+    for (uint32_t lane = 0; lane < laneCount; ++lane) {
+        if (mismatchMask & (1u << lane)) {
+            firstX = std::min(firstX, x + lane);
+            lastX = x + lane;
+            ++count;
+        }
+    }
+}
+
+VERIFY_TARGET("sse4.1")
+uint32_t VerifyRowSse41(const uint32_t* row, uint32_t width, uint32_t expected, uint32_t& firstX, uint32_t& lastX) {
+    const __m128i expectedVec = _mm_set1_epi32(static_cast<int>(expected));
+    const __m128i allOnes = _mm_set1_epi32(-1);
+
+    uint32_t count = 0;
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 0)), expectedVec);
+        const __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 4)), expectedVec);
+        const __m128i eq2 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 8)), expectedVec);
+        const __m128i eq3 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 12)), expectedVec);
+        const __m128i allEq = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+        if (_mm_testc_si128(allEq, allOnes)) {
+            continue;
+        }
+
+        const __m128i eqs[] = {eq0, eq1, eq2, eq3};
+        for (uint32_t i = 0; i < std::size(eqs); ++i) {
+            const uint32_t mismatchMask = ~static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(eqs[i]))) & 0xF;
+            RecordMismatchMask(mismatchMask, 4, x + i * 4, count, firstX, lastX);
+        }
+    }
+
+    return count + VerifyRowScalar(row, x, width, expected, firstX, lastX);
+}
+
+VERIFY_TARGET("avx2")
+uint32_t VerifyRowAvx2(const uint32_t* row, uint32_t width, uint32_t expected, uint32_t& firstX, uint32_t& lastX) {
+    const __m256i expectedVec = _mm256_set1_epi32(static_cast<int>(expected));
+    const __m256i allOnes = _mm256_set1_epi32(-1);
+
+    uint32_t count = 0;
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i eq0 = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 0)), expectedVec);
+        const __m256i eq1 = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 8)), expectedVec);
+        const __m256i eq2 = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 16)), expectedVec);
+        const __m256i eq3 = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x + 24)), expectedVec);
+        const __m256i allEq = _mm256_and_si256(_mm256_and_si256(eq0, eq1), _mm256_and_si256(eq2, eq3));
+        if (_mm256_testc_si256(allEq, allOnes)) {
+            continue;
+        }
+
+        const __m256i eqs[] = {eq0, eq1, eq2, eq3};
+        for (uint32_t i = 0; i < std::size(eqs); ++i) {
+            const uint32_t mismatchMask = ~static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(eqs[i]))) & 0xFF;
+            RecordMismatchMask(mismatchMask, 8, x + i * 8, count, firstX, lastX);
+        }
+    }
+
+    return count + VerifyRowScalar(row, x, width, expected, firstX, lastX);
+}
+#endif
+
+} // namespace
+
+SimdLevel BestSimdLevel() {
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
+
+VerifyResult VerifySurface(const void* data, uint32_t rowPitch, uint32_t width, uint32_t height, uint32_t expected, SimdLevel simdLevel) {
+    // A level the CPU doesn't have would fault, fall back to the best one it does
+    simdLevel = std::min(simdLevel, BestSimdLevel());
+
+    VerifyResult result;
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint32_t* row = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(data) + static_cast<size_t>(y) * rowPitch);
+
+        uint32_t firstX = UINT32_MAX;
+        uint32_t lastX = 0;
+        uint32_t count;
+        switch (simdLevel) {
+#ifdef VERIFY_X86_SIMD
+        case SimdLevel::Avx2:
+            count = VerifyRowAvx2(row, width, expected, firstX, lastX);
+            break;
+
+        case SimdLevel::Sse41:
+            count = VerifyRowSse41(row, width, expected, firstX, lastX);
+            break;
+#endif
+
+        default:
+            count = VerifyRowScalar(row, 0, width, expected, firstX, lastX);
+            break;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        if (result.Passed()) {
+            result.firstMismatchX = firstX;
+            result.firstMismatchY = y;
+            result.minX = firstX;
+            result.minY = y;
+            result.maxX = lastX;
+        }
+        result.minX = std::min(result.minX, firstX);
+        result.maxX = std::max(result.maxX, lastX);
+        result.maxY = y;
+        result.mismatchCount += count;
+    }
+
+    return result;
+}
+
+void VerifySurfaceBenchmark() {
+    constexpr uint32_t width = 4096;
+    constexpr uint32_t height = 4096;
+    constexpr uint32_t rowPitch = width * sizeof(uint32_t);
+    constexpr uint32_t iterations = 10;
+    constexpr uint32_t expected = 0x80FF4020;
+
+    std::vector<uint32_t> surface(static_cast<size_t>(width) * height, expected);
+
+    const std::tuple<SimdLevel, const char*> levels[] = {
+        {SimdLevel::Scalar, "Scalar"},
+        {SimdLevel::Sse41, "SSE4.1"},
+        {SimdLevel::Avx2, "AVX2"},
+    };
+    for (const auto& [level, name] : levels) {
+        if (level > BestSimdLevel()) {
+            continue;
+        }
+
+        uint64_t mismatches = 0;
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            mismatches += VerifySurface(surface.data(), rowPitch, width, height, expected, level).mismatchCount;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        const double gigaBytes = static_cast<double>(rowPitch) * height * iterations / 1e9;
+        std::cout << "Verify " << name << ": " << gigaBytes / elapsed.count() << " GB/s (" << mismatches << " mismatches)\n";
+    }
+    std::cout << "\n";
+}
+
+void PrintResult(const TextureArrayDesc& desc, const std::vector<VerifyResult>& slice) {
+    for (uint32_t subres = 0; subres < slice.size(); ++subres) {
+        std::cout << "\tSlice " << desc.SliceOf(subres);
+        if (desc.mipLevels > 1) {
+            std::cout << " mip " << desc.MipOf(subres);
+        }
+        std::cout << " ";
+        if (slice[subres].Passed()) {
+            std::cout << "succeeded!";
+        } else {
+            std::cout << "FAILED!!! " << slice[subres].mismatchCount << " mismatches, first at (" << slice[subres].firstMismatchX
+                      << ", " << slice[subres].firstMismatchY << "), bounds (" << slice[subres].minX << ", " << slice[subres].minY
+                      << ")-(" << slice[subres].maxX << ", " << slice[subres].maxY << ")";
+        }
+        std::cout << "\n";
+    }
+}
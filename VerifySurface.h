@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "TextureArrayDesc.h"
+
+// Compares every texel of a 32bpp surface against the expected value, honoring the row pitch of the mapping
+struct VerifyResult {
+    uint64_t mismatchCount = 0;
+    uint32_t firstMismatchX = 0;
+    uint32_t firstMismatchY = 0;
+    // Inclusive bounding box of all mismatches, only valid when mismatchCount is non-zero
+    uint32_t minX = 0;
+    uint32_t minY = 0;
+    uint32_t maxX = 0;
+    uint32_t maxY = 0;
+
+    bool Passed() const {
+        return mismatchCount == 0;
+    }
+
+    void Merge(const VerifyResult& other) {
+        if (other.Passed()) {
+            return;
+        }
+        if (Passed()) {
+            *this = other;
+            return;
+        }
+
+        mismatchCount += other.mismatchCount;
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+};
+
+enum class SimdLevel {
+    Scalar,
+    Sse41,
+    Avx2,
+};
+
+SimdLevel BestSimdLevel();
+
+VerifyResult VerifySurface(const void* data,
+                           uint32_t rowPitch,
+                           uint32_t width,
+                           uint32_t height,
+                           uint32_t expected,
+                           SimdLevel simdLevel = BestSimdLevel());
+
+void VerifySurfaceBenchmark();
+
+void PrintResult(const TextureArrayDesc& desc, const std::vector<VerifyResult>& slice);
@@ -0,0 +1,90 @@
+#include <vector>
+
+#include "../BatchedReadback.h"
+#include "../ContextRing.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A command list that only remembers which subresources were copied through it
+struct StandInList {
+    std::vector<uint32_t> copies;
+};
+
+// A command context ring on a stand-in queue, scheduled by the same ContextRing as D3D12CommandContextRing, counting
+// how often it opens and submits a list
+class StandInRing {
+public:
+    StandInList* Begin() {
+        if (!m_ring.IsOpen()) {
+            m_lists[m_ring.Open(m_timeline)].copies.clear();
+            ++numBegins;
+        }
+        return &m_lists[m_ring.Current()];
+    }
+
+    uint64_t Submit() {
+        ++numSubmits;
+        submitted.push_back(m_lists[m_ring.Current()]);
+        const uint64_t fenceValue = m_timeline.Signal();
+        m_ring.Close(fenceValue);
+        return fenceValue;
+    }
+
+    StandInTimeline& Sync() {
+        return m_timeline;
+    }
+
+    uint32_t numBegins = 0;
+    uint32_t numSubmits = 0;
+    std::vector<StandInList> submitted;
+
+private:
+    StandInTimeline m_timeline;
+    ContextRing m_ring{3};
+    StandInList m_lists[3];
+};
+
+}
+
+TEST_CASE(BatchedReadbackSubmitsAndWaitsOnceForAnyArraySize) {
+    for (uint32_t numSubres : {1u, 6u, 64u}) {
+        StandInRing ring;
+        std::vector<uint32_t> verified;
+
+        const uint64_t fenceValue = SubmitAndVerifyOnce(
+            ring,
+            numSubres,
+            [&](StandInList* list) {
+                for (uint32_t subres = 0; subres < numSubres; ++subres) {
+                    list->copies.push_back(subres);
+                }
+            },
+            [&](uint32_t subres) {
+                // Nothing is read before the copies retired
+                CHECK(ring.Sync().IsComplete(ring.Sync().LastSignaled()));
+                verified.push_back(subres);
+            });
+
+        CHECK_EQ(ring.numBegins, 1u);
+        CHECK_EQ(ring.numSubmits, 1u);
+        CHECK_EQ(ring.Sync().GetFence().numWaits, 1u);
+        CHECK_EQ(fenceValue, uint64_t(1));
+        CHECK_EQ(ring.submitted.size(), size_t(1));
+        CHECK_EQ(ring.submitted[0].copies.size(), size_t(numSubres));
+        CHECK_EQ(verified.size(), size_t(numSubres));
+    }
+}
+
+TEST_CASE(BatchedReadbackAppendsToAListAlreadyOpen) {
+    StandInRing ring;
+    ring.Begin()->copies.push_back(100);
+
+    SubmitAndVerifyOnce(ring, 2, [](StandInList* list) { list->copies.push_back(0); }, [](uint32_t) {});
+
+    CHECK_EQ(ring.numBegins, 1u);
+    CHECK_EQ(ring.numSubmits, 1u);
+    CHECK_EQ(ring.submitted[0].copies.size(), size_t(2));
+    CHECK_EQ(ring.submitted[0].copies[0], 100u);
+}
@@ -0,0 +1,98 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "../BenchmarkReport.h"
+#include "TestHarness.h"
+
+namespace {
+
+const char* const MatrixFile = "BenchmarkMatrixTests_Matrix.txt";
+
+BenchmarkOptions Parse(std::vector<const char*> args) {
+    args.insert(args.begin(), "SharedTextureArrayPortable");
+    return ParseBenchmarkArgs(static_cast<int>(args.size()), args.data());
+}
+
+}
+
+TEST_CASE(MatrixEntriesGiveSizeMipsAndFormat) {
+    const TextureArrayDesc plain = ParseMatrixEntry("2048x1024x64");
+    CHECK_EQ(plain.width, 2048u);
+    CHECK_EQ(plain.height, 1024u);
+    CHECK_EQ(plain.arraySize, 64u);
+    CHECK_EQ(plain.mipLevels, 1u);
+    CHECK(plain.format == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+    CHECK_EQ(ParseMatrixEntry("256x256x2x3").mipLevels, 3u);
+    CHECK_EQ(ParseMatrixEntry("1024x512x16xfull").mipLevels, TextureArrayDesc::FullMipChain(1024, 512));
+
+    const TextureArrayDesc bgra = ParseMatrixEntry("64x64x4xfull:B8G8R8A8_UNORM");
+    CHECK(bgra.format == DXGI_FORMAT_B8G8R8A8_UNORM);
+    CHECK_EQ(bgra.mipLevels, 7u);
+}
+
+TEST_CASE(MatrixEntriesRejectMalformedValues) {
+    CHECK_THROWS(ParseMatrixEntry(""));
+    CHECK_THROWS(ParseMatrixEntry("256x256"));
+    CHECK_THROWS(ParseMatrixEntry("256x256x2x1x1"));
+    CHECK_THROWS(ParseMatrixEntry("256x0x2"));
+    CHECK_THROWS(ParseMatrixEntry("256x-1x2"));
+    CHECK_THROWS(ParseMatrixEntry("256x256x2a"));
+    CHECK_THROWS(ParseMatrixEntry("256x256x2x10"));
+    CHECK_THROWS(ParseMatrixEntry("256x256x2:R32_FLOAT"));
+}
+
+TEST_CASE(MatrixFilesSkipBlankLinesAndComments) {
+    std::istringstream file("# Small arrays first\n"
+                            "256x256x2\n"
+                            "\n"
+                            "  1024x1024x16xfull   # production mips\n"
+                            "2048x2048x64:B8G8R8A8_UNORM\n");
+    const std::vector<TextureArrayDesc> matrix = ParseBenchmarkMatrix(file);
+    CHECK_EQ(matrix.size(), size_t(3));
+    CHECK_EQ(matrix[0].arraySize, 2u);
+    CHECK_EQ(matrix[1].mipLevels, 11u);
+    CHECK(matrix[2].format == DXGI_FORMAT_B8G8R8A8_UNORM);
+}
+
+TEST_CASE(BenchmarkArgsDefaultToTheBuiltInMatrix) {
+    const BenchmarkOptions defaults = Parse({});
+    CHECK_EQ(defaults.iterations, 50u);
+    CHECK_EQ(defaults.warmupIterations, 5u);
+    CHECK_EQ(defaults.maxArrayMiB, uint64_t(2048));
+    CHECK(defaults.matrix == BenchmarkMatrix());
+
+    const BenchmarkOptions counts = Parse({"2", "1", "64"});
+    CHECK_EQ(counts.iterations, 2u);
+    CHECK_EQ(counts.warmupIterations, 1u);
+    CHECK_EQ(counts.maxArrayMiB, uint64_t(64));
+    CHECK(counts.matrix == BenchmarkMatrix());
+}
+
+TEST_CASE(BenchmarkArgsReplaceTheMatrixInTheGivenOrder) {
+    {
+        std::ofstream file(MatrixFile);
+        file << "512x512x8\n1024x1024x4xfull\n";
+    }
+
+    const BenchmarkOptions options = Parse({"10", "--array", "64x64x2", "--matrix", MatrixFile, "--array", "32x32x1:B8G8R8A8_UNORM"});
+    std::remove(MatrixFile);
+
+    CHECK_EQ(options.iterations, 10u);
+    CHECK_EQ(options.warmupIterations, 5u);
+    CHECK_EQ(options.matrix.size(), size_t(4));
+    CHECK_EQ(options.matrix[0].width, 64u);
+    CHECK_EQ(options.matrix[1].width, 512u);
+    CHECK_EQ(options.matrix[2].mipLevels, 11u);
+    CHECK(options.matrix[3].format == DXGI_FORMAT_B8G8R8A8_UNORM);
+}
+
+TEST_CASE(BenchmarkArgsRejectWhatTheyDontKnow) {
+    CHECK_THROWS(Parse({"--array"}));
+    CHECK_THROWS(Parse({"--matrix", "BenchmarkMatrixTests_Missing.txt"}));
+    CHECK_THROWS(Parse({"--iterations", "5"}));
+    CHECK_THROWS(Parse({"five"}));
+    CHECK_THROWS(Parse({"-5"}));
+    CHECK_THROWS(Parse({"1", "2", "3", "4"}));
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <fstream>
+
+#include "../CapabilityCache.h"
+#include "TestHarness.h"
+
+namespace {
+
+const char* const CacheFile = "CapabilityCacheTests_Capabilities.txt";
+
+CapabilityRecord MakeRecord(int32_t luidHighPart, uint32_t luidLowPart, uint64_t driverVersion) {
+    CapabilityRecord record;
+    record.adapterLuidHighPart = luidHighPart;
+    record.adapterLuidLowPart = luidLowPart;
+    record.driverVersion = driverVersion;
+    record.sharedResourceCompatibilityTier = 2;
+    record.uma = 1;
+    record.cacheCoherentUma = 1;
+    record.resourceHeapTier = 2;
+    record.formats = {{28, 0x4000ffff, 0x3}, {87, 0x4000fffe, 0x1}};
+    return record;
+}
+
+void WriteCacheFile(const std::string& contents) {
+    std::ofstream file(CacheFile);
+    file << contents;
+}
+
+}
+
+TEST_CASE(CapabilityCacheRecordsRoundTripThroughTheFile) {
+    std::remove(CacheFile);
+
+    const CapabilityRecord stored = MakeRecord(-1, 0xfffffff0u, 31000000001234ull);
+    CapabilityCache(CacheFile).Store(stored);
+
+    const CapabilityCache reloaded(CacheFile);
+    const CapabilityRecord* found = reloaded.Find(-1, 0xfffffff0u, 31000000001234ull);
+    CHECK(found != nullptr);
+    CHECK_EQ(CapabilityCache::Serialize(*found), CapabilityCache::Serialize(stored));
+    CHECK_EQ(found->formats.size(), size_t(2));
+    CHECK_EQ(found->formats[1].support1, 0x4000fffeu);
+
+    std::remove(CacheFile);
+}
+
+TEST_CASE(CapabilityCacheMissesWhenTheDriverChanged) {
+    std::remove(CacheFile);
+
+    CapabilityCache cache(CacheFile);
+    cache.Store(MakeRecord(0, 42, 100));
+    CHECK(cache.Find(0, 42, 100) != nullptr);
+    CHECK(cache.Find(0, 42, 101) == nullptr);
+    CHECK(cache.Find(1, 42, 100) == nullptr);
+    CHECK(cache.Find(0, 43, 100) == nullptr);
+
+    std::remove(CacheFile);
+}
+
+TEST_CASE(CapabilityCacheStoreReplacesTheAdaptersRecord) {
+    std::remove(CacheFile);
+
+    {
+        CapabilityCache cache(CacheFile);
+        cache.Store(MakeRecord(0, 42, 100));
+        cache.Store(MakeRecord(0, 7, 100));
+        cache.Store(MakeRecord(0, 42, 200));
+        CHECK_EQ(cache.NumRecords(), size_t(2));
+        CHECK(cache.Find(0, 42, 100) == nullptr);
+        CHECK(cache.Find(0, 42, 200) != nullptr);
+    }
+
+    // The file holds one line per adapter, not one per store
+    const CapabilityCache reloaded(CacheFile);
+    CHECK_EQ(reloaded.NumRecords(), size_t(2));
+    CHECK(reloaded.Find(0, 7, 100) != nullptr);
+    CHECK(reloaded.Find(0, 42, 200) != nullptr);
+
+    std::remove(CacheFile);
+}
+
+TEST_CASE(CapabilityCacheRejectsLuidHalvesOutOfRange) {
+    CapabilityRecord record;
+    CHECK(CapabilityCache::Parse("-2147483648 4294967295 1 0 0 0 0 0 1 0", record));
+    CHECK_EQ(record.adapterLuidHighPart, INT32_MIN);
+    CHECK_EQ(record.adapterLuidLowPart, UINT32_MAX);
+
+    CHECK(!CapabilityCache::Parse("0 -1 1 0 0 0 0 0 1 0", record));
+    CHECK(!CapabilityCache::Parse("0 4294967296 1 0 0 0 0 0 1 0", record));
+    CHECK(!CapabilityCache::Parse("2147483648 0 1 0 0 0 0 0 1 0", record));
+    CHECK(!CapabilityCache::Parse("-2147483649 0 1 0 0 0 0 0 1 0", record));
+}
+
+TEST_CASE(CapabilityCacheRejectsLinesFromOtherLayouts) {
+    CapabilityRecord record;
+    CHECK(CapabilityCache::Parse("0 42 100 2 0 1 1 0 2 1 28 1 2", record));
+
+    // Missing the resource heap tier, as lines written before it was cached are
+    CHECK(!CapabilityCache::Parse("0 42 100 2 0 1 1 0 1 28 1 2", record));
+    // A trailing field, a short format list and an implausible format count
+    CHECK(!CapabilityCache::Parse("0 42 100 2 0 1 1 0 2 1 28 1 2 9", record));
+    CHECK(!CapabilityCache::Parse("0 42 100 2 0 1 1 0 2 2 28 1 2", record));
+    CHECK(!CapabilityCache::Parse("0 42 100 2 0 1 1 0 2 65", record));
+    CHECK(!CapabilityCache::Parse("", record));
+}
+
+TEST_CASE(CapabilityCacheDropsEveryRecordWhenOneLineFailsToParse) {
+    WriteCacheFile(CapabilityCache::Serialize(MakeRecord(0, 42, 100)) + "\n0 7 100 2 0 1 1 0 1 28 1 2\n");
+
+    const CapabilityCache cache(CacheFile);
+    CHECK_EQ(cache.NumRecords(), size_t(0));
+    CHECK(cache.Find(0, 42, 100) == nullptr);
+
+    std::remove(CacheFile);
+}
@@ -0,0 +1,81 @@
+#include "../ContextRing.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+namespace {
+
+// What D3D12CommandContextRing::Submit() does once the list is closed and executed
+uint64_t Submit(ContextRing& ring, StandInTimeline& timeline) {
+    const uint64_t fenceValue = timeline.Signal();
+    ring.Close(fenceValue);
+    return fenceValue;
+}
+
+}
+
+TEST_CASE(ContextRingTagsEachContextWithItsSubmission) {
+    StandInTimeline timeline;
+    ContextRing ring(3);
+
+    const uint32_t first = ring.Open(timeline);
+    CHECK(ring.IsOpen());
+    CHECK_EQ(Submit(ring, timeline), uint64_t(1));
+    const uint32_t second = ring.Open(timeline);
+    CHECK_EQ(Submit(ring, timeline), uint64_t(2));
+
+    CHECK(first != second);
+    CHECK_EQ(ring.FenceValue(first), uint64_t(1));
+    CHECK_EQ(ring.FenceValue(second), uint64_t(2));
+    CHECK_EQ(ring.GetStats().numSubmits, uint64_t(2));
+    CHECK(!ring.IsOpen());
+}
+
+TEST_CASE(ContextRingCyclesWithoutStallingWhileTheGpuKeepsUp) {
+    StandInTimeline timeline;
+    ContextRing ring(3);
+
+    for (uint32_t i = 0; i < 9; ++i) {
+        ring.Open(timeline);
+        Submit(ring, timeline);
+        timeline.GetFence().Advance(timeline.GetFence().latencyMs);
+    }
+    CHECK_EQ(ring.GetStats().numStalls, uint64_t(0));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(0));
+}
+
+TEST_CASE(ContextRingStallsOnlyWhenTheNextContextIsInFlight) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 100;
+    ContextRing ring(3);
+
+    // Three submissions in flight: every context is busy
+    for (uint32_t i = 0; i < 3; ++i) {
+        CHECK_EQ(ring.Open(timeline), (i + 1) % 3);
+        Submit(ring, timeline);
+    }
+    CHECK_EQ(ring.GetStats().numStalls, uint64_t(0));
+
+    // The fourth reopens the first context, so waits for its submission and no later one
+    const uint32_t reopened = ring.Open(timeline);
+    CHECK_EQ(reopened, uint32_t(1));
+    CHECK_EQ(ring.GetStats().numStalls, uint64_t(1));
+    CHECK(timeline.IsComplete(1));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(1));
+    CHECK_EQ(Submit(ring, timeline), uint64_t(4));
+    CHECK_EQ(ring.FenceValue(reopened), uint64_t(4));
+
+    // Its neighbour was submitted at the same time, so it retired too
+    ring.Open(timeline);
+    CHECK_EQ(ring.GetStats().numStalls, uint64_t(1));
+}
+
+TEST_CASE(ContextRingKeepsOneContextOpenUntilClosed) {
+    StandInTimeline timeline;
+    ContextRing ring(2);
+
+    ring.Open(timeline);
+    CHECK_THROWS(ring.Open(timeline));
+    Submit(ring, timeline);
+    CHECK_THROWS(ring.Close(2));
+    CHECK_THROWS(ContextRing(0));
+}
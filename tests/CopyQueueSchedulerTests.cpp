@@ -0,0 +1,226 @@
+#include <map>
+#include <string>
+
+#include "../CopyQueueHandoff.h"
+#include "../ReadbackPages.h"
+#include "../SubresourceStateTracker.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A stand-in for two GPU queues with one fence each. Commands are queued the way ExecuteCommandLists, Signal and Wait
+// queue them; Step() runs the next command of every queue that isn't blocked on a Wait, so work on different queues
+// overlaps within a step.
+class QueueScheduler {
+public:
+    enum Queue { Direct, Copy, NumQueues };
+
+    void Execute(Queue queue, const std::string& name) {
+        m_commands[queue].push_back({Command::Execute, name, queue, 0});
+    }
+
+    uint64_t Signal(Queue queue) {
+        m_commands[queue].push_back({Command::Signal, "", queue, ++m_lastSignaled[queue]});
+        return m_lastSignaled[queue];
+    }
+
+    void Wait(Queue queue, Queue fenceQueue, uint64_t value) {
+        m_commands[queue].push_back({Command::Wait, "", fenceQueue, value});
+    }
+
+    uint64_t Completed(Queue queue) const {
+        return m_completed[queue];
+    }
+
+    // Returns false once every queue is idle or blocked
+    bool Step() {
+        bool progressed = false;
+        const uint64_t completed[] = {m_completed[Direct], m_completed[Copy]};
+        for (uint32_t queue = 0; queue < NumQueues; ++queue) {
+            if (m_next[queue] == m_commands[queue].size()) {
+                continue;
+            }
+
+            const Command& command = m_commands[queue][m_next[queue]];
+            if ((command.type == Command::Wait) && (completed[command.fenceQueue] < command.value)) {
+                continue;
+            }
+            if (command.type == Command::Execute) {
+                m_stepOf[command.name] = m_step;
+            } else if (command.type == Command::Signal) {
+                m_completed[queue] = command.value;
+            }
+            ++m_next[queue];
+            progressed = true;
+        }
+        ++m_step;
+        return progressed;
+    }
+
+    void RunAll() {
+        while (Step()) {
+        }
+    }
+
+    // The step a command list ran in, -1 if it hasn't run
+    int StepOf(const std::string& name) const {
+        auto iter = m_stepOf.find(name);
+        return iter == m_stepOf.end() ? -1 : iter->second;
+    }
+
+private:
+    struct Command {
+        enum Type { Execute, Signal, Wait } type;
+        std::string name;
+        Queue fenceQueue;
+        uint64_t value;
+    };
+
+    std::vector<Command> m_commands[NumQueues];
+    size_t m_next[NumQueues] = {};
+    uint64_t m_lastSignaled[NumQueues] = {};
+    uint64_t m_completed[NumQueues] = {};
+    std::map<std::string, int> m_stepOf;
+    int m_step = 0;
+};
+
+// Stand-ins for D3D12_RESOURCE_STATES
+enum State { RenderTarget, CopySource, Common };
+
+using Tracker = SubresourceStateTracker<int, State>;
+
+constexpr int Texture = 1;
+
+const char* StateName(State state) {
+    switch (state) {
+    case RenderTarget:
+        return "RENDER_TARGET";
+    case CopySource:
+        return "COPY_SOURCE";
+    default:
+        return "COMMON";
+    }
+}
+
+// A command context ring on one of the scheduler's queues, as CopyQueueHandoff drives it. Recorded commands and
+// barriers are executed in order when the open list is submitted.
+class StandInQueue {
+public:
+    StandInQueue(QueueScheduler& scheduler, QueueScheduler::Queue queue) : m_scheduler(scheduler), m_queue(queue) {
+    }
+
+    void Record(const std::string& name) {
+        m_open.push_back(name);
+    }
+
+    void FlushBarriers(Tracker& tracker) {
+        for (const Tracker::Change& change : tracker.Collect()) {
+            Record(std::string("transition to ") + StateName(change.after));
+        }
+    }
+
+    uint64_t Submit() {
+        for (const auto& name : m_open) {
+            m_scheduler.Execute(m_queue, name);
+        }
+        m_open.clear();
+        return m_scheduler.Signal(m_queue);
+    }
+
+    void Wait(StandInQueue& other, uint64_t value) {
+        m_scheduler.Wait(m_queue, other.m_queue, value);
+    }
+
+private:
+    QueueScheduler& m_scheduler;
+    QueueScheduler::Queue m_queue;
+    std::vector<std::string> m_open;
+};
+
+}
+
+TEST_CASE(CopyQueueHandoffOrdersTheCopyBetweenProducerAndConsumer) {
+    QueueScheduler scheduler;
+    StandInQueue direct(scheduler, QueueScheduler::Direct);
+    StandInQueue copy(scheduler, QueueScheduler::Copy);
+    CopyQueueHandoff<StandInQueue> handoff(copy);
+    Tracker tracker;
+    tracker.Register(Texture, 4, RenderTarget);
+
+    // The producer's list ends with the transition to COMMON
+    direct.Record("render");
+    handoff.AcquireFrom(direct, tracker, Texture, Common);
+
+    // The copies promote the texture out of COMMON and it decays back, so they need no barriers
+    copy.Record("readback copies");
+    const uint64_t copyValue = handoff.Submit();
+    CHECK_EQ(tracker.StateOf(Texture, 0), Common);
+
+    // The producer keeps rendering other targets before the texture comes back
+    direct.Record("other rendering");
+    direct.Record("more rendering");
+    direct.Submit();
+    handoff.ReturnTo(direct, tracker, Texture, RenderTarget, copyValue);
+    direct.Submit();
+
+    scheduler.RunAll();
+    CHECK(scheduler.StepOf("render") < scheduler.StepOf("transition to COMMON"));
+    CHECK(scheduler.StepOf("transition to COMMON") < scheduler.StepOf("readback copies"));
+    CHECK(scheduler.StepOf("readback copies") < scheduler.StepOf("transition to RENDER_TARGET"));
+    // The copy engine runs next to the producer's rendering instead of behind it
+    CHECK_EQ(scheduler.StepOf("readback copies"), scheduler.StepOf("more rendering"));
+    CHECK_EQ(scheduler.Completed(QueueScheduler::Copy), copyValue);
+    CHECK_EQ(tracker.StateOf(Texture, 0), RenderTarget);
+}
+
+TEST_CASE(CopyQueueHandoffBlocksTheCopyUntilTheProducerSubmitted) {
+    QueueScheduler scheduler;
+    StandInQueue direct(scheduler, QueueScheduler::Direct);
+    StandInQueue copy(scheduler, QueueScheduler::Copy);
+    CopyQueueHandoff<StandInQueue> handoff(copy);
+    Tracker tracker;
+    tracker.Register(Texture, 1, RenderTarget);
+
+    // A texture already in COMMON needs no barrier, but the copy still waits for the producer's submission
+    tracker.Transition(Texture, Tracker::AllSubresources, Common);
+    tracker.Collect();
+    direct.Record("render");
+    handoff.AcquireFrom(direct, tracker, Texture, Common);
+    copy.Record("readback copies");
+    const uint64_t copyValue = handoff.Submit();
+
+    // The consumer's list recorded before ReturnTo is submitted behind the wait, so it waits for the copies too
+    direct.Record("unrelated rendering");
+    handoff.ReturnTo(direct, tracker, Texture, RenderTarget, copyValue);
+    direct.Submit();
+
+    scheduler.RunAll();
+    CHECK_EQ(scheduler.StepOf("transition to COMMON"), -1);
+    CHECK(scheduler.StepOf("render") < scheduler.StepOf("readback copies"));
+    CHECK(scheduler.StepOf("readback copies") < scheduler.StepOf("unrelated rendering"));
+    CHECK(scheduler.StepOf("unrelated rendering") < scheduler.StepOf("transition to RENDER_TARGET"));
+}
+
+TEST_CASE(CopyQueueReadbackMemoryRetiresOnTheCopyTimeline) {
+    QueueScheduler scheduler;
+    ReadbackPageAllocator allocator(1024);
+    const auto copyComplete = [&](uint64_t fenceValue) { return fenceValue <= scheduler.Completed(QueueScheduler::Copy); };
+
+    // The copy waits on a producer value that hasn't been submitted yet
+    scheduler.Wait(QueueScheduler::Copy, QueueScheduler::Direct, 2);
+    const auto readback = allocator.Allocate(1024, 256, copyComplete);
+    scheduler.Execute(QueueScheduler::Copy, "readback copies");
+    allocator.Release(readback, scheduler.Signal(QueueScheduler::Copy));
+
+    // The direct queue retires value 1 first, which says nothing about the copy queue
+    scheduler.Execute(QueueScheduler::Direct, "render");
+    scheduler.Signal(QueueScheduler::Direct);
+    scheduler.RunAll();
+    CHECK_EQ(scheduler.Completed(QueueScheduler::Direct), uint64_t(1));
+    CHECK_EQ(scheduler.StepOf("readback copies"), -1);
+    CHECK_EQ(allocator.Allocate(1024, 256, copyComplete).page, uint32_t(1));
+
+    scheduler.Signal(QueueScheduler::Direct);
+    scheduler.RunAll();
+    CHECK_EQ(allocator.Allocate(1024, 256, copyComplete).page, uint32_t(0));
+}
@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "../CrossApiTimeline.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A GPU queue executing work, fence signals and fence waits in order. A batching queue, like the D3D11 immediate
+// context, only hands recorded commands to the GPU when flushed.
+struct StandInGpuQueue {
+    struct Command {
+        enum class Kind {
+            Work,
+            Signal,
+            Wait,
+        };
+
+        Kind kind;
+        uint64_t value;
+        std::string name;
+    };
+
+    explicit StandInGpuQueue(bool batches = false) : batches(batches) {
+    }
+
+    void Record(Command command) {
+        (batches ? recorded : submitted).push_back(std::move(command));
+    }
+
+    void Work(std::string name) {
+        Record({Command::Kind::Work, 0, std::move(name)});
+    }
+
+    void Flush() {
+        submitted.insert(submitted.end(), recorded.begin(), recorded.end());
+        recorded.clear();
+    }
+
+    bool batches;
+    std::deque<Command> recorded;
+    std::deque<Command> submitted;
+};
+
+// The shared fence and the GPU running both queues. Run() prefers `first`, so work that isn't held back by a wait on
+// the fence overtakes work on the other queue.
+struct StandInGpu {
+    void Run(StandInGpuQueue& first, StandInGpuQueue& second) {
+        bool progress = true;
+        while (progress) {
+            progress = Step(first) || Step(second);
+        }
+    }
+
+    bool Step(StandInGpuQueue& queue) {
+        if (queue.submitted.empty()) {
+            return false;
+        }
+
+        const StandInGpuQueue::Command& command = queue.submitted.front();
+        switch (command.kind) {
+        case StandInGpuQueue::Command::Kind::Work:
+            executed.push_back(command.name);
+            break;
+        case StandInGpuQueue::Command::Kind::Signal:
+            // The value both devices share only moves forward
+            CHECK(command.value > fenceValue);
+            fenceValue = command.value;
+            break;
+        case StandInGpuQueue::Command::Kind::Wait:
+            if (fenceValue < command.value) {
+                return false;
+            }
+            break;
+        }
+        queue.submitted.pop_front();
+        return true;
+    }
+
+    uint64_t fenceValue = 0;
+    std::vector<std::string> executed;
+};
+
+class StandInSharedFence {
+public:
+    StandInSharedFence(StandInGpu& gpu, StandInGpuQueue& d3d11Context) : m_gpu(gpu), m_d3d11Context(d3d11Context) {
+    }
+
+    void SignalOnD3D12(StandInGpuQueue* queue, uint64_t value) {
+        queue->Record({StandInGpuQueue::Command::Kind::Signal, value, {}});
+    }
+
+    void WaitOnD3D12(StandInGpuQueue* queue, uint64_t value) {
+        queue->Record({StandInGpuQueue::Command::Kind::Wait, value, {}});
+    }
+
+    void SignalOnD3D11(uint64_t value) {
+        m_d3d11Context.Record({StandInGpuQueue::Command::Kind::Signal, value, {}});
+    }
+
+    void WaitOnD3D11(uint64_t value) {
+        m_d3d11Context.Record({StandInGpuQueue::Command::Kind::Wait, value, {}});
+    }
+
+    void FlushD3D11() {
+        m_d3d11Context.Flush();
+    }
+
+    uint64_t CompletedValue() const {
+        return m_gpu.fenceValue;
+    }
+
+private:
+    StandInGpu& m_gpu;
+    StandInGpuQueue& m_d3d11Context;
+};
+
+using Timeline = CrossApiTimeline<StandInSharedFence>;
+
+}
+
+TEST_CASE(CrossApiTimelineSharesOneIncreasingValueBetweenBothDirections) {
+    StandInGpu gpu;
+    StandInGpuQueue d3d11Context(true);
+    StandInGpuQueue d3d12Queue;
+    Timeline timeline(gpu, d3d11Context);
+
+    CHECK_EQ(timeline.D3D12ToD3D11(&d3d12Queue), uint64_t(1));
+    CHECK_EQ(timeline.D3D11ToD3D12(&d3d12Queue), uint64_t(2));
+    CHECK_EQ(timeline.D3D11ToD3D12(&d3d12Queue), uint64_t(3));
+    CHECK_EQ(timeline.D3D12ToD3D11(&d3d12Queue), uint64_t(4));
+    CHECK_EQ(timeline.LastValue(), uint64_t(4));
+
+    // Nothing blocks the CPU, the values complete once the GPU runs
+    CHECK_EQ(timeline.CompletedValue(), uint64_t(0));
+    d3d11Context.Flush();
+    gpu.Run(d3d11Context, d3d12Queue);
+    CHECK_EQ(timeline.CompletedValue(), uint64_t(4));
+    CHECK(d3d11Context.submitted.empty());
+    CHECK(d3d12Queue.submitted.empty());
+}
+
+TEST_CASE(CrossApiTimelineOrdersTheHandoffsOfASharedResource) {
+    StandInGpu gpu;
+    StandInGpuQueue d3d11Context(true);
+    StandInGpuQueue d3d12Queue;
+    Timeline timeline(gpu, d3d11Context);
+
+    // What TryShareD3D11FenceToD3D12 does: D3D12 writes, D3D11 reads, and later D3D12 writes can't overtake the reads
+    d3d12Queue.Work("d3d12 writes");
+    timeline.D3D12ToD3D11(&d3d12Queue);
+    d3d11Context.Work("d3d11 reads");
+    timeline.D3D11ToD3D12(&d3d12Queue);
+    d3d12Queue.Work("d3d12 writes again");
+
+    // D3D11 runs first whenever it can, so only the waits keep it behind the D3D12 writes
+    gpu.Run(d3d11Context, d3d12Queue);
+    CHECK(gpu.executed == (std::vector<std::string>{"d3d12 writes", "d3d11 reads", "d3d12 writes again"}));
+}
+
+TEST_CASE(CrossApiTimelineFlushesTheD3D11SignalTheD3D12QueueWaitsFor) {
+    StandInGpu gpu;
+    StandInGpuQueue d3d11Context(true);
+    StandInGpuQueue d3d12Queue;
+    Timeline timeline(gpu, d3d11Context);
+
+    d3d11Context.Work("d3d11 writes");
+    timeline.D3D11ToD3D12(&d3d12Queue);
+    d3d12Queue.Work("d3d12 reads");
+
+    // Without another D3D11 flush the D3D12 queue still gets past its wait
+    gpu.Run(d3d12Queue, d3d11Context);
+    CHECK(d3d11Context.recorded.empty());
+    CHECK(gpu.executed == (std::vector<std::string>{"d3d11 writes", "d3d12 reads"}));
+}
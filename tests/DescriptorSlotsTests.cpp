@@ -0,0 +1,111 @@
+#include <set>
+#include <utility>
+
+#include "../DescriptorSlots.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A stand-in for the descriptor heaps: creates a heap whenever the allocator hands out a slot in a new one, and tracks
+// which slots hold a live view so a slot handed out twice is caught
+class StandInDescriptorHeaps {
+public:
+    explicit StandInDescriptorHeaps(uint32_t descriptorsPerHeap) : m_slots(descriptorsPerHeap) {
+    }
+
+    DescriptorSlotAllocator::Slot CreateView() {
+        const DescriptorSlotAllocator::Slot slot = m_slots.Allocate();
+        if (slot.heap == m_numHeapsCreated) {
+            ++m_numHeapsCreated;
+        }
+        CHECK(slot.heap < m_numHeapsCreated);
+        CHECK(m_views.insert({slot.heap, slot.index}).second);
+        return slot;
+    }
+
+    void DestroyView(DescriptorSlotAllocator::Slot slot) {
+        m_slots.Free(slot);
+        CHECK_EQ(m_views.erase({slot.heap, slot.index}), size_t(1));
+    }
+
+    uint32_t NumHeapsCreated() const {
+        return m_numHeapsCreated;
+    }
+
+    DescriptorSlotAllocator& Slots() {
+        return m_slots;
+    }
+
+private:
+    DescriptorSlotAllocator m_slots;
+    uint32_t m_numHeapsCreated = 0;
+    std::set<std::pair<uint32_t, uint32_t>> m_views;
+};
+
+}
+
+TEST_CASE(DescriptorSlotsBumpThroughAHeapBeforeAddingOne) {
+    StandInDescriptorHeaps heaps(4);
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        const auto slot = heaps.CreateView();
+        CHECK_EQ(slot.heap, 0u);
+        CHECK_EQ(slot.index, i);
+    }
+    CHECK_EQ(heaps.NumHeapsCreated(), 1u);
+
+    CHECK_EQ(heaps.CreateView().heap, 1u);
+    CHECK_EQ(heaps.Slots().GetStats().capacity, 8u);
+}
+
+TEST_CASE(DescriptorSlotsReuseFreedSlotsBeforeBumping) {
+    StandInDescriptorHeaps heaps(4);
+
+    std::vector<DescriptorSlotAllocator::Slot> slots;
+    for (uint32_t i = 0; i < 4; ++i) {
+        slots.push_back(heaps.CreateView());
+    }
+    heaps.DestroyView(slots[1]);
+    heaps.DestroyView(slots[2]);
+
+    // Both holes are filled before a second heap is needed
+    heaps.CreateView();
+    heaps.CreateView();
+    CHECK_EQ(heaps.NumHeapsCreated(), 1u);
+    CHECK_EQ(heaps.Slots().GetStats().numLive, 4u);
+}
+
+TEST_CASE(DescriptorSlotsDontFragmentUnderChurn) {
+    StandInDescriptorHeaps heaps(64);
+
+    // Views of arrays coming and going, the way the cache releases pooled slices: the live count never exceeds 100,
+    // so neither does the capacity beyond rounding up to whole heaps
+    std::vector<DescriptorSlotAllocator::Slot> live;
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        if ((live.size() < 100) && (live.empty() || ((seed >> 16) % 2 == 0))) {
+            live.push_back(heaps.CreateView());
+        } else {
+            const size_t victim = (seed >> 8) % live.size();
+            heaps.DestroyView(live[victim]);
+            live.erase(live.begin() + victim);
+        }
+    }
+
+    const auto stats = heaps.Slots().GetStats();
+    CHECK_EQ(stats.numLive, static_cast<uint32_t>(live.size()));
+    CHECK(stats.peakLive <= 100u);
+    CHECK_EQ(stats.numHeaps, (stats.peakLive + 63) / 64);
+}
+
+TEST_CASE(DescriptorSlotsRejectSlotsThatArentAllocated) {
+    DescriptorSlotAllocator slots(4);
+
+    const auto slot = slots.Allocate();
+    slots.Free(slot);
+    CHECK_THROWS(slots.Free(slot));
+    CHECK_THROWS(slots.Free({1, 0}));
+    CHECK_THROWS(slots.Free({0, 4}));
+    CHECK_THROWS(DescriptorSlotAllocator(0));
+}
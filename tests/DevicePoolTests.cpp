@@ -0,0 +1,196 @@
+#include <cstdint>
+#include <memory>
+#include <tuple>
+
+#include "../DevicePool.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+namespace {
+
+struct StandInDeviceKey {
+    uint32_t adapter = 0;
+    uint32_t minFeatureLevel = 0;
+
+    bool operator<(const StandInDeviceKey& rhs) const {
+        return std::tie(adapter, minFeatureLevel) < std::tie(rhs.adapter, rhs.minFeatureLevel);
+    }
+};
+
+struct StandInDevice {
+    uint32_t id = 0;
+};
+
+struct StandInDeviceContext {
+    StandInDeviceKey key;
+    std::shared_ptr<StandInDevice> device;
+    StandInTimeline timeline;
+};
+
+// What the stand-in backend shares with the test: a simulated clock and counts of what was created
+struct StandInDeviceWorld {
+    double nowMs = 0;
+    double createLatencyMs = 50;
+    uint32_t numDevicesCreated = 0;
+    uint32_t numRetired = 0;
+};
+
+// Creates devices through a counting factory that takes createLatencyMs of simulated time
+class StandInDeviceBackend {
+public:
+    using Key = StandInDeviceKey;
+    using Device = std::shared_ptr<StandInDevice>;
+    using Context = StandInDeviceContext;
+
+    explicit StandInDeviceBackend(StandInDeviceWorld& world) : m_world(world) {
+    }
+
+    Device CreateDevice(const Key&) {
+        m_world.nowMs += m_world.createLatencyMs;
+        return std::make_shared<StandInDevice>(StandInDevice{m_world.numDevicesCreated++});
+    }
+
+    std::unique_ptr<Context> CreateContext(const Key& key, const Device& device) {
+        auto context = std::make_unique<Context>();
+        context->key = key;
+        context->device = device;
+        return context;
+    }
+
+    const Key& KeyOf(const Context& context) const {
+        return context.key;
+    }
+
+    void Retire(Context& context) {
+        context.timeline.WaitFor(context.timeline.LastSignaled());
+        ++m_world.numRetired;
+    }
+
+    double NowMs() const {
+        return m_world.nowMs;
+    }
+
+private:
+    StandInDeviceWorld& m_world;
+};
+
+using Pool = DevicePool<StandInDeviceBackend>;
+
+}
+
+TEST_CASE(DevicePoolReusesReleasedContextsAndTheirDevice) {
+    StandInDeviceWorld world;
+    Pool pool(world);
+    const StandInDeviceKey key{1, 0xb000};
+
+    auto first = pool.Acquire(key);
+    StandInDeviceContext* const firstContext = first.get();
+    pool.Release(std::move(first));
+
+    auto reused = pool.Acquire(key);
+    CHECK(reused.get() == firstContext);
+
+    // A second context while the first is handed out shares the device
+    auto second = pool.Acquire(key);
+    CHECK(second.get() != firstContext);
+    CHECK(second->device == reused->device);
+
+    CHECK_EQ(world.numDevicesCreated, 1u);
+    CHECK_EQ(pool.GetStats().numAcquires, uint64_t(3));
+    CHECK_EQ(pool.GetStats().numDevicesCreated, 1u);
+    CHECK_EQ(pool.GetStats().numContextsCreated, 2u);
+
+    pool.Release(std::move(reused));
+    pool.Release(std::move(second));
+}
+
+TEST_CASE(DevicePoolKeysDevicesByAdapterAndFeatureLevel) {
+    StandInDeviceWorld world;
+    Pool pool(world);
+
+    auto level11 = pool.Acquire({1, 0xb000});
+    auto level12 = pool.Acquire({1, 0xc000});
+    auto otherAdapter = pool.Acquire({2, 0xb000});
+    CHECK(level11->device != level12->device);
+    CHECK(level11->device != otherAdapter->device);
+    CHECK_EQ(world.numDevicesCreated, 3u);
+
+    pool.Release(std::move(level12));
+    auto again = pool.Acquire({1, 0xc000});
+    CHECK_EQ(world.numDevicesCreated, 3u);
+
+    pool.Release(std::move(level11));
+    pool.Release(std::move(again));
+    pool.Release(std::move(otherAdapter));
+}
+
+TEST_CASE(DevicePoolEvictionWhileHandedOutKeepsTheDeviceUntilRelease) {
+    StandInDeviceWorld world;
+    Pool pool(world);
+    const StandInDeviceKey key{1, 0xb000};
+
+    auto idle = pool.Acquire(key);
+    auto busy = pool.Acquire(key);
+    idle->timeline.Signal();
+    pool.Release(std::move(idle));
+    busy->timeline.Signal();
+    const std::weak_ptr<StandInDevice> device = busy->device;
+
+    // The idle context's work is waited for, the handed out one keeps the device
+    pool.Evict(key);
+    CHECK_EQ(world.numRetired, 1u);
+    CHECK_EQ(pool.GetStats().numEvictions, 1u);
+    CHECK(!device.expired());
+    CHECK(!busy->timeline.IsComplete(busy->timeline.LastSignaled()));
+
+    // Its release waits for it instead of returning it to the pool
+    pool.Release(std::move(busy));
+    CHECK_EQ(world.numRetired, 2u);
+    CHECK(device.expired());
+
+    auto fresh = pool.Acquire(key);
+    CHECK_EQ(fresh->device->id, 1u);
+    CHECK_EQ(world.numDevicesCreated, 2u);
+    pool.Release(std::move(fresh));
+
+    // Evicting an unknown key is a no-op
+    pool.Evict({9, 0xb000});
+    CHECK_EQ(pool.GetStats().numEvictions, 1u);
+}
+
+TEST_CASE(DevicePoolTimesDeviceCreationOnly) {
+    StandInDeviceWorld world;
+    Pool pool(world);
+
+    world.createLatencyMs = 40;
+    auto first = pool.Acquire({1, 0xb000});
+    world.createLatencyMs = 80;
+    auto second = pool.Acquire({2, 0xb000});
+    pool.Release(std::move(first));
+    pool.Release(std::move(second));
+
+    // Hits don't create a device and aren't timed
+    world.createLatencyMs = 1000;
+    pool.Release(pool.Acquire({1, 0xb000}));
+
+    CHECK_EQ(pool.GetStats().numDevicesCreated, 2u);
+    CHECK_EQ(pool.GetStats().totalDeviceCreateMs, 120.0);
+    CHECK_EQ(pool.GetStats().maxDeviceCreateMs, 80.0);
+    CHECK_EQ(pool.GetStats().AverageDeviceCreateMs(), 60.0);
+
+    Pool empty(world);
+    CHECK_EQ(empty.GetStats().AverageDeviceCreateMs(), 0.0);
+}
+
+TEST_CASE(DevicePoolRetiresIdleContextsOnDestruction) {
+    StandInDeviceWorld world;
+    {
+        Pool pool(world);
+        auto a = pool.Acquire({1, 0xb000});
+        auto b = pool.Acquire({2, 0xb000});
+        a->timeline.Signal();
+        pool.Release(std::move(a));
+        pool.Release(std::move(b));
+    }
+    CHECK_EQ(world.numRetired, 2u);
+}
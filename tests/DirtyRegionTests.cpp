@@ -0,0 +1,108 @@
+#include <string>
+
+#include "../DirtyRegion.h"
+#include "TestHarness.h"
+
+namespace {
+
+TextureArrayDesc SmallArray() {
+    TextureArrayDesc desc;
+    desc.width = 8;
+    desc.height = 8;
+    desc.arraySize = 2;
+    desc.mipLevels = 2;
+    return desc;
+}
+
+std::string Describe(const std::vector<DirtyRect>& rects) {
+    std::string ret;
+    for (const DirtyRect& rect : rects) {
+        ret += "(" + std::to_string(rect.left) + "," + std::to_string(rect.top) + "," + std::to_string(rect.right) + "," +
+               std::to_string(rect.bottom) + ") ";
+    }
+    return ret;
+}
+
+}
+
+TEST_CASE(DirtyRegionMergesRectanglesWhoseUnionCoversNothingNew) {
+    DirtyRegionTracker tracker(SmallArray());
+
+    // Side by side, and then overlapping by half: the union is exactly what the two cover
+    tracker.MarkDirty(0, {0, 0, 4, 4});
+    tracker.MarkDirty(0, {4, 0, 8, 4});
+    CHECK_EQ(Describe(tracker.Rects(0)), std::string("(0,0,8,4) "));
+    tracker.MarkDirty(0, {0, 2, 8, 6});
+    CHECK_EQ(Describe(tracker.Rects(0)), std::string("(0,0,8,6) "));
+}
+
+TEST_CASE(DirtyRegionKeepsOverlappingRectanglesWhoseUnionAddsTexels) {
+    DirtyRegionTracker tracker(SmallArray());
+
+    // 16 + 16 texels with 9 shared cover 23, the union covers 25. Comparing against the plain sum would merge them.
+    tracker.MarkDirty(0, {0, 0, 4, 4});
+    tracker.MarkDirty(0, {1, 1, 5, 5});
+    CHECK_EQ(Describe(tracker.Rects(0)), std::string("(0,0,4,4) (1,1,5,5) "));
+
+    // A rectangle inside an existing one is absorbed
+    tracker.MarkDirty(0, {2, 2, 3, 3});
+    CHECK_EQ(tracker.Rects(0).size(), size_t(2));
+}
+
+TEST_CASE(DirtyRegionClampsToTheMipSize) {
+    DirtyRegionTracker tracker(SmallArray());
+
+    // Subresource 1 is mip 1 of slice 0, 4x4
+    tracker.MarkDirty(1, {2, 2, 100, 100});
+    CHECK_EQ(Describe(tracker.Rects(1)), std::string("(2,2,4,4) "));
+    tracker.MarkDirty(1, {4, 0, 8, 4});
+    CHECK_EQ(tracker.Rects(1).size(), size_t(1));
+
+    tracker.MarkSubresourceDirty(3);
+    CHECK_EQ(Describe(tracker.Rects(3)), std::string("(0,0,4,4) "));
+    CHECK(tracker.Rects(2).empty());
+    CHECK_THROWS(tracker.MarkDirty(4, {0, 0, 1, 1}));
+}
+
+TEST_CASE(DirtyRegionCapMergesThePairThatGrowsTheLeast) {
+    DirtyRegionTracker tracker(SmallArray(), 2);
+
+    tracker.MarkDirty(0, {0, 0, 1, 1});
+    tracker.MarkDirty(0, {7, 7, 8, 8});
+    tracker.MarkDirty(0, {2, 0, 3, 1});
+    CHECK_EQ(Describe(tracker.Rects(0)), std::string("(0,0,3,1) (7,7,8,8) "));
+}
+
+TEST_CASE(DirtyRegionTakeForgetsTheRectangles) {
+    DirtyRegionTracker tracker(SmallArray());
+
+    tracker.MarkSubresourceDirty(0);
+    CHECK_EQ(Describe(tracker.Take(0)), std::string("(0,0,8,8) "));
+    CHECK(tracker.Rects(0).empty());
+    CHECK(tracker.Take(0).empty());
+}
+
+TEST_CASE(CpuTextureMirrorPatchesRowsAtTheFormatsPitch) {
+    TextureArrayDesc desc = SmallArray();
+    desc.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    CpuTextureMirror mirror(desc);
+    CHECK_EQ(mirror.RowPitch(0), uint32_t(32));
+    CHECK_EQ(mirror.RowPitch(1), uint32_t(16));
+
+    // A 2x2 rectangle at (1, 2) of mip 1, read back with a padded pitch
+    const uint8_t rgba[] = {0x10, 0x20, 0x30, 0x40};
+    const uint32_t texel = PackColor(desc.format, rgba);
+    uint32_t readback[2][4] = {{texel, texel, 0xDEADBEEF, 0xDEADBEEF}, {texel, texel, 0xDEADBEEF, 0xDEADBEEF}};
+    mirror.Patch(1, {1, 2, 3, 4}, reinterpret_cast<const uint8_t*>(readback), sizeof(readback[0]));
+    mirror.MarkSynced();
+
+    const uint32_t* texels = reinterpret_cast<const uint32_t*>(mirror.Data(1));
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            const bool patched = (x >= 1) && (x < 3) && (y >= 2);
+            CHECK_EQ(texels[y * 4 + x], patched ? texel : 0u);
+        }
+    }
+    CHECK_EQ(mirror.GetStats().texelsPatched, uint64_t(4));
+    CHECK_EQ(mirror.GetStats().numSyncs, uint64_t(1));
+}
@@ -0,0 +1,113 @@
+#include "../FenceTimeline.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+TEST_CASE(FenceTimelineSignalsIncreasingValues) {
+    StandInTimeline timeline;
+    CHECK_EQ(timeline.LastSignaled(), uint64_t(0));
+    CHECK(timeline.IsComplete(0));
+
+    CHECK_EQ(timeline.Signal(), uint64_t(1));
+    CHECK_EQ(timeline.Signal(), uint64_t(2));
+    CHECK_EQ(timeline.LastSignaled(), uint64_t(2));
+    CHECK(!timeline.IsComplete(1));
+
+    timeline.GetFence().Advance(10);
+    CHECK(timeline.IsComplete(1));
+    CHECK(timeline.IsComplete(2));
+    CHECK(!timeline.IsComplete(3));
+}
+
+TEST_CASE(FenceTimelineOnlyQueriesTheFenceForValuesNotSeenComplete) {
+    StandInTimeline timeline;
+    timeline.Signal();
+    timeline.GetFence().Advance(10);
+
+    CHECK(timeline.IsComplete(1));
+    const uint32_t numQueries = timeline.GetFence().numCompletedQueries;
+    CHECK(timeline.IsComplete(1));
+    CHECK(timeline.IsComplete(0));
+    CHECK_EQ(timeline.GetFence().numCompletedQueries, numQueries);
+}
+
+TEST_CASE(FenceTimelineWaitForBlocksUntilTheValueCompletes) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 25;
+    const uint64_t value = timeline.Signal();
+
+    CHECK(timeline.WaitFor(value));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(25));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(1));
+
+    // Nothing to wait for once complete
+    CHECK(timeline.WaitFor(value));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(1));
+}
+
+TEST_CASE(FenceTimelineWaitForGivesUpAtTheTimeout) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 100;
+    const uint64_t value = timeline.Signal();
+
+    CHECK(!timeline.WaitFor(value, 40));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(40));
+    CHECK(!timeline.IsComplete(value));
+
+    CHECK(timeline.WaitFor(value, 60));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(100));
+
+    // A zero timeout only polls
+    const uint64_t next = timeline.Signal();
+    CHECK(!timeline.WaitFor(next, 0));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(100));
+}
+
+TEST_CASE(FenceTimelineWaitForRechecksAfterAnEarlyWakeup) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 30;
+    timeline.GetFence().numSpuriousWakeups = 1;
+    const uint64_t value = timeline.Signal();
+
+    CHECK(timeline.WaitFor(value, 50));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(2));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(30));
+
+    // The early wakeup doesn't extend the deadline either
+    timeline.GetFence().numSpuriousWakeups = 1;
+    timeline.GetFence().Advance(20);
+    const uint64_t late = timeline.Signal();
+    CHECK(!timeline.WaitFor(late, 10));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(60));
+}
+
+TEST_CASE(FenceTimelineWaitForMultipleWaitsForTheLargestOrSmallestValue) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 10;
+    const uint64_t first = timeline.Signal();
+    timeline.GetFence().Advance(5);
+    const uint64_t second = timeline.Signal();
+    const uint64_t values[] = {second, first};
+
+    CHECK(timeline.WaitForMultiple(values, 0, true));
+    CHECK_EQ(timeline.GetFence().numWaits, uint32_t(0));
+
+    // Any: done once the first value completes
+    CHECK(timeline.WaitForMultiple(values, 2, false));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(10));
+    CHECK(!timeline.IsComplete(second));
+
+    // All: done once the second does, but not within 2ms
+    CHECK(!timeline.WaitForMultiple(values, 2, true, 2));
+    CHECK(timeline.WaitForMultiple(values, 2, true));
+    CHECK_EQ(timeline.GetFence().NowMs(), uint64_t(15));
+}
+
+TEST_CASE(FenceTimelineFlushWaitsForEverythingSignaled) {
+    StandInTimeline timeline;
+    timeline.Signal();
+    timeline.Signal();
+
+    timeline.Flush();
+    CHECK_EQ(timeline.LastSignaled(), uint64_t(3));
+    CHECK(timeline.IsComplete(3));
+}
@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <vector>
+
+#include "../GpuScopes.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A CPU clock at 10 MHz and a GPU clock at 1 MHz. The GPU clock reads `gpuAtCpuZero` when the CPU clock reads 0.
+struct StandInGpuClock {
+    uint64_t CpuTicks() const {
+        return cpuTicks;
+    }
+
+    uint64_t CpuFrequency() const {
+        return 10000000;
+    }
+
+    uint64_t GpuFrequency() const {
+        return 1000000;
+    }
+
+    void Calibrate(uint64_t& gpuTicks, uint64_t& cpuTicksOut) {
+        ++numCalibrations;
+        cpuTicksOut = cpuTicks;
+        gpuTicks = gpuAtCpuZero + cpuTicks / 10;
+    }
+
+    // The GPU timestamp `cpuMs` after the CPU clock read 0
+    uint64_t GpuAt(double cpuMs) const {
+        return gpuAtCpuZero + static_cast<uint64_t>(cpuMs * 1000);
+    }
+
+    uint64_t cpuTicks = 0;
+    uint64_t gpuAtCpuZero = 5000000;
+    uint32_t numCalibrations = 0;
+};
+
+using Log = GpuScopeLog<StandInGpuClock>;
+
+}
+
+TEST_CASE(GpuScopeStatsAccumulateCountTotalAndMax) {
+    GpuScopeStats stats;
+    stats.Add(2.0, 0.5);
+    stats.Add(5.0, 1.5);
+    stats.Add(1.0, 0.0);
+
+    CHECK_EQ(stats.count, uint64_t(3));
+    CHECK_EQ(stats.totalGpuMs, 8.0);
+    CHECK_EQ(stats.maxGpuMs, 5.0);
+    CHECK_EQ(stats.totalSubmitLatencyMs, 2.0);
+}
+
+TEST_CASE(GpuScopeLogMeasuresGpuTimeAndTheLatencyFromRecording) {
+    Log log;
+
+    // Recorded at 1 ms on the CPU, runs on the GPU from 4 ms to 6.5 ms
+    log.GetClock().cpuTicks = 10000;
+    CHECK_EQ(log.Open("Clear"), 0u);
+    const std::vector<uint64_t> timestamps = {log.GetClock().GpuAt(4.0), log.GetClock().GpuAt(6.5)};
+
+    log.GetClock().cpuTicks = 100000;
+    log.Collect([&](uint32_t scope) {
+        CHECK_EQ(scope, 0u);
+        return timestamps.data();
+    });
+
+    CHECK_EQ(log.GetClock().numCalibrations, 1u);
+    const GpuScopeStats& stats = log.GetStats().at("Clear");
+    CHECK_EQ(stats.count, uint64_t(1));
+    CHECK_EQ(stats.totalGpuMs, 2.5);
+    CHECK_EQ(stats.totalSubmitLatencyMs, 3.0);
+}
+
+TEST_CASE(GpuScopeLogAggregatesScopesByNameAcrossCollects) {
+    Log log;
+    std::vector<uint64_t> timestamps;
+    const auto timestampsOf = [&](uint32_t scope) { return timestamps.data() + scope * 2; };
+
+    // Two copies and a clear in the first frame, all recorded at 0 ms
+    log.Open("Copy");
+    log.Open("Clear");
+    log.Open("Copy");
+    timestamps = {log.GetClock().GpuAt(1.0), log.GetClock().GpuAt(2.0),
+                  log.GetClock().GpuAt(2.0), log.GetClock().GpuAt(2.5),
+                  log.GetClock().GpuAt(3.0), log.GetClock().GpuAt(6.0)};
+    log.Collect(timestampsOf);
+    CHECK_EQ(log.NumOpen(), 0u);
+
+    // Scopes are numbered from 0 again
+    log.GetClock().cpuTicks = 200000;
+    CHECK_EQ(log.Open("Copy"), 0u);
+    timestamps = {log.GetClock().GpuAt(21.0), log.GetClock().GpuAt(23.0)};
+    log.Collect(timestampsOf);
+
+    CHECK_EQ(log.GetStats().size(), size_t(2));
+    const GpuScopeStats& copy = log.GetStats().at("Copy");
+    CHECK_EQ(copy.count, uint64_t(3));
+    CHECK_EQ(copy.totalGpuMs, 6.0);
+    CHECK_EQ(copy.maxGpuMs, 3.0);
+    // 1 ms, 3 ms and 1 ms from recording to the GPU starting
+    CHECK_EQ(copy.totalSubmitLatencyMs, 5.0);
+
+    const GpuScopeStats& clear = log.GetStats().at("Clear");
+    CHECK_EQ(clear.count, uint64_t(1));
+    CHECK_EQ(clear.totalGpuMs, 0.5);
+}
+
+TEST_CASE(GpuScopeLogCollectWithoutScopesOnlyCalibrates) {
+    Log log;
+    log.Collect([](uint32_t) -> const uint64_t* {
+        CHECK(false);
+        return nullptr;
+    });
+    CHECK_EQ(log.GetClock().numCalibrations, 1u);
+    CHECK(log.GetStats().empty());
+}
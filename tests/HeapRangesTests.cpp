@@ -0,0 +1,102 @@
+#include "../HeapRanges.h"
+#include "TestHarness.h"
+
+namespace {
+
+constexpr uint64_t HeapSize = 4096;
+constexpr uint64_t Alignment = 256;
+
+HeapRangeAllocator::Range Allocate(HeapRangeAllocator& heap, uint64_t size, uint64_t alignment = Alignment) {
+    HeapRangeAllocator::Range range;
+    CHECK(heap.Allocate(size, alignment, range));
+    return range;
+}
+
+}
+
+TEST_CASE(HeapRangesPlaceFirstFitAtTheAlignment) {
+    HeapRangeAllocator heap(HeapSize);
+
+    const auto first = Allocate(heap, 100);
+    const auto second = Allocate(heap, 1000);
+    CHECK_EQ(first.offset, uint64_t(0));
+    CHECK_EQ(first.size, uint64_t(100));
+    CHECK_EQ(second.offset, uint64_t(256));
+
+    // The padding behind the first placement stays free, and a small placement fills it before the tail
+    const auto third = Allocate(heap, 64, 64);
+    CHECK_EQ(third.offset, uint64_t(128));
+
+    const auto stats = heap.GetStats();
+    CHECK_EQ(stats.numPlacements, uint64_t(3));
+    CHECK_EQ(stats.bytesInUse, uint64_t(1164));
+    CHECK_EQ(stats.numFreeRanges, uint32_t(3));
+}
+
+TEST_CASE(HeapRangesCoalesceWithBothNeighboursOnFree) {
+    HeapRangeAllocator heap(HeapSize);
+
+    const auto first = Allocate(heap, 1024);
+    const auto second = Allocate(heap, 1024);
+    const auto third = Allocate(heap, 1024);
+    CHECK_EQ(heap.GetStats().numFreeRanges, uint32_t(1));
+
+    heap.Free(first);
+    heap.Free(third);
+    CHECK_EQ(heap.GetStats().numFreeRanges, uint32_t(2));
+    CHECK_EQ(heap.GetStats().largestFreeRange, uint64_t(2048));
+
+    // Freeing the middle merges all three with the tail into one range
+    heap.Free(second);
+    CHECK_EQ(heap.GetStats().numFreeRanges, uint32_t(1));
+    CHECK_EQ(heap.GetStats().largestFreeRange, HeapSize);
+    CHECK_EQ(Allocate(heap, HeapSize).offset, uint64_t(0));
+}
+
+TEST_CASE(HeapRangesFailWhenNoRangeFits) {
+    HeapRangeAllocator heap(HeapSize);
+
+    const auto first = Allocate(heap, 1024);
+    Allocate(heap, 1024);
+    heap.Free(first);
+
+    // 3072 bytes are free, but not in one range
+    HeapRangeAllocator::Range range;
+    CHECK(!heap.Allocate(3072, Alignment, range));
+    CHECK(!heap.Allocate(HeapSize + 1, Alignment, range));
+    CHECK_EQ(heap.GetStats().numPlacements, uint64_t(2));
+    CHECK_EQ(heap.GetStats().bytesInUse, uint64_t(1024));
+    CHECK(heap.Allocate(2048, Alignment, range));
+}
+
+TEST_CASE(HeapRangesRejectFreeingAFreeRange) {
+    HeapRangeAllocator heap(HeapSize);
+
+    const auto first = Allocate(heap, 1024);
+    heap.Free(first);
+    CHECK_THROWS(heap.Free(first));
+    CHECK_THROWS(heap.Free({512, 1024}));
+}
+
+TEST_CASE(HeapRangesReportUtilizationAndFragmentation) {
+    HeapRangeAllocator heap(HeapSize);
+    CHECK_EQ(heap.GetStats().Utilization(), 0.0);
+    CHECK_EQ(heap.GetStats().Fragmentation(), 0.0);
+
+    const auto first = Allocate(heap, 1024);
+    Allocate(heap, 1024);
+    CHECK_EQ(heap.GetStats().Utilization(), 0.5);
+    CHECK_EQ(heap.GetStats().Fragmentation(), 0.0);
+
+    // 1024 free at the front and 2048 at the back: the largest range is two thirds of the free bytes
+    heap.Free(first);
+    const auto stats = heap.GetStats();
+    CHECK_EQ(stats.Utilization(), 0.25);
+    CHECK(stats.Fragmentation() > 0.333 && stats.Fragmentation() < 0.334);
+    CHECK_EQ(stats.peakBytesInUse, uint64_t(2048));
+
+    Allocate(heap, 3072 - 1024);
+    Allocate(heap, 1024);
+    CHECK_EQ(heap.GetStats().Utilization(), 1.0);
+    CHECK_EQ(heap.GetStats().Fragmentation(), 0.0);
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "../CpuInteropBackend.h"
+#include "TestHarness.h"
+
+namespace {
+
+bool AllPassed(const std::vector<VerifyResult>& results) {
+    return std::all_of(results.begin(), results.end(), [](const VerifyResult& subres) { return subres.Passed(); });
+}
+
+const TextureArrayDesc MipmappedDesc = {64, 32, 3, TextureArrayDesc::FullMipChain(64, 32)};
+
+}
+
+TEST_CASE(CpuBackendClearsAndReadsBackEverySubresource) {
+    CpuInteropBackend backend;
+    const InteropBackend::TextureId texture = backend.CreateTextureArray(MipmappedDesc);
+
+    const std::vector<DirectX::XMFLOAT4> colors = {{1, 0, 0, 1}, {0, 1, 0, 1}, {0, 0, 1, 1}};
+    std::vector<uint32_t> rgbas;
+    for (const DirectX::XMFLOAT4& color : colors) {
+        const uint8_t components[] = {static_cast<uint8_t>(color.x * 255), static_cast<uint8_t>(color.y * 255),
+                                      static_cast<uint8_t>(color.z * 255), static_cast<uint8_t>(color.w * 255)};
+        rgbas.push_back(PackColor(MipmappedDesc.format, components));
+    }
+    for (uint32_t subres = 0; subres < MipmappedDesc.NumSubresources(); ++subres) {
+        backend.Clear(texture, subres, colors[MipmappedDesc.SliceOf(subres)]);
+    }
+
+    CHECK(AllPassed(TryBackendReadback(backend, texture, MipmappedDesc, rgbas.data())));
+    CHECK(AllPassed(TryBackendSliceReadback(backend, texture, MipmappedDesc, rgbas.data())));
+
+    // A wrong expectation has to show up as failed texels, not pass silently
+    std::vector<uint32_t> wrongRgbas(rgbas.rbegin(), rgbas.rend());
+    CHECK(!AllPassed(TryBackendReadback(backend, texture, MipmappedDesc, wrongRgbas.data())));
+}
+
+TEST_CASE(CpuBackendPadsRowsToThePitchAlignment) {
+    CpuInteropBackend backend;
+    const TextureArrayDesc desc = {65, 3, 1, 2};
+    const InteropBackend::TextureId texture = backend.CreateTextureArray(desc);
+
+    std::vector<uint32_t> rowPitches;
+    backend.ReadBack(texture, 0, desc.NumSubresources(), [&](uint32_t, const void*, uint32_t rowPitch) { rowPitches.push_back(rowPitch); });
+    CHECK_EQ(rowPitches.size(), size_t(2));
+    CHECK_EQ(rowPitches[0], 512u);
+    CHECK_EQ(rowPitches[1], CpuInteropBackend::RowPitchAlignment);
+}
+
+TEST_CASE(CpuBackendSharedOpenAliasesTheProducer) {
+    CpuInteropBackend backend;
+    const InteropBackend::TextureId producer = backend.CreateTextureArray(MipmappedDesc);
+    const InteropBackend::TextureId shared = backend.OpenShared(producer);
+
+    for (uint32_t subres = 0; subres < MipmappedDesc.NumSubresources(); ++subres) {
+        backend.Clear(producer, subres, {1, 1, 1, 1});
+    }
+    const std::vector<uint32_t> white(MipmappedDesc.arraySize, 0xFFFFFFFF);
+    CHECK(AllPassed(TryBackendReadback(backend, shared, MipmappedDesc, white.data())));
+}
+
+TEST_CASE(CpuBackendRecordsUntilSubmit) {
+    CpuInteropBackend backend;
+    const TextureArrayDesc desc = {16, 16, 1};
+    const InteropBackend::TextureId src = backend.CreateTextureArray(desc);
+    const InteropBackend::TextureId dst = backend.CreateTextureArray(desc);
+
+    backend.Clear(src, 0, {1, 1, 1, 1});
+    backend.CopySubresource(dst, 0, src, 0);
+    // Nothing ran yet, so the fence for the next submit was never signaled
+    CHECK_THROWS(backend.WaitForFence(1));
+
+    const uint64_t fence = backend.Submit();
+    backend.WaitForFence(fence);
+    const uint32_t white = 0xFFFFFFFF;
+    CHECK(AllPassed(TryBackendReadback(backend, dst, desc, &white)));
+}
+
+TEST_CASE(CpuBackendCopyRejectsMismatchedSubresources) {
+    CpuInteropBackend backend;
+    const InteropBackend::TextureId src = backend.CreateTextureArray(MipmappedDesc);
+    const InteropBackend::TextureId dst = backend.CreateTextureArray(MipmappedDesc);
+
+    backend.CopySubresource(dst, 1, src, 0);
+    CHECK_THROWS(backend.Submit());
+}
+
+TEST_CASE(CpuBackendRunsTheBackendTestMatrix) {
+    for (const TextureArrayDesc& desc : {TextureArrayDesc{32, 32, 2}, MipmappedDesc,
+                                         TextureArrayDesc{48, 16, 4, 1, DXGI_FORMAT_B8G8R8A8_UNORM}}) {
+        CpuInteropBackend backend;
+        BenchmarkReport report;
+        CHECK(BackendTextureArrayTest(backend, desc, 3, 1, &report));
+    }
+}
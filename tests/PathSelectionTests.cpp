@@ -0,0 +1,106 @@
+#include <cstdio>
+
+#include "../CpuInteropBackend.h"
+#include "../PathSelection.h"
+#include "TestHarness.h"
+
+namespace {
+
+const char* const DecisionFile = "PathSelectionTests_Decisions.txt";
+
+// A stand-in for the GPU paths: every run reads the CPU backend's array back and advances a synthetic clock by the
+// path's latency, so the selector's timing is deterministic
+class SyntheticPaths {
+public:
+    explicit SyntheticPaths(const TextureArrayDesc& desc) : m_desc(desc), m_texture(m_backend.CreateTextureArray(desc)) {
+        m_rgbas.assign(desc.arraySize, 0xFFFFFFFF);
+        for (uint32_t subres = 0; subres < desc.NumSubresources(); ++subres) {
+            m_backend.Clear(m_texture, subres, {1, 1, 1, 1});
+        }
+    }
+
+    double NowMs() const {
+        return m_nowMs;
+    }
+
+    InteropPathSelector::Candidate Path(const char* id, double latencyMs, bool correct = true) {
+        return {id, [this, latencyMs, correct] {
+                    m_nowMs += latencyMs;
+                    const std::vector<uint32_t> wrongRgbas(m_desc.arraySize, 0);
+                    return TryBackendReadback(m_backend, m_texture, m_desc, correct ? m_rgbas.data() : wrongRgbas.data());
+                }};
+    }
+
+private:
+    TextureArrayDesc m_desc;
+    CpuInteropBackend m_backend;
+    InteropBackend::TextureId m_texture;
+    std::vector<uint32_t> m_rgbas;
+    double m_nowMs = 0;
+};
+
+}
+
+TEST_CASE(PickFastestPathSkipsIncorrectPaths) {
+    CHECK_EQ(PickFastestPath({{"a", true, 3.0}, {"b", false, 1.0}, {"c", true, 2.0}}), std::string("c"));
+    CHECK_EQ(PickFastestPath({{"a", false, 3.0}}), std::string());
+    CHECK_EQ(PickFastestPath({}), std::string());
+}
+
+TEST_CASE(ZeroCopyReadbackNeedsCacheCoherentUma) {
+    // Discrete
+    CHECK(!ZeroCopyReadbackSupported(false, false));
+    CHECK(!ZeroCopyReadbackSupported(false, true));
+    // UMA whose CPU mapping would be write-combined
+    CHECK(!ZeroCopyReadbackSupported(true, false));
+    CHECK(ZeroCopyReadbackSupported(true, true));
+}
+
+TEST_CASE(PathSelectorPicksTheFastestCorrectCandidate) {
+    std::remove(DecisionFile);
+    const TextureArrayDesc desc = {64, 64, 2, 2};
+    SyntheticPaths paths(desc);
+
+    {
+        InteropPathSelector selector(DecisionFile, 2, 100, 3, [&] { return paths.NowMs(); });
+        const InteropPathSelector::Selection selection =
+            selector.Select(desc, {paths.Path("slow", 5.0), paths.Path("broken", 0.5, false), paths.Path("fast", 1.0)});
+        CHECK_EQ(selection.id, std::string("fast"));
+        CHECK(!selection.fromCache);
+        CHECK_EQ(selection.measurements.size(), size_t(3));
+        CHECK_EQ(selection.measurements[0].medianMs, 5.0);
+        CHECK(!selection.measurements[1].correct);
+    }
+
+    // A new selector with the same tier and driver reuses the decision without running anything
+    InteropPathSelector selector(DecisionFile, 2, 100, 3, [&] { return paths.NowMs(); });
+    const double before = paths.NowMs();
+    const InteropPathSelector::Selection selection = selector.Select(desc, {paths.Path("slow", 5.0), paths.Path("fast", 1.0)});
+    CHECK_EQ(selection.id, std::string("fast"));
+    CHECK(selection.fromCache);
+    CHECK_EQ(paths.NowMs(), before);
+
+    // Once the cached path is no longer a candidate, the remaining ones are measured again
+    CHECK_EQ(selector.Select(desc, {paths.Path("slow", 5.0)}).id, std::string("slow"));
+    std::remove(DecisionFile);
+}
+
+TEST_CASE(PathSelectorKeysDecisionsByTheWholeDescription) {
+    InteropPathSelector selector(DecisionFile, 2, 100);
+    TextureArrayDesc desc;
+    const std::string key = selector.Key(desc);
+    CHECK(key.find(FormatName(desc.format)) != std::string::npos);
+
+    TextureArrayDesc otherFormat = desc;
+    otherFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    TextureArrayDesc otherMips = desc;
+    otherMips.mipLevels = 2;
+    TextureArrayDesc otherSamples = desc;
+    otherSamples.sampleCount = 4;
+    CHECK(selector.Key(otherFormat) != key);
+    CHECK(selector.Key(otherMips) != key);
+    CHECK(selector.Key(otherSamples) != key);
+
+    CHECK(InteropPathSelector(DecisionFile, 3, 100).Key(desc) != key);
+    CHECK(InteropPathSelector(DecisionFile, 2, 101).Key(desc) != key);
+}
@@ -0,0 +1,105 @@
+#include <utility>
+#include <vector>
+
+#include "../ReadbackFrames.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+namespace {
+
+// What D3D12ReadbackPipeline::Submit() does around recording the copies into the acquired slot
+template <typename Consume>
+uint64_t SubmitFrame(ReadbackFrameRing& frames, StandInTimeline& timeline, Consume&& consume) {
+    frames.Acquire(timeline, consume);
+    return frames.Commit(timeline.Signal());
+}
+
+// Remembers the frames it consumed, as (slot, frame ID)
+struct Consumed {
+    std::vector<std::pair<uint32_t, uint64_t>> frames;
+
+    auto Func() {
+        return [this](uint32_t slot, uint64_t frameId) { frames.push_back({slot, frameId}); };
+    }
+};
+
+}
+
+TEST_CASE(ReadbackFramesNumberFramesInSubmissionOrder) {
+    StandInTimeline timeline;
+    ReadbackFrameRing frames(3);
+    Consumed consumed;
+
+    for (uint64_t frame = 0; frame < 7; ++frame) {
+        CHECK_EQ(SubmitFrame(frames, timeline, consumed.Func()), frame);
+    }
+    frames.Drain(timeline, consumed.Func());
+
+    CHECK_EQ(consumed.frames.size(), size_t(7));
+    for (uint32_t i = 0; i < consumed.frames.size(); ++i) {
+        CHECK_EQ(consumed.frames[i].first, i % 3);
+        CHECK_EQ(consumed.frames[i].second, uint64_t(i));
+    }
+}
+
+TEST_CASE(ReadbackFramesBlockOnlyWhenEveryFrameIsInFlight) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 100;
+    ReadbackFrameRing frames(3);
+    Consumed consumed;
+
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        SubmitFrame(frames, timeline, consumed.Func());
+        timeline.GetFence().Advance(10);
+    }
+    CHECK_EQ(frames.NumInFlight(), 3u);
+    CHECK_EQ(timeline.GetFence().numWaits, 0u);
+    CHECK(consumed.frames.empty());
+
+    // The fourth frame waits for the oldest and consumes it to reuse its slot
+    SubmitFrame(frames, timeline, consumed.Func());
+    CHECK_EQ(timeline.GetFence().numWaits, 1u);
+    CHECK_EQ(consumed.frames.size(), size_t(1));
+    CHECK_EQ(consumed.frames[0].second, uint64_t(0));
+    CHECK_EQ(frames.NumInFlight(), 3u);
+    // Only the oldest frame was waited for, not the newer ones
+    CHECK(!timeline.IsComplete(frames.FenceValue(1)));
+}
+
+TEST_CASE(ReadbackFramesPollOnlyConsumesFinishedFramesAndDrainTheRest) {
+    StandInTimeline timeline;
+    timeline.GetFence().latencyMs = 10;
+    ReadbackFrameRing frames(4);
+    Consumed consumed;
+
+    SubmitFrame(frames, timeline, consumed.Func());
+    SubmitFrame(frames, timeline, consumed.Func());
+    timeline.GetFence().Advance(10);
+    SubmitFrame(frames, timeline, consumed.Func());
+
+    // The first two finished, the third is still on the GPU
+    frames.Poll(timeline, consumed.Func());
+    CHECK_EQ(consumed.frames.size(), size_t(2));
+    CHECK_EQ(timeline.GetFence().numWaits, 0u);
+    CHECK_EQ(frames.NumInFlight(), 1u);
+
+    frames.Poll(timeline, consumed.Func());
+    CHECK_EQ(consumed.frames.size(), size_t(2));
+
+    SubmitFrame(frames, timeline, consumed.Func());
+    frames.Drain(timeline, consumed.Func());
+    CHECK_EQ(consumed.frames.size(), size_t(4));
+    CHECK_EQ(consumed.frames[2].second, uint64_t(2));
+    CHECK_EQ(consumed.frames[3].second, uint64_t(3));
+    CHECK_EQ(frames.NumInFlight(), 0u);
+    CHECK(!frames.InFlight(2));
+}
+
+TEST_CASE(ReadbackFramesRejectCommittingMoreFramesThanSlots) {
+    StandInTimeline timeline;
+    ReadbackFrameRing frames(1);
+
+    frames.Commit(timeline.Signal());
+    CHECK_THROWS(frames.Commit(timeline.Signal()));
+    CHECK_THROWS(ReadbackFrameRing(0));
+}
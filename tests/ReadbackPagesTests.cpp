@@ -0,0 +1,75 @@
+#include "../ReadbackPages.h"
+#include "TestHarness.h"
+
+namespace {
+
+constexpr uint64_t PageSize = 1024;
+constexpr uint64_t Alignment = 256;
+
+}
+
+TEST_CASE(ReadbackPagesBumpAlignedAllocationsWithinAPage) {
+    ReadbackPageAllocator allocator(PageSize);
+    const auto never = [](uint64_t) { return false; };
+
+    const auto first = allocator.Allocate(100, Alignment, never);
+    const auto second = allocator.Allocate(100, Alignment, never);
+    CHECK_EQ(first.page, uint32_t(0));
+    CHECK_EQ(first.offset, uint64_t(0));
+    CHECK_EQ(second.page, uint32_t(0));
+    CHECK_EQ(second.offset, uint64_t(256));
+    CHECK_EQ(allocator.NumPages(), uint32_t(1));
+    CHECK_EQ(allocator.GetStats().bytesInUse, uint64_t(200));
+
+    // Doesn't fit behind the second one
+    const auto third = allocator.Allocate(700, Alignment, never);
+    CHECK_EQ(third.page, uint32_t(1));
+    CHECK_EQ(allocator.GetStats().numHits, uint64_t(1));
+}
+
+TEST_CASE(ReadbackPagesRewindOnlyOnceTheLastReleaseRetired) {
+    ReadbackPageAllocator allocator(PageSize);
+    uint64_t completedFenceValue = 0;
+    const auto isComplete = [&](uint64_t fenceValue) { return fenceValue <= completedFenceValue; };
+
+    const auto first = allocator.Allocate(512, Alignment, isComplete);
+    const auto second = allocator.Allocate(512, Alignment, isComplete);
+    allocator.Release(first, 1);
+    allocator.Release(second, 2);
+
+    // The page is empty but the GPU may still write the second region
+    completedFenceValue = 1;
+    CHECK_EQ(allocator.Allocate(512, Alignment, isComplete).page, uint32_t(1));
+
+    completedFenceValue = 2;
+    const auto reused = allocator.Allocate(512, Alignment, isComplete);
+    CHECK_EQ(reused.page, uint32_t(0));
+    CHECK_EQ(reused.offset, uint64_t(0));
+    CHECK_EQ(allocator.RetireFenceValue(0), uint64_t(2));
+}
+
+TEST_CASE(ReadbackPagesKeepAPageWithLiveAllocations) {
+    ReadbackPageAllocator allocator(PageSize);
+    const auto always = [](uint64_t) { return true; };
+
+    const auto first = allocator.Allocate(512, Alignment, always);
+    const auto second = allocator.Allocate(512, Alignment, always);
+    allocator.Release(first, 1);
+    CHECK_EQ(allocator.Allocate(512, Alignment, always).page, uint32_t(1));
+
+    allocator.Release(second, 1);
+    CHECK_EQ(allocator.GetStats().bytesInUse, uint64_t(512));
+    CHECK_EQ(allocator.GetStats().peakBytesInUse, uint64_t(1024));
+}
+
+TEST_CASE(ReadbackPagesGrowForAllocationsLargerThanAPage) {
+    ReadbackPageAllocator allocator(PageSize);
+    const auto always = [](uint64_t) { return true; };
+
+    const auto large = allocator.Allocate(3000, Alignment, always);
+    CHECK_EQ(large.page, uint32_t(0));
+    CHECK_EQ(allocator.PageSize(0), uint64_t(3000));
+    CHECK_EQ(allocator.GetStats().reservedBytes, uint64_t(3000));
+    CHECK_EQ(allocator.GetStats().numPagesCreated, uint64_t(1));
+    CHECK_EQ(allocator.GetStats().HitRate(), 0.0);
+}
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "../SharedHandles.h"
+#include "TestHarness.h"
+
+namespace {
+
+// A table of open handles, standing in for the NT handles the OS hands out for shared resources
+struct StandInHandleTable {
+    uint32_t Open() {
+        live.insert(nextHandle);
+        return nextHandle++;
+    }
+
+    void Close(uint32_t handle) {
+        CHECK_EQ(live.erase(handle), size_t(1));
+    }
+
+    std::set<uint32_t> live;
+    uint32_t nextHandle = 1;
+};
+
+// Closes its handle when destroyed, like winrt::handle
+class StandInHandle {
+public:
+    StandInHandle(StandInHandleTable& table, uint32_t handle) : m_table(&table), m_handle(handle) {
+    }
+
+    StandInHandle(StandInHandle&& other) noexcept : m_table(other.m_table), m_handle(other.m_handle) {
+        other.m_table = nullptr;
+    }
+
+    StandInHandle& operator=(StandInHandle&&) = delete;
+
+    ~StandInHandle() {
+        if (m_table != nullptr) {
+            m_table->Close(m_handle);
+        }
+    }
+
+    uint32_t Get() const {
+        return m_handle;
+    }
+
+private:
+    StandInHandleTable* m_table;
+    uint32_t m_handle;
+};
+
+// Shares a resource, named by a string, by opening a handle for it and "opening" the handle as a texture ID
+class StandInSharing {
+public:
+    using Resource = std::string;
+    using Opened = uint32_t;
+
+    struct Entry {
+        StandInHandle sharedHandle;
+        Opened opened;
+    };
+
+    explicit StandInSharing(StandInHandleTable& table) : m_table(table) {
+    }
+
+    Entry Share(const std::string&) {
+        StandInHandle handle(m_table, m_table.Open());
+        const Opened opened = handle.Get() * 100;
+        return Entry{std::move(handle), opened};
+    }
+
+private:
+    StandInHandleTable& m_table;
+};
+
+using Registry = SharedHandleRegistry<StandInSharing>;
+
+}
+
+TEST_CASE(SharedHandlesOpenEachResourceOnceAndHitAfterwards) {
+    StandInHandleTable table;
+    Registry registry(table);
+
+    const uint32_t color = registry.Open("color");
+    const uint32_t depth = registry.Open("depth");
+    CHECK(color != depth);
+    CHECK_EQ(registry.Open("color"), color);
+    CHECK_EQ(registry.Open("color"), color);
+
+    CHECK_EQ(registry.GetStats().numOpens, uint64_t(2));
+    CHECK_EQ(registry.GetStats().numHits, uint64_t(2));
+    CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(2));
+    CHECK_EQ(table.live.size(), size_t(2));
+}
+
+TEST_CASE(SharedHandlesCloseTheHandleOnRelease) {
+    StandInHandleTable table;
+    Registry registry(table);
+
+    const uint32_t color = registry.Open("color");
+    registry.Open("depth");
+
+    registry.Release("color");
+    CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(1));
+    CHECK_EQ(table.live.size(), size_t(1));
+
+    // Releasing an unknown or already released resource changes nothing
+    registry.Release("color");
+    registry.Release("normals");
+    CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(1));
+
+    registry.Release("depth");
+    CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(0));
+    CHECK(table.live.empty());
+
+    // A released resource is shared again with a new handle
+    CHECK(registry.Open("color") != color);
+    CHECK_EQ(registry.GetStats().numOpens, uint64_t(3));
+    CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(1));
+}
+
+TEST_CASE(SharedHandlesCloseEveryHandleOnClearAndDestruction) {
+    StandInHandleTable table;
+    {
+        Registry registry(table);
+        registry.Open("a");
+        registry.Open("b");
+        registry.Open("c");
+
+        registry.Clear();
+        CHECK_EQ(registry.GetStats().numLiveHandles, uint64_t(0));
+        CHECK(table.live.empty());
+
+        registry.Open("a");
+        registry.Open("b");
+        CHECK_EQ(table.live.size(), size_t(2));
+    }
+    CHECK(table.live.empty());
+}
@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <set>
+#include <tuple>
+
+#include "../SlicePool.h"
+#include "StandInFence.h"
+#include "TestHarness.h"
+
+namespace {
+
+struct StandInSliceDesc {
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// A device that numbers the slices it creates and tracks which of them exist
+class StandInSliceDevice {
+public:
+    using Slice = uint32_t;
+    using Desc = StandInSliceDesc;
+    using Key = std::tuple<uint32_t, uint32_t>;
+
+    explicit StandInSliceDevice(std::set<uint32_t>& live) : m_live(live) {
+    }
+
+    Key KeyOf(const Desc& desc) const {
+        return {desc.width, desc.height};
+    }
+
+    Slice CreateSlice(const Desc&) {
+        m_live.insert(m_nextSlice);
+        return m_nextSlice++;
+    }
+
+    void DestroySlice(Slice& slice) {
+        CHECK_EQ(m_live.erase(slice), size_t(1));
+    }
+
+private:
+    std::set<uint32_t>& m_live;
+    uint32_t m_nextSlice = 0;
+};
+
+using Pool = FencedSlicePool<StandInSliceDevice, StandInTimeline>;
+
+}
+
+TEST_CASE(SlicePoolReusesASliceOnlyAfterItsFenceValueRetires) {
+    StandInTimeline timeline;
+    std::set<uint32_t> live;
+    Pool pool(timeline, live);
+    const StandInSliceDesc desc{256, 256};
+
+    const uint32_t first = pool.Acquire(desc);
+    pool.Release(first, desc, timeline.Signal());
+
+    // The copy out of the slice is still on the GPU, so it gets a new one
+    const uint32_t second = pool.Acquire(desc);
+    CHECK(second != first);
+    CHECK_EQ(pool.GetStats().numCreated, uint64_t(2));
+
+    timeline.GetFence().Advance(10);
+    CHECK_EQ(pool.Acquire(desc), first);
+    CHECK_EQ(pool.GetStats().numAcquires, uint64_t(3));
+    CHECK_EQ(pool.GetStats().numCreated, uint64_t(2));
+    // Acquiring never waits for the GPU
+    CHECK_EQ(timeline.GetFence().numWaits, 0u);
+}
+
+TEST_CASE(SlicePoolHandsOutOnlyTheSlicesWhoseUseRetired) {
+    StandInTimeline timeline;
+    std::set<uint32_t> live;
+    Pool pool(timeline, live);
+    const StandInSliceDesc desc{64, 64};
+
+    const uint32_t early = pool.Acquire(desc);
+    const uint32_t late = pool.Acquire(desc);
+    pool.Release(early, desc, timeline.Signal());
+    timeline.GetFence().Advance(5);
+    pool.Release(late, desc, timeline.Signal());
+
+    // Only the first copy has finished
+    timeline.GetFence().Advance(5);
+    CHECK_EQ(pool.Acquire(desc), early);
+    const uint32_t created = pool.Acquire(desc);
+    CHECK(created != late);
+    CHECK_EQ(pool.GetStats().numCreated, uint64_t(3));
+
+    timeline.GetFence().Advance(5);
+    CHECK_EQ(pool.Acquire(desc), late);
+}
+
+TEST_CASE(SlicePoolKeepsSlicesOfDifferentDescriptionsApart) {
+    StandInTimeline timeline;
+    std::set<uint32_t> live;
+    Pool pool(timeline, live);
+
+    const uint32_t slice = pool.Acquire({64, 64});
+    pool.Release(slice, {64, 64}, timeline.Signal());
+    timeline.GetFence().Advance(10);
+
+    CHECK(pool.Acquire({64, 32}) != slice);
+    CHECK_EQ(pool.Acquire({64, 64}), slice);
+}
+
+TEST_CASE(SlicePoolWaitsForOutstandingUsesBeforeDestroyingItsSlices) {
+    StandInTimeline timeline;
+    std::set<uint32_t> live;
+    {
+        Pool pool(timeline, live);
+        const StandInSliceDesc desc{64, 64};
+        const uint32_t first = pool.Acquire(desc);
+        const uint32_t second = pool.Acquire(desc);
+        pool.Release(first, desc, timeline.Signal());
+        pool.Release(second, desc, timeline.Signal());
+        CHECK_EQ(live.size(), size_t(2));
+    }
+    CHECK(live.empty());
+    CHECK(timeline.IsComplete(timeline.LastSignaled()));
+    CHECK(timeline.GetFence().numWaits > 0u);
+}
@@ -0,0 +1,178 @@
+#include <memory>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "../StagingReadback.h"
+#include "TestHarness.h"
+
+namespace {
+
+struct StandInDesc {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;
+};
+
+struct StandInTexture {
+    uint32_t id = 0;
+    StandInDesc desc;
+};
+
+// A device that numbers the staging textures it creates
+class StandInStagingDevice {
+public:
+    using Texture = std::unique_ptr<StandInTexture>;
+    using Desc = StandInDesc;
+    using Key = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+    Key KeyOf(const Desc& desc) const {
+        return {desc.width, desc.height, desc.format};
+    }
+
+    Desc DescOf(const Texture& texture) const {
+        return texture->desc;
+    }
+
+    Texture CreateStaging(const Desc& desc) {
+        return std::make_unique<StandInTexture>(StandInTexture{m_nextId++, desc});
+    }
+
+private:
+    uint32_t m_nextId = 0;
+};
+
+// A context whose copies land after a given number of busy maps per subresource, like D3D11_MAP_FLAG_DO_NOT_WAIT
+// returning DXGI_ERROR_WAS_STILL_DRAWING until the GPU is done. Tracks which subresources are mapped.
+class StandInStagingContext {
+public:
+    struct Mapped {
+        uint32_t subres = 0;
+    };
+
+    void Flush() {
+        ++numFlushes;
+    }
+
+    bool TryMap(uint32_t subres, Mapped& mapped) {
+        CHECK(m_mapped.count(subres) == 0);
+        if (busyMaps[subres] > 0) {
+            --busyMaps[subres];
+            return false;
+        }
+        m_mapped.insert(subres);
+        mapped.subres = subres;
+        return true;
+    }
+
+    void Unmap(uint32_t subres) {
+        CHECK_EQ(m_mapped.erase(subres), size_t(1));
+    }
+
+    bool AnyMapped() const {
+        return !m_mapped.empty();
+    }
+
+    std::vector<uint32_t> busyMaps = std::vector<uint32_t>(8);
+    uint32_t numFlushes = 0;
+
+private:
+    std::set<uint32_t> m_mapped;
+};
+
+using Readback = StagingReadback<StandInStagingContext>;
+
+}
+
+TEST_CASE(StagingPoolReusesReleasedTexturesOfTheSameDescription) {
+    StagingPool<StandInStagingDevice> pool;
+    const StandInDesc desc{64, 64, 28};
+
+    auto first = pool.Acquire(desc);
+    auto second = pool.Acquire(desc);
+    CHECK(first->id != second->id);
+
+    const uint32_t firstId = first->id;
+    pool.Release(std::move(first));
+    const auto reused = pool.Acquire(desc);
+    CHECK_EQ(reused->id, firstId);
+
+    // A different size or format gets its own texture
+    const auto narrower = pool.Acquire({32, 64, 28});
+    const auto otherFormat = pool.Acquire({64, 64, 87});
+    CHECK_EQ(narrower->id, 2u);
+    CHECK_EQ(otherFormat->id, 3u);
+
+    CHECK_EQ(pool.GetStats().numAcquires, uint64_t(5));
+    CHECK_EQ(pool.GetStats().numCreated, uint64_t(4));
+}
+
+TEST_CASE(StagingReadbackGoesFromIdleThroughPendingToDone) {
+    Readback readback;
+    std::vector<uint32_t> consumed;
+    const auto consume = [&](uint32_t subres, const StandInStagingContext::Mapped& mapped) {
+        CHECK_EQ(mapped.subres, subres);
+        consumed.push_back(subres);
+    };
+
+    CHECK(readback.GetState() == Readback::State::Idle);
+    CHECK(!readback.Poll(consume));
+    CHECK(readback.GetState() == Readback::State::Idle);
+
+    readback.Issue({0, 1, 2});
+    CHECK_EQ(readback.GetContext().numFlushes, 1u);
+    CHECK(readback.GetState() == Readback::State::Pending);
+
+    CHECK(readback.Poll(consume));
+    CHECK(readback.GetState() == Readback::State::Done);
+    CHECK_EQ(consumed.size(), size_t(3));
+    CHECK(!readback.GetContext().AnyMapped());
+
+    // Done stays done without mapping again
+    CHECK(readback.Poll(consume));
+    CHECK_EQ(consumed.size(), size_t(3));
+    CHECK_EQ(readback.NumBusyPolls(), uint64_t(0));
+}
+
+TEST_CASE(StagingReadbackResumesWithTheSubresourceThatWasStillDrawing) {
+    Readback readback;
+    readback.GetContext().busyMaps[4] = 2;
+    readback.GetContext().busyMaps[6] = 1;
+    std::vector<uint32_t> consumed;
+    const auto consume = [&](uint32_t subres, const StandInStagingContext::Mapped&) { consumed.push_back(subres); };
+
+    readback.Issue({3, 4, 5, 6});
+
+    // Subresource 3 landed, 4 is still drawing
+    CHECK(!readback.Poll(consume));
+    CHECK(consumed == (std::vector<uint32_t>{3}));
+    CHECK(readback.GetState() == Readback::State::Pending);
+    CHECK(!readback.GetContext().AnyMapped());
+
+    CHECK(!readback.Poll(consume));
+    CHECK_EQ(consumed.size(), size_t(1));
+
+    // 4 and 5 land, 6 is still drawing
+    CHECK(!readback.Poll(consume));
+    CHECK(consumed == (std::vector<uint32_t>{3, 4, 5}));
+
+    CHECK(readback.Poll(consume));
+    CHECK(consumed == (std::vector<uint32_t>{3, 4, 5, 6}));
+    CHECK_EQ(readback.NumBusyPolls(), uint64_t(3));
+}
+
+TEST_CASE(StagingReadbackRestartsOnANewIssue) {
+    Readback readback;
+    readback.GetContext().busyMaps[1] = 1;
+    std::vector<uint32_t> consumed;
+    const auto consume = [&](uint32_t subres, const StandInStagingContext::Mapped&) { consumed.push_back(subres); };
+
+    readback.Issue({0, 1});
+    CHECK(!readback.Poll(consume));
+
+    readback.Issue({2});
+    CHECK_EQ(readback.GetContext().numFlushes, 2u);
+    CHECK(readback.Poll(consume));
+    CHECK(consumed == (std::vector<uint32_t>{0, 2}));
+    CHECK_EQ(readback.NumBusyPolls(), uint64_t(1));
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+
+#include "../FenceTimeline.h"
+#include "TestHarness.h"
+
+// A stand-in fence on a simulated clock. Each signaled value completes `latencyMs` after it was queued, and a wait
+// moves the clock to the value's completion or to the timeout, whichever comes first. Waits can be made to wake up
+// early, like the D3D12 event still carrying the signal of an earlier timed out wait.
+class StandInFence {
+public:
+    void Signal(uint64_t value) {
+        m_completesAtMs[value] = m_nowMs + latencyMs;
+    }
+
+    uint64_t CompletedValue() {
+        ++numCompletedQueries;
+        uint64_t completed = 0;
+        for (const auto& [value, completesAtMs] : m_completesAtMs) {
+            if (completesAtMs <= m_nowMs) {
+                completed = std::max(completed, value);
+            }
+        }
+        return completed;
+    }
+
+    bool Wait(uint64_t value, uint32_t timeoutMs) {
+        ++numWaits;
+        if (numSpuriousWakeups > 0) {
+            --numSpuriousWakeups;
+            return true;
+        }
+
+        // Values complete in order, so the first one at or above the awaited value completes it
+        auto iter = m_completesAtMs.lower_bound(value);
+        if (iter == m_completesAtMs.end()) {
+            CHECK(timeoutMs != InfiniteTimeoutMs);
+            m_nowMs += timeoutMs;
+            return false;
+        }
+        if ((timeoutMs != InfiniteTimeoutMs) && (iter->second > m_nowMs + timeoutMs)) {
+            m_nowMs += timeoutMs;
+            return false;
+        }
+        m_nowMs = std::max(m_nowMs, iter->second);
+        return true;
+    }
+
+    uint64_t NowMs() const {
+        return m_nowMs;
+    }
+
+    void Advance(uint64_t ms) {
+        m_nowMs += ms;
+    }
+
+    uint64_t latencyMs = 10;
+    uint32_t numSpuriousWakeups = 0;
+    uint32_t numWaits = 0;
+    uint32_t numCompletedQueries = 0;
+
+private:
+    uint64_t m_nowMs = 0;
+    std::map<uint64_t, uint64_t> m_completesAtMs;
+};
+
+// The queue timeline the portable parts of the D3D12 wrappers are tested against
+using StandInTimeline = FenceTimeline<StandInFence>;
@@ -0,0 +1,113 @@
+#include <string>
+
+#include "../SubresourceStateTracker.h"
+#include "TestHarness.h"
+
+namespace {
+
+// Stand-ins for ID3D12Resource* and D3D12_RESOURCE_STATES
+enum State { RenderTarget, CopySource, CopyDest, Common };
+
+using Tracker = SubresourceStateTracker<int, State>;
+
+constexpr int Texture = 1;
+constexpr int OtherTexture = 2;
+constexpr uint32_t NumSubres = 6;
+
+std::string Describe(const std::vector<Tracker::Change>& changes) {
+    std::string ret;
+    for (const auto& change : changes) {
+        ret += std::to_string(change.resource) + ":" +
+               (change.subres == Tracker::AllSubresources ? std::string("all") : std::to_string(change.subres)) + ":" +
+               std::to_string(change.before) + "->" + std::to_string(change.after) + " ";
+    }
+    return ret;
+}
+
+}
+
+TEST_CASE(StateTrackerFoldsUniformTransitionsIntoOneBarrier) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+
+    // The direct copy transitions every subresource on its own; one folded barrier reaches the list
+    for (uint32_t subres = 0; subres < NumSubres; ++subres) {
+        tracker.Transition(Texture, subres, CopySource);
+    }
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:all:0->1 "));
+
+    tracker.Transition(Texture, Tracker::AllSubresources, RenderTarget);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:all:1->0 "));
+
+    CHECK_EQ(tracker.GetStats().numTransitions, uint64_t(NumSubres + 1));
+    CHECK_EQ(tracker.GetStats().numBarriers, uint64_t(2));
+    CHECK_EQ(tracker.GetStats().numBarrierCalls, uint64_t(2));
+}
+
+TEST_CASE(StateTrackerEmitsOnlyTheSubresourcesThatMoved) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+
+    // One slice of a three-mip array leaves RENDER_TARGET, the way the intermediate path batches slices
+    tracker.Transition(Texture, 3, CopySource);
+    tracker.Transition(Texture, 4, CopySource);
+    tracker.Transition(Texture, 5, CopySource);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:3:0->1 1:4:0->1 1:5:0->1 "));
+
+    // Every subresource changed, but not the same way, so nothing folds
+    tracker.Transition(Texture, Tracker::AllSubresources, CopyDest);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:0:0->2 1:1:0->2 1:2:0->2 1:3:1->2 1:4:1->2 1:5:1->2 "));
+}
+
+TEST_CASE(StateTrackerDropsTransitionsUndoneBeforeTheFlush) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+
+    tracker.Transition(Texture, Tracker::AllSubresources, CopySource);
+    tracker.Transition(Texture, Tracker::AllSubresources, RenderTarget);
+    CHECK(tracker.Collect().empty());
+    CHECK_EQ(tracker.GetStats().numBarrierCalls, uint64_t(0));
+
+    // Nothing is left pending after a flush
+    tracker.Transition(Texture, 2, CopySource);
+    CHECK_EQ(tracker.Collect().size(), size_t(1));
+    CHECK(tracker.Collect().empty());
+}
+
+TEST_CASE(StateTrackerKeepsOneChangeListPerResource) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+    tracker.Register(OtherTexture, 1, RenderTarget);
+
+    // A copy between two textures: both move in one barrier call
+    tracker.Transition(Texture, Tracker::AllSubresources, CopySource);
+    tracker.Transition(OtherTexture, 0, CopyDest);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:all:0->1 2:0:0->2 "));
+    CHECK_EQ(tracker.GetStats().numBarrierCalls, uint64_t(1));
+
+    tracker.Unregister(OtherTexture);
+    CHECK(!tracker.IsRegistered(OtherTexture));
+    CHECK_THROWS(tracker.Transition(OtherTexture, 0, RenderTarget));
+}
+
+TEST_CASE(StateTrackerAssumesImplicitTransitionsWithoutBarriers) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+
+    // Handing the texture to the copy queue: one explicit barrier to COMMON, then the copy queue promotes and decays it
+    tracker.Transition(Texture, Tracker::AllSubresources, Common);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:all:0->3 "));
+    tracker.Assume(Texture, Tracker::AllSubresources, CopySource);
+    tracker.Assume(Texture, Tracker::AllSubresources, Common);
+    CHECK(tracker.Collect().empty());
+    CHECK_EQ(tracker.StateOf(Texture, 0), Common);
+
+    tracker.Transition(Texture, Tracker::AllSubresources, RenderTarget);
+    CHECK_EQ(Describe(tracker.Collect()), std::string("1:all:3->0 "));
+}
+
+TEST_CASE(StateTrackerRejectsOutOfRangeSubresources) {
+    Tracker tracker;
+    tracker.Register(Texture, NumSubres, RenderTarget);
+    CHECK_THROWS(tracker.Transition(Texture, NumSubres, CopySource));
+}
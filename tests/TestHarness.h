@@ -0,0 +1,66 @@
+#pragma once
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Just enough of a test framework for the portable parts of SharedTextureArray: self-registering cases and checks that
+// throw on failure. TestMain.cpp runs every registered case, or the ones whose name contains argv[1].
+struct TestCase {
+    const char* name;
+    void (*func)();
+};
+
+inline std::vector<TestCase>& TestRegistry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+inline bool RegisterTest(const char* name, void (*func)()) {
+    TestRegistry().push_back({name, func});
+    return true;
+}
+
+class TestFailure : public std::runtime_error {
+public:
+    TestFailure(const char* file, int line, const std::string& message)
+        : std::runtime_error(std::string(file) + ":" + std::to_string(line) + ": " + message) {
+    }
+};
+
+#define TEST_CASE(name)                                                  \
+    static void name();                                                  \
+    static const bool name##Registered = RegisterTest(#name, name);      \
+    static void name()
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            throw TestFailure(__FILE__, __LINE__, "CHECK(" #cond ")");   \
+        }                                                                \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                                \
+    do {                                                                                              \
+        const auto& checkA = (a);                                                                     \
+        const auto& checkB = (b);                                                                     \
+        if (!(checkA == checkB)) {                                                                    \
+            std::ostringstream checkMessage;                                                          \
+            checkMessage << "CHECK_EQ(" #a ", " #b "): " << checkA << " != " << checkB;               \
+            throw TestFailure(__FILE__, __LINE__, checkMessage.str());                                \
+        }                                                                                             \
+    } while (0)
+
+#define CHECK_THROWS(expr)                                                                            \
+    do {                                                                                              \
+        bool checkThrew = false;                                                                      \
+        try {                                                                                         \
+            expr;                                                                                     \
+        } catch (const std::exception&) {                                                             \
+            checkThrew = true;                                                                        \
+        }                                                                                             \
+        if (!checkThrew) {                                                                            \
+            throw TestFailure(__FILE__, __LINE__, "CHECK_THROWS(" #expr ") did not throw");           \
+        }                                                                                             \
+    } while (0)
@@ -0,0 +1,29 @@
+#include <cstring>
+#include <exception>
+#include <iostream>
+
+#include "TestHarness.h"
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+
+    uint32_t run = 0;
+    uint32_t failed = 0;
+    for (const TestCase& test : TestRegistry()) {
+        if ((filter != nullptr) && (strstr(test.name, filter) == nullptr)) {
+            continue;
+        }
+
+        ++run;
+        try {
+            test.func();
+            std::cout << "[ PASS ] " << test.name << "\n";
+        } catch (const std::exception& e) {
+            ++failed;
+            std::cout << "[ FAIL ] " << test.name << "\n    " << e.what() << "\n";
+        }
+    }
+
+    std::cout << run - failed << "/" << run << " tests passed\n";
+    return ((run == 0) || (failed != 0)) ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+#include "../TransientPacking.h"
+#include "TestHarness.h"
+
+namespace {
+
+TransientLifetime Lifetime(uint64_t size, uint32_t firstPass, uint32_t lastPass, uint64_t alignment = 64 * 1024) {
+    TransientLifetime lifetime;
+    lifetime.size = size;
+    lifetime.alignment = alignment;
+    lifetime.firstPass = firstPass;
+    lifetime.lastPass = lastPass;
+    return lifetime;
+}
+
+// No two transients alive in the same pass may share memory
+bool NoLiveOverlap(const std::vector<TransientLifetime>& transients) {
+    for (size_t i = 0; i < transients.size(); ++i) {
+        for (size_t j = i + 1; j < transients.size(); ++j) {
+            if (transients[i].OverlapsInTime(transients[j]) && transients[i].OverlapsInMemory(transients[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+TEST_CASE(TransientPackingAliasesDisjointLifetimes) {
+    // One resolve target per pass, the way the multisampled readback declares them: all share the largest one's memory
+    std::vector<TransientLifetime> transients = {Lifetime(256 * 1024, 0, 0), Lifetime(64 * 1024, 1, 1), Lifetime(128 * 1024, 2, 2)};
+    CHECK_EQ(PackTransientLifetimes(transients), uint64_t(256 * 1024));
+    for (const auto& transient : transients) {
+        CHECK_EQ(transient.offset, uint64_t(0));
+    }
+}
+
+TEST_CASE(TransientPackingSeparatesOverlappingLifetimes) {
+    std::vector<TransientLifetime> transients = {Lifetime(64 * 1024, 0, 2), Lifetime(64 * 1024, 1, 3), Lifetime(64 * 1024, 3, 4)};
+    const uint64_t heapSize = PackTransientLifetimes(transients);
+    CHECK(NoLiveOverlap(transients));
+    // The first and last don't overlap in time, so two slots are enough
+    CHECK_EQ(heapSize, uint64_t(128 * 1024));
+    CHECK_EQ(transients[0].offset, transients[2].offset);
+}
+
+TEST_CASE(TransientPackingFillsGapsAtTheirAlignment) {
+    // The 4 MiB aligned transients alias at 0, the small ones alive next to them stack above at their own alignment
+    std::vector<TransientLifetime> transients = {Lifetime(64 * 1024, 0, 1),
+                                                 Lifetime(4 * 1024 * 1024, 1, 2, 4 * 1024 * 1024),
+                                                 Lifetime(64 * 1024, 1, 2),
+                                                 Lifetime(4 * 1024 * 1024, 0, 0, 4 * 1024 * 1024)};
+    const uint64_t heapSize = PackTransientLifetimes(transients);
+    CHECK(NoLiveOverlap(transients));
+    for (const auto& transient : transients) {
+        CHECK_EQ(transient.offset % transient.alignment, uint64_t(0));
+    }
+    CHECK_EQ(transients[1].offset, uint64_t(0));
+    CHECK_EQ(transients[3].offset, uint64_t(0));
+    CHECK_EQ(heapSize, uint64_t(4 * 1024 * 1024 + 2 * 64 * 1024));
+}
+
+TEST_CASE(TransientPackingIsStableForAnUnchangedDeclaration) {
+    // The allocator reuses placed resources by offset, which only pays off if the same frame packs the same way
+    const std::vector<TransientLifetime> declared = {Lifetime(192 * 1024, 0, 1), Lifetime(64 * 1024, 1, 2), Lifetime(64 * 1024, 2, 3)};
+    std::vector<TransientLifetime> first = declared;
+    std::vector<TransientLifetime> second = declared;
+    CHECK_EQ(PackTransientLifetimes(first), PackTransientLifetimes(second));
+    for (size_t i = 0; i < declared.size(); ++i) {
+        CHECK_EQ(first[i].offset, second[i].offset);
+    }
+    CHECK(NoLiveOverlap(first));
+}
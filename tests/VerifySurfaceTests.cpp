@@ -0,0 +1,144 @@
+#include <vector>
+
+#include "../VerifySurface.h"
+#include "TestHarness.h"
+
+namespace {
+
+constexpr uint32_t Expected = 0x80402010;
+constexpr uint32_t Padding = 0xDEADBEEF;
+
+const SimdLevel AllLevels[] = {SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2};
+
+// Rows padded to `pitchTexels`, the padding filled with a value that never matches
+struct Surface {
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitchTexels;
+    std::vector<uint32_t> texels;
+
+    Surface(uint32_t width, uint32_t height, uint32_t pitchTexels)
+        : width(width), height(height), pitchTexels(pitchTexels), texels(static_cast<size_t>(pitchTexels) * height, Padding) {
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                At(x, y) = Expected;
+            }
+        }
+    }
+
+    uint32_t& At(uint32_t x, uint32_t y) {
+        return texels[static_cast<size_t>(y) * pitchTexels + x];
+    }
+
+    VerifyResult Verify(SimdLevel simdLevel) const {
+        return VerifySurface(texels.data(), pitchTexels * sizeof(uint32_t), width, height, Expected, simdLevel);
+    }
+};
+
+}
+
+TEST_CASE(VerifySurfaceIgnoresRowPadding) {
+    // Widths up to one past the 16- and 32-texel blocks the SSE4.1 and AVX2 kernels process exercise every tail length
+    for (SimdLevel level : AllLevels) {
+        for (uint32_t width = 1; width <= 33; ++width) {
+            const Surface surface(width, 3, 64);
+            CHECK(surface.Verify(level).Passed());
+        }
+    }
+}
+
+TEST_CASE(VerifySurfaceFindsASingleMismatchAnywhereInTheRow) {
+    for (SimdLevel level : AllLevels) {
+        // Widths past a block put the mismatch both inside a block and in the tail after it
+        for (uint32_t width : {1u, 5u, 8u, 13u, 31u, 32u, 33u, 47u}) {
+            for (uint32_t x = 0; x < width; ++x) {
+                Surface surface(width, 4, 64);
+                surface.At(x, 2) = ~Expected;
+
+                const VerifyResult result = surface.Verify(level);
+                CHECK_EQ(result.mismatchCount, uint64_t(1));
+                CHECK_EQ(result.firstMismatchX, x);
+                CHECK_EQ(result.firstMismatchY, 2u);
+                CHECK_EQ(result.minX, x);
+                CHECK_EQ(result.maxX, x);
+                CHECK_EQ(result.minY, 2u);
+                CHECK_EQ(result.maxY, 2u);
+            }
+        }
+    }
+}
+
+TEST_CASE(VerifySurfaceBoundsEveryMismatch) {
+    for (SimdLevel level : AllLevels) {
+        Surface surface(40, 10, 64);
+        surface.At(20, 1) = 0;
+        surface.At(35, 4) = 0;
+        surface.At(3, 7) = Expected + 1;
+        surface.At(4, 7) = Expected + 1;
+
+        const VerifyResult result = surface.Verify(level);
+        CHECK_EQ(result.mismatchCount, uint64_t(4));
+        // The first mismatch in row order, not the box's corner
+        CHECK_EQ(result.firstMismatchX, 20u);
+        CHECK_EQ(result.firstMismatchY, 1u);
+        CHECK_EQ(result.minX, 3u);
+        CHECK_EQ(result.minY, 1u);
+        CHECK_EQ(result.maxX, 35u);
+        CHECK_EQ(result.maxY, 7u);
+    }
+}
+
+TEST_CASE(VerifySurfaceAgreesAcrossSimdLevels) {
+    Surface surface(100, 20, 128);
+    uint32_t seed = 7;
+    for (uint32_t i = 0; i < 50; ++i) {
+        seed = seed * 1103515245 + 12345;
+        surface.At((seed >> 8) % 100, (seed >> 20) % 20) = seed;
+    }
+
+    const VerifyResult scalar = surface.Verify(SimdLevel::Scalar);
+    CHECK(!scalar.Passed());
+    for (SimdLevel level : AllLevels) {
+        const VerifyResult result = surface.Verify(level);
+        CHECK_EQ(result.mismatchCount, scalar.mismatchCount);
+        CHECK_EQ(result.firstMismatchX, scalar.firstMismatchX);
+        CHECK_EQ(result.firstMismatchY, scalar.firstMismatchY);
+        CHECK_EQ(result.minX, scalar.minX);
+        CHECK_EQ(result.maxX, scalar.maxX);
+        CHECK_EQ(result.minY, scalar.minY);
+        CHECK_EQ(result.maxY, scalar.maxY);
+    }
+}
+
+TEST_CASE(VerifyResultMergeKeepsTheFirstMismatch) {
+    VerifyResult merged;
+    merged.Merge(VerifyResult());
+    CHECK(merged.Passed());
+
+    VerifyResult first;
+    first.mismatchCount = 2;
+    first.firstMismatchX = 5;
+    first.firstMismatchY = 1;
+    first.minX = 5;
+    first.minY = 1;
+    first.maxX = 9;
+    first.maxY = 1;
+    merged.Merge(first);
+
+    VerifyResult second;
+    second.mismatchCount = 1;
+    second.firstMismatchX = 0;
+    second.firstMismatchY = 3;
+    second.minX = 0;
+    second.minY = 3;
+    second.maxX = 0;
+    second.maxY = 3;
+    merged.Merge(second);
+
+    CHECK_EQ(merged.mismatchCount, uint64_t(3));
+    CHECK_EQ(merged.firstMismatchX, 5u);
+    CHECK_EQ(merged.firstMismatchY, 1u);
+    CHECK_EQ(merged.minX, 0u);
+    CHECK_EQ(merged.maxX, 9u);
+    CHECK_EQ(merged.maxY, 3u);
+}